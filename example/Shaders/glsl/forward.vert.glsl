@@ -6,22 +6,13 @@ layout(location = 2) in vec2 inUv;
 
 layout(location = 0) out vec3 outColor;
 
-void main()
+layout(push_constant) uniform PushConstants
 {
-    mat4 view = mat4(
-         1,  0,  0, 0,
-         0,  1,  0, 0,
-         0,  0,  1, 0,
-        -1, -1, -3, 1
-    );
-
-    mat4 proj = mat4(
-        0.733064294, 0, 0, 0,
-        0, 1.3032254, 0, 0,
-        0, 0, -1.00001001, -1,
-        0, 0, -0.100000992, 0
-    );
+    mat4 viewProjection;
+};
 
+void main()
+{
     outColor = inNormal;
-    gl_Position = proj * view * vec4(inPosition, 1.0);
+    gl_Position = viewProjection * vec4(inPosition, 1.0);
 }
\ No newline at end of file
@@ -9,25 +9,16 @@ struct VSOutput {
     float4 color      : COLOR;
 };
 
+// Root constants at b0, filled by RHICommandList::pushConstants
+// Matrices are column-major in constant buffers, matching glm's memory layout
+cbuffer PushConstants : register(b0) {
+    float4x4 viewProjection;
+};
+
 VSOutput main(VSInput input) {
     VSOutput output;
 
-    // HLSL matrices are **row-major**, so CPU-side will need a glm::transpose() for D3D12...
-    float4x4 view = float4x4(
-        1, 0, 0, -1,
-        0, 1, 0, -1,
-        0, 0, 1, -3,
-        0, 0, 0,  1
-    );
-
-    float4x4 proj = float4x4(
-        0.733064294, 0,          0,           0,
-        0,           1.3032254,  0,           0,
-        0,           0,         -1.00001001, -0.100000992,
-        0,           0,         -1,           0
-    );
-
-    output.position = mul(proj, mul(view, float4(input.position, 1.0f)));
+    output.position = mul(viewProjection, float4(input.position, 1.0f));
     output.color = float4(input.normal, 1.0f);
 
     return output;
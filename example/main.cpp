@@ -1,6 +1,7 @@
 #include <RHI.hpp>
 #include <fmt/color.h>
 #include <fmt/format.h>
+#include <glm/gtc/matrix_transform.hpp>
 #include "Scene/Geometry.hpp"
 #include "WSI/Window.hpp"
 
@@ -49,40 +50,15 @@ int main(const int argc, char** argv)
         .debugName  = "Cube Vertices",
     });
 
-    const auto vertexStaging = gRHI->createBuffer({
-        .bufferSize = vertexBuffer->getSize(),
-        .bufferType = Staging,
-        .debugName  = "Cube Vertices Staging",
-    });
-    vertexStaging->setData(cubeGeometry->getVertices().data(), cubeGeometry->vertexCount() * sizeof(BasicVertex));
-
     const auto indexBuffer = gRHI->createBuffer({
         .bufferSize = cubeGeometry->indexCount() * sizeof(uint32_t),
         .bufferType = Index,
         .debugName  = "Cube Indices",
     });
 
-    const auto indexStaging = gRHI->createBuffer({
-        .bufferSize = indexBuffer->getSize(),
-        .bufferType = Staging,
-        .debugName  = "Cube Indices Staging",
-    });
-    indexStaging->setData(cubeGeometry->getIndices().data(), cubeGeometry->indexCount() * sizeof(uint32_t));
-
-    gRHI->getGraphicsQueue()->executeSingleTimeCommand([&](RHICommandList* commandList) {
-        vertexBuffer->uploadData({
-            .pData = cubeGeometry->getVertices().data(),
-            .dataSize = cubeGeometry->vertexCount() * sizeof(BasicVertex),
-            .pCommandList = commandList,
-            .pStagingBuffer = vertexStaging.get(),
-        });
-        indexBuffer->uploadData({
-            .pData = cubeGeometry->getIndices().data(),
-            .dataSize = cubeGeometry->indexCount() * sizeof(uint32_t),
-            .pCommandList = commandList,
-            .pStagingBuffer = indexStaging.get(),
-        });
-    });
+    // Submitted with the first frame, ahead of the commands that read the buffers
+    gRHI->uploadBuffer(vertexBuffer.get(), cubeGeometry->getVertices().data(), vertexBuffer->getSize());
+    gRHI->uploadBuffer(indexBuffer.get(), cubeGeometry->getIndices().data(), indexBuffer->getSize());
     #pragma endregion
 
     #pragma region "Render Targets Setup"
@@ -90,6 +66,9 @@ int main(const int argc, char** argv)
         .size = gRHI->getSwapchain()->getSize(),
         .format = Format::D32Sfloat,
         .sampled = false,
+        // Only used by the forward pass, may share memory with textures of other passes
+        .transient = true,
+        .lifetime = { 0, 0 },
         .debugName = "Depth Texture"
     });
 
@@ -112,15 +91,20 @@ int main(const int argc, char** argv)
         .debugName  = "Test RenderPass",
     });
 
+    // One framebuffer per swapchain image, indexed by the acquired image rather than the frame in flight
+    const uint32_t swapchainImageCount = gRHI->getSwapchain()->getFrameCount();
+    std::vector<RHIFramebufferAttachment> framebufferAttachments;
+    for (uint32_t i = 0; i < swapchainImageCount; i++)
+    {
+        framebufferAttachments.push_back({ gRHI->getSwapchain(), 0, static_cast<int32_t>(i) });
+    }
+    framebufferAttachments.push_back({ depthTexture.get(), 1 });
+
     const auto testFramebuffers = gRHI->createFramebuffer({
-        .count = 2,
+        .count = swapchainImageCount,
         .renderPass = testRenderPass.get(),
         .extent = gRHI->getSwapchain()->getSize(),
-        .attachments = {
-            { gRHI->getSwapchain(), 0, 0 },
-            { gRHI->getSwapchain(), 0, 1 },
-            { depthTexture.get(), 1 },
-        },
+        .attachments = framebufferAttachments,
         .debugName = "Test Framebuffer",
     });
     #pragma endregion
@@ -131,6 +115,9 @@ int main(const int argc, char** argv)
             { (api == RHIInterfaceType::Vulkan) ? "forward.vert.spv" : "forward.vert.dxil", ShaderStage::Vertex   },
             { (api == RHIInterfaceType::Vulkan) ? "forward.frag.spv" : "forward.frag.dxil", ShaderStage::Fragment }
         },
+        .pushConstantRanges = {
+            { { ShaderStage::Vertex }, 0, sizeof(glm::mat4) },
+        },
         .graphicsPipelineState = {
             .cullMode = CullMode::Back,
             .vertexInputAttributes = {
@@ -147,6 +134,11 @@ int main(const int argc, char** argv)
         .pipelineType = PipelineType::Graphics,
         .debugName = "Forward Pipeline",
     });
+
+    const Size2D extent = gRHI->getSwapchain()->getSize();
+    // Both backends expect a [0, 1] depth range
+    const glm::mat4 viewProjection = glm::perspectiveRH_ZO(glm::radians(75.0f), static_cast<float>(extent.width) / static_cast<float>(extent.height), 0.1f, 20000.0f)
+                                   * glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f, -1.0f, -3.0f));
     #pragma endregion
 
     while (!gWindow->shouldClose())
@@ -157,13 +149,15 @@ int main(const int argc, char** argv)
             .useSwapchain = true
         });
 
-        auto* commandList = gRHI->getGraphicsQueue()->getCommandList(frameInfo.getCurrentFrame());
+        // Framebuffers belong to the acquired swapchain image
+        auto* commandList = gRHI->getGraphicsQueue()->acquireCommandList();
         commandList->begin();
-        testRenderPass->execute(commandList, testFramebuffers->getFramebuffer(frameInfo.getCurrentFrame()), [&](RHICommandList* cmd)
+        testRenderPass->execute(commandList, testFramebuffers->getFramebuffer(frameInfo.getAcquiredFrameIndex()), [&](RHICommandList* cmd)
         {
             gRHI->getSwapchain()->setScissorViewport(cmd);
 
             fwdPipeline->bind(cmd);
+            cmd->pushConstants(ShaderStage::Vertex, viewProjection);
             cmd->bindVertexBuffer(vertexBuffer.get());
             cmd->bindIndexBuffer(indexBuffer.get());
             cmd->drawIndexed(cubeGeometry->indexCount(), 1, 0, 0, 0);
@@ -172,7 +166,11 @@ int main(const int argc, char** argv)
 
         frameInfo.addCommandLists({ commandList });
         gRHI->submitFrame(frameInfo);
+        gRHI->getGraphicsQueue()->releaseCommandList(commandList);
     }
 
+    // Frames may still be in flight, resources must outlive them
+    gRHI->waitIdle();
+
     return 0;
 }
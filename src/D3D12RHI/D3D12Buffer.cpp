@@ -9,6 +9,7 @@ D3D12_HEAP_TYPE getD3D12HeapType(const RHIBufferType bufferType)
     switch (bufferType)
     {
         case Index:
+        case Indirect:
         case Storage:
         case Uniform:
         case Vertex:
@@ -27,11 +28,17 @@ D3D12Buffer::D3D12Buffer(const D3D12BufferCreateInfo& createInfo)
 , mDebugName(createInfo.debugName)
 , mDevice(createInfo.pDevice)
 {
-    mHeapType = getD3D12HeapType(createInfo.bufferType);
+    mHeapType = createInfo.hostVisible ? D3D12_HEAP_TYPE_UPLOAD : getD3D12HeapType(createInfo.bufferType);
 
     D3D12MA::ALLOCATION_DESC allocationDesc = {};
     allocationDesc.HeapType = mHeapType;
 
+    // Upload heap resources must be created, and stay, in the generic read state
+    if (mHeapType == D3D12_HEAP_TYPE_UPLOAD)
+    {
+        mState = D3D12_RESOURCE_STATE_GENERIC_READ;
+    }
+
     D3D12_RESOURCE_DESC resourceDesc = {
         .Dimension = D3D12_RESOURCE_DIMENSION_BUFFER,
         .Alignment = 0,
@@ -62,6 +69,12 @@ D3D12Buffer::D3D12Buffer(const D3D12BufferCreateInfo& createInfo)
     mAddress = mResource->GetGPUVirtualAddress();
 
     D3D12_CHECK(mResource->SetName(mDebugName), "Failed to name D3D12 Resource");
+
+    // Upload heap resources stay mapped for their whole lifetime
+    if (mHeapType == D3D12_HEAP_TYPE_UPLOAD)
+    {
+        D3D12_CHECK(mResource->Map(0, nullptr, &mMappedData), "Failed to map memory");
+    }
 }
 
 std::unique_ptr<D3D12Buffer> D3D12Buffer::createD3D12Buffer(const D3D12BufferCreateInfo& createInfo)
@@ -71,10 +84,14 @@ std::unique_ptr<D3D12Buffer> D3D12Buffer::createD3D12Buffer(const D3D12BufferCre
 
 D3D12Buffer::~D3D12Buffer()
 {
+    if (mMappedData != nullptr)
+    {
+        mResource->Unmap(0, nullptr);
+    }
     mAllocation->Release();
 }
 
-void D3D12Buffer::setData(const void* pData, const uint64_t dataSize) const
+void D3D12Buffer::setData(const void* pData, const uint64_t dataSize, const uint64_t offset) const
 {
     if (mHeapType != D3D12_HEAP_TYPE_UPLOAD)
     {
@@ -86,10 +103,7 @@ void D3D12Buffer::setData(const void* pData, const uint64_t dataSize) const
         return;
     }
 
-    void* mappedMemory;
-    D3D12_CHECK(mResource->Map(0, nullptr, &mappedMemory), "Failed to map memory");
-    memcpy(mappedMemory, pData, dataSize);
-    mResource->Unmap(0, nullptr);
+    memcpy(static_cast<char*>(mMappedData) + offset, pData, dataSize);
 }
 
 void D3D12Buffer::uploadData(const RHIBufferUploadInfo& uploadInfo)
@@ -109,7 +123,7 @@ void D3D12Buffer::uploadData(const RHIBufferUploadInfo& uploadInfo)
     commandList->ResourceBarrier(1, &toCopyBarrier);
 
     commandList->CopyBufferRegion(
-        mResource, 0,
+        mResource, uploadInfo.dstOffset,
         stagingBuffer->mResource, 0,
         uploadInfo.dataSize);
 
@@ -123,7 +137,8 @@ void D3D12Buffer::uploadData(const RHIBufferUploadInfo& uploadInfo)
 
 D3D12_VERTEX_BUFFER_VIEW& D3D12Buffer::getVertexBufferView()
 {
-    if (mBufferType != Vertex)
+    // Upload heap buffers (e.g. transient allocations) may back any binding
+    if (mBufferType != Vertex and mHeapType != D3D12_HEAP_TYPE_UPLOAD)
     {
         const auto msg = "getVertexBufferView() can only be called on Vertex buffers";
         D3D12_PRINTLN(msg);
@@ -140,7 +155,7 @@ D3D12_VERTEX_BUFFER_VIEW& D3D12Buffer::getVertexBufferView()
 
 D3D12_INDEX_BUFFER_VIEW& D3D12Buffer::getIndexBufferView()
 {
-    if (mBufferType != Index)
+    if (mBufferType != Index and mHeapType != D3D12_HEAP_TYPE_UPLOAD)
     {
         const auto msg = "getIndexBufferView() can only be called on Index buffers";
         D3D12_PRINTLN(msg);
@@ -9,6 +9,8 @@ struct D3D12BufferCreateInfo
     RHIBufferType   bufferType;
     D3D12Device*    pDevice;
     const wchar_t*  debugName;
+    // Places the buffer on the upload heap regardless of type, e.g. for data written by the CPU every frame
+    bool            hostVisible {false};
 };
 
 class D3D12Buffer : public RHIBuffer
@@ -19,7 +21,13 @@ public:
 
     ~D3D12Buffer() override;
 
-    void setData(const void* pData, uint64_t dataSize) const override;
+    void setData(const void* pData, uint64_t dataSize, uint64_t offset = 0) const override;
+
+    void* getMappedData() const override { return mMappedData; }
+
+    // Upload heaps are always coherent on D3D12
+    void flush(uint64_t offset = 0, uint64_t size = WholeSize) const override {}
+    void invalidate(uint64_t offset = 0, uint64_t size = WholeSize) const override {}
 
     void uploadData(const RHIBufferUploadInfo& uploadInfo) override;
 
@@ -31,6 +39,8 @@ public:
 
     D3D12_INDEX_BUFFER_VIEW& getIndexBufferView();
 
+    ID3D12Resource* getResource() const { return mResource; }
+
 private:
     uint64_t                    mSize;
     D3D12MA::Allocation*        mAllocation;
@@ -39,6 +49,7 @@ private:
     D3D12_GPU_VIRTUAL_ADDRESS   mAddress;
     D3D12_RESOURCE_STATES       mState { D3D12_RESOURCE_STATE_COMMON };
     D3D12_HEAP_TYPE             mHeapType;
+    void*                       mMappedData {nullptr};
 
     D3D12_VERTEX_BUFFER_VIEW    mVertexBufferView {};
     D3D12_INDEX_BUFFER_VIEW     mIndexBufferView {};
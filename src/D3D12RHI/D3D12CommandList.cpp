@@ -1,11 +1,15 @@
 #include "D3D12CommandList.hpp"
 
 #include "D3D12Buffer.hpp"
+#include "D3D12Device.hpp"
+#include "D3D12Pipeline.hpp"
+#include "RHI/RHIPipeline.hpp"
 
 D3D12CommandList::D3D12CommandList(const D3D12CommandListParams& params)
 : RHICommandList()
 , mCommandList(params.commandList)
 , mCommandAllocator(params.commandAllocator)
+, mDevice(params.pDevice)
 {
     /**
      * TODO: Quite a naive check, this is not necessarily true,
@@ -22,6 +26,16 @@ std::unique_ptr<D3D12CommandList> D3D12CommandList::createD3D12CommandList(const
     return std::make_unique<D3D12CommandList>(params);
 }
 
+D3D12CommandList* D3D12CommandList::fromRHI(RHICommandList* commandList, const char* caller)
+{
+    auto* d3d12CommandList = commandList->as<D3D12CommandList>();
+    if (d3d12CommandList == nullptr)
+    {
+        throw std::runtime_error(fmt::format("{} requires a D3D12CommandList, deferred streams only record commands of the RHICommandList interface", caller));
+    }
+    return d3d12CommandList;
+}
+
 void D3D12CommandList::begin()
 {
     if (mIsRecording)
@@ -31,6 +45,7 @@ void D3D12CommandList::begin()
     }
 
     D3D12_CHECK(mCommandAllocator->Reset(), "Failed to reset CommandAllocator");
+    mPipeline = nullptr;
 
     if (mIsGraphicsCommandList)
     {
@@ -99,10 +114,23 @@ void D3D12CommandList::drawIndexed(uint32_t indexCount, uint32_t instanceCount,
     graphicsCommandList->DrawIndexedInstanced(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
 }
 
-void D3D12CommandList::bindVertexBuffer(RHIBuffer* buffer)
+void D3D12CommandList::dispatch(const uint32_t groupCountX, const uint32_t groupCountY, const uint32_t groupCountZ)
+{
+    if (!mIsGraphicsCommandList)
+    {
+        fmt::println("{} called on a non-graphics CommandList", styled("D3D12CommandList::dispatch()", fg(fmt::color::light_yellow)));
+        return;
+    }
+
+    asGraphicsCommandList()->Dispatch(groupCountX, groupCountY, groupCountZ);
+}
+
+void D3D12CommandList::bindVertexBuffer(RHIBuffer* buffer, const uint64_t offset)
 {
     auto* d3d12Buffer = buffer->as<D3D12Buffer>();
-    auto& bufferView = d3d12Buffer->getVertexBufferView();
+    auto bufferView = d3d12Buffer->getVertexBufferView();
+    bufferView.BufferLocation += offset;
+    bufferView.SizeInBytes    -= static_cast<UINT>(offset);
 
     if (auto* graphicsCommandList = asGraphicsCommandList())
     {
@@ -110,13 +138,126 @@ void D3D12CommandList::bindVertexBuffer(RHIBuffer* buffer)
     }
 }
 
-void D3D12CommandList::bindIndexBuffer(RHIBuffer* buffer)
+void D3D12CommandList::bindIndexBuffer(RHIBuffer* buffer, const uint64_t offset)
 {
     auto* d3d12Buffer = buffer->as<D3D12Buffer>();
-    auto& bufferView = d3d12Buffer->getIndexBufferView();
+    auto bufferView = d3d12Buffer->getIndexBufferView();
+    bufferView.BufferLocation += offset;
+    bufferView.SizeInBytes    -= static_cast<UINT>(offset);
 
     if (auto* graphicsCommandList = asGraphicsCommandList())
     {
         graphicsCommandList->IASetIndexBuffer(&bufferView);
     }
 }
+
+void D3D12CommandList::bindPipeline(RHIPipeline* pipeline)
+{
+    pipeline->bind(this);
+}
+
+void D3D12CommandList::setViewport(const Viewport& viewport)
+{
+    if (auto* graphicsCommandList = asGraphicsCommandList())
+    {
+        const D3D12_VIEWPORT d3d12Viewport = toD3D12(viewport);
+        graphicsCommandList->RSSetViewports(1, &d3d12Viewport);
+    }
+}
+
+void D3D12CommandList::setScissor(const Rect2D& scissor)
+{
+    if (auto* graphicsCommandList = asGraphicsCommandList())
+    {
+        const D3D12_RECT d3d12Scissor = toD3D12(scissor);
+        graphicsCommandList->RSSetScissorRects(1, &d3d12Scissor);
+    }
+}
+
+void D3D12CommandList::drawIndirect(RHIBuffer* buffer, const uint64_t offset, const uint32_t drawCount, const uint32_t stride)
+{
+    executeIndirect(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW, stride, drawCount, buffer, offset);
+}
+
+void D3D12CommandList::drawIndexedIndirect(RHIBuffer* buffer, const uint64_t offset, const uint32_t drawCount, const uint32_t stride)
+{
+    executeIndirect(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED, stride, drawCount, buffer, offset);
+}
+
+void D3D12CommandList::drawIndexedIndirectCount(RHIBuffer* buffer, const uint64_t offset, RHIBuffer* countBuffer, const uint64_t countOffset,
+                                                const uint32_t maxDrawCount, const uint32_t stride)
+{
+    // ExecuteIndirect already clamps the count read from the buffer to maxDrawCount
+    executeIndirect(D3D12_INDIRECT_ARGUMENT_TYPE_DRAW_INDEXED, stride, maxDrawCount, buffer, offset, countBuffer, countOffset);
+}
+
+void D3D12CommandList::dispatchIndirect(RHIBuffer* buffer, const uint64_t offset)
+{
+    executeIndirect(D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH, sizeof(RHIDispatchIndirectArguments), 1, buffer, offset);
+}
+
+void D3D12CommandList::executeIndirect(const D3D12_INDIRECT_ARGUMENT_TYPE argumentType, const uint32_t stride, const uint32_t maxCount,
+                                       RHIBuffer* buffer, const uint64_t offset, RHIBuffer* countBuffer, const uint64_t countOffset)
+{
+    auto* graphicsCommandList = asGraphicsCommandList();
+    if (graphicsCommandList == nullptr)
+    {
+        fmt::println("{} called on a non-graphics CommandList", styled("D3D12CommandList::executeIndirect()", fg(fmt::color::light_yellow)));
+        return;
+    }
+
+    if (argumentType != D3D12_INDIRECT_ARGUMENT_TYPE_DISPATCH)
+    {
+        graphicsCommandList->IASetPrimitiveTopology(D3D10_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+    }
+
+    // Buffers leave their upload in GENERIC_READ, which includes INDIRECT_ARGUMENT
+    graphicsCommandList->ExecuteIndirect(
+        mDevice->getCommandSignature(argumentType, stride), maxCount,
+        buffer->as<D3D12Buffer>()->getResource(), offset,
+        countBuffer ? countBuffer->as<D3D12Buffer>()->getResource() : nullptr, countOffset);
+}
+
+void D3D12CommandList::bindPipeline(const D3D12Pipeline* pipeline)
+{
+    auto* graphicsCommandList = asGraphicsCommandList();
+    graphicsCommandList->SetPipelineState(pipeline->getPipelineState());
+    if (pipeline->getPipelineType() == PipelineType::Compute)
+    {
+        graphicsCommandList->SetComputeRootSignature(pipeline->getRootSignature());
+    }
+    else
+    {
+        graphicsCommandList->SetGraphicsRootSignature(pipeline->getRootSignature());
+    }
+    mPipeline = pipeline;
+}
+
+void D3D12CommandList::pushConstants(const ShaderStage stage, const uint32_t offset, const uint32_t size, const void* pData)
+{
+    if (!mPipeline)
+    {
+        throw std::runtime_error("Can't push constants without a bound pipeline");
+    }
+
+    const auto rootIndex = mPipeline->getPushConstantsRootIndex();
+    if (!rootIndex.has_value())
+    {
+        throw std::runtime_error("Can't push constants to a pipeline without push constant ranges");
+    }
+    if (offset % 4 != 0 or size % 4 != 0)
+    {
+        throw std::runtime_error(fmt::format("Push constant offset {} and size {} must be multiples of 4", offset, size));
+    }
+
+    // Root constants are shared by all stages of the parameter's visibility, so the stage is implied by the bound pipeline
+    auto* graphicsCommandList = asGraphicsCommandList();
+    if (mPipeline->getPipelineType() == PipelineType::Compute)
+    {
+        graphicsCommandList->SetComputeRoot32BitConstants(rootIndex.value(), size / 4, pData, offset / 4);
+    }
+    else
+    {
+        graphicsCommandList->SetGraphicsRoot32BitConstants(rootIndex.value(), size / 4, pData, offset / 4);
+    }
+}
@@ -4,11 +4,14 @@
 #include "RHI/Definitions.hpp"
 #include "RHI/RHICommandList.hpp"
 
+class D3D12Pipeline;
+
 struct D3D12CommandListParams
 {
     ComPtr<ID3D12CommandList>       commandList;
     ComPtr<ID3D12CommandAllocator>  commandAllocator;
     RHICommandQueueType             queueType;
+    D3D12Device*                    pDevice;
 };
 
 class D3D12CommandList : public RHICommandList
@@ -18,6 +21,9 @@ public:
 
     ~D3D12CommandList() override = default;
 
+    // Conversion for callers recording D3D12 commands directly, throws for other lists such as deferred RHICommandStreams
+    static D3D12CommandList* fromRHI(RHICommandList* commandList, const char* caller);
+
     void begin() override;
 
     void end() override;
@@ -32,17 +38,49 @@ public:
 
     void copyBuffer(RHIBuffer* src, RHIBuffer* dst) override {}
 
-    void bindVertexBuffer(RHIBuffer* buffer) override;
+    void bindVertexBuffer(RHIBuffer* buffer, uint64_t offset = 0) override;
+
+    void bindIndexBuffer(RHIBuffer* buffer, uint64_t offset = 0) override;
+
+    void bindPipeline(RHIPipeline* pipeline) override;
+
+    void setViewport(const Viewport& viewport) override;
+
+    void setScissor(const Rect2D& scissor) override;
+
+    // Indirect commands are recorded with ExecuteIndirect, using a command signature matching the argument type and stride
+    void drawIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndirectArguments)) override;
 
-    void bindIndexBuffer(RHIBuffer* buffer) override;
+    void drawIndexedIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) override;
+
+    void drawIndexedIndirectCount(RHIBuffer* buffer, uint64_t offset, RHIBuffer* countBuffer, uint64_t countOffset,
+                                  uint32_t maxDrawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) override;
+
+    void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) override;
+
+    void dispatchIndirect(RHIBuffer* buffer, uint64_t offset) override;
+
+    // Writes the bytes into the root constants of the bound pipeline, offset and size must be multiples of 4
+    void pushConstants(ShaderStage stage, uint32_t offset, uint32_t size, const void* pData) override;
+    using RHICommandList::pushConstants;
+
+    // Sets the pipeline state and root signature, later push constants go to the pipeline's root constants
+    void bindPipeline(const D3D12Pipeline* pipeline);
 
 
 private:
     friend class D3D12CommandQueue;
 
+    void executeIndirect(D3D12_INDIRECT_ARGUMENT_TYPE argumentType, uint32_t stride, uint32_t maxCount,
+                         RHIBuffer* buffer, uint64_t offset, RHIBuffer* countBuffer = nullptr, uint64_t countOffset = 0);
+
     bool mIsRecording           = false;
     bool mIsGraphicsCommandList = false;
 
     ComPtr<ID3D12CommandList>      mCommandList;
     ComPtr<ID3D12CommandAllocator> mCommandAllocator;
+    D3D12Device*                   mDevice;
+
+    // Last pipeline bound through bindPipeline(const D3D12Pipeline*)
+    const D3D12Pipeline*           mPipeline {nullptr};
 };
\ No newline at end of file
@@ -1,8 +1,11 @@
 #include "D3D12CommandQueue.hpp"
 
+#include "D3D12Fence.hpp"
+
 D3D12CommandQueue::D3D12CommandQueue(const D3D12CommandQueueParams& params)
 : mType(params.type)
 , mDevice(params.device)
+, mParentDevice(params.pDevice)
 {
     D3D12_COMMAND_QUEUE_DESC queueDesc = {};
     queueDesc.Flags = D3D12_COMMAND_QUEUE_FLAG_NONE;
@@ -10,35 +13,91 @@ D3D12CommandQueue::D3D12CommandQueue(const D3D12CommandQueueParams& params)
     D3D12_CHECK(mDevice->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&mCommandQueue)),
         "Failed to create CommandQueue.");
 
-    mCommandAllocators.resize(params.commandListCount);
-    mRawCommandLists.resize(params.commandListCount);
+    mFrameCommandLists.resize(params.frameCount);
+}
+
+std::unique_ptr<D3D12CommandQueue> D3D12CommandQueue::createD3D12CommandQueue(const D3D12CommandQueueParams& params)
+{
+    return std::make_unique<D3D12CommandQueue>(params);
+}
+
+RHICommandList* D3D12CommandQueue::acquireCommandList()
+{
+    std::lock_guard lock(mFrameCommandListsMutex);
+
+    if (mFrameIndex >= mFrameCommandLists.size())
+    {
+        throw std::out_of_range(fmt::format("Index {} is out of bounds for container of size {}", mFrameIndex, mFrameCommandLists.size()));
+    }
+
+    auto& frameCommandLists = mFrameCommandLists[mFrameIndex];
+    if (frameCommandLists.acquiredCount == frameCommandLists.commandLists.size())
+    {
+        frameCommandLists.commandLists.push_back(createCommandList());
+    }
+
+    return frameCommandLists.commandLists[frameCommandLists.acquiredCount++].get();
+}
+
+void D3D12CommandQueue::setFrameIndex(const uint32_t frameIndex)
+{
+    std::lock_guard lock(mFrameCommandListsMutex);
 
-    for (uint32_t i = 0; i < params.commandListCount; i++)
+    mFrameIndex = frameIndex;
+    if (mFrameIndex < mFrameCommandLists.size())
     {
-        D3D12_CHECK(mDevice->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_DIRECT, IID_PPV_ARGS(&mCommandAllocators[i])),
-            "Failed to create CommandAllocator");
-
-        D3D12_CHECK(mDevice->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_DIRECT, mCommandAllocators[i].Get(), nullptr, IID_PPV_ARGS(&mRawCommandLists[i])),
-            "Failed to create CommandList");
-
-        if (mType == RHICommandQueueType::Graphics)
-        {
-            ComPtr<ID3D12GraphicsCommandList> graphicsCommandList;
-            D3D12_CHECK(mRawCommandLists[i].As(&graphicsCommandList), "Failed to cast to GraphicsCommandList");
-            D3D12_CHECK(graphicsCommandList->Close(), "Failed to close GraphicsCommandList");
-        }
-
-        mCommandLists.push_back(D3D12CommandList::createD3D12CommandList({
-            .commandList = mRawCommandLists[i],
-            .commandAllocator = mCommandAllocators[i],
-            .queueType = mType,
-        }));
+        mFrameCommandLists[mFrameIndex].acquiredCount = 0;
     }
 }
 
-std::unique_ptr<D3D12CommandQueue> D3D12CommandQueue::createD3D12CommandQueue(const D3D12CommandQueueParams& params)
+std::unique_ptr<D3D12CommandList> D3D12CommandQueue::createCommandList() const
 {
-    return std::make_unique<D3D12CommandQueue>(params);
+    const D3D12_COMMAND_LIST_TYPE listType = getD3D12QueueType(mType);
+
+    ComPtr<ID3D12CommandAllocator> allocator;
+    D3D12_CHECK(mDevice->CreateCommandAllocator(listType, IID_PPV_ARGS(&allocator)),
+        "Failed to create CommandAllocator");
+
+    ComPtr<ID3D12CommandList> commandList;
+    D3D12_CHECK(mDevice->CreateCommandList(0, listType, allocator.Get(), nullptr, IID_PPV_ARGS(&commandList)),
+        "Failed to create CommandList");
+
+    // Lists are created in the recording state, begin() expects them closed
+    ComPtr<ID3D12GraphicsCommandList> graphicsCommandList;
+    D3D12_CHECK(commandList.As(&graphicsCommandList), "Failed to cast to GraphicsCommandList");
+    D3D12_CHECK(graphicsCommandList->Close(), "Failed to close GraphicsCommandList");
+
+    return D3D12CommandList::createD3D12CommandList({
+        .commandList = commandList,
+        .commandAllocator = allocator,
+        .queueType = mType,
+        .pDevice = mParentDevice,
+    });
+}
+
+void D3D12CommandQueue::submit(const RHISubmitInfo& submitInfo)
+{
+    // Queue-side waits and signals are ordered with the command lists executed in between
+    for (const auto& [fence, value] : submitInfo.waitFences)
+    {
+        D3D12_CHECK(mCommandQueue->Wait(fence->as<D3D12Fence>()->handle(), value), "Failed to wait on Fence");
+    }
+
+    std::vector<ID3D12CommandList*> pCommandLists;
+    for (auto* commandList : submitInfo.commandLists)
+    {
+        pCommandLists.push_back(commandList->as<D3D12CommandList>()->handle());
+    }
+
+    if (!pCommandLists.empty())
+    {
+        mCommandQueue->ExecuteCommandLists(static_cast<UINT>(pCommandLists.size()), pCommandLists.data());
+    }
+
+    for (const auto& [fence, value] : submitInfo.signalFences)
+    {
+        D3D12_CHECK(mCommandQueue->Signal(fence->as<D3D12Fence>()->handle(), value), "Failed to signal Fence");
+    }
 }
 
 D3D12_COMMAND_LIST_TYPE D3D12CommandQueue::getD3D12QueueType(RHICommandQueueType queueType)
@@ -49,6 +108,8 @@ D3D12_COMMAND_LIST_TYPE D3D12CommandQueue::getD3D12QueueType(RHICommandQueueType
             return D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_DIRECT;
         case RHICommandQueueType::AsyncCompute:
             return D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_COMPUTE;
+        case RHICommandQueueType::Transfer:
+            return D3D12_COMMAND_LIST_TYPE::D3D12_COMMAND_LIST_TYPE_COPY;
     }
     throw std::runtime_error("Unsupported RHICommandQueueType");
 }
@@ -77,6 +138,7 @@ void D3D12CommandQueue::executeSingleTimeCommand(const std::function<void(RHICom
         .commandList = commandList,
         .commandAllocator = allocator,
         .queueType = mType,
+        .pDevice = mParentDevice,
     });
 
     rhiList->mIsRecording = true;
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <mutex>
 #include "D3D12CommandList.hpp"
 #include "D3D12Core.hpp"
 #include "RHI/RHICommandQueue.hpp"
@@ -9,8 +10,9 @@ class D3D12CommandList;
 struct D3D12CommandQueueParams
 {
     ID3D12Device*        device;
+    D3D12Device*         pDevice;
     RHICommandQueueType  type = RHICommandQueueType::Graphics;
-    uint32_t             commandListCount = 2;
+    uint32_t             frameCount = 2;
 };
 
 class D3D12CommandQueue : public RHICommandQueue
@@ -18,14 +20,15 @@ class D3D12CommandQueue : public RHICommandQueue
 public:
     explicit DEF_PRIMARY_CTOR(D3D12CommandQueue, const D3D12CommandQueueParams& params);
 
-    RHICommandList* getCommandList(uint32_t index) override
-    {
-        if (index > mCommandAllocators.size())
-        {
-            throw std::out_of_range(fmt::format("Index {} is out of bounds for container of size {}", index, mCommandAllocators.size()));
-        }
-        return mCommandLists[index].get();
-    }
+    // Hands out a new command list for every call, lists of earlier frames in the same slot are reused first
+    RHICommandList* acquireCommandList() override;
+
+    void releaseCommandList(RHICommandList* commandList) override {}
+
+    // The GPU must have completed the previous use of the frame slot, its lists are handed out again
+    void setFrameIndex(uint32_t frameIndex);
+
+    void submit(const RHISubmitInfo& submitInfo) override;
 
     RHICommandQueueType getType() override { return mType; }
 
@@ -35,15 +38,37 @@ public:
 
     void executeSingleTimeCommand(const std::function<void(RHICommandList*)>& lambda) override;
 
+    // D3D12 executes single-time commands synchronously, so every ticket has already completed
+    RHICommandTicket executeSingleTimeCommandAsync(const std::function<void(RHICommandList*)>& lambda) override
+    {
+        executeSingleTimeCommand(lambda);
+        return {};
+    }
+
+    bool isComplete(RHICommandTicket ticket) override { return true; }
+
+    void wait(RHICommandTicket ticket) override {}
+
+    void flushSingleTimeCommands() override {}
+
 private:
     RHICommandQueueType        mType;
     ComPtr<ID3D12CommandQueue> mCommandQueue;
 
-    // 1 CommandAllocator per requested CommandList (1-1 map)
-    std::vector<ComPtr<ID3D12CommandAllocator>> mCommandAllocators;
-    std::vector<ComPtr<ID3D12CommandList>>      mRawCommandLists;
+    std::unique_ptr<D3D12CommandList> createCommandList() const;
+
+    struct FrameCommandLists
+    {
+        // Every list owns its CommandAllocator, so lists of the same frame can be recorded on different threads
+        std::vector<std::unique_ptr<D3D12CommandList>> commandLists;
+        // Lists past acquiredCount are no longer used by the GPU and are handed out again before creating more
+        uint32_t                                       acquiredCount {0};
+    };
 
-    std::vector<std::unique_ptr<D3D12CommandList>> mCommandLists;
+    std::vector<FrameCommandLists> mFrameCommandLists;
+    uint32_t                       mFrameIndex {0};
+    std::mutex                     mFrameCommandListsMutex;
 
     ID3D12Device* mDevice;
+    D3D12Device*  mParentDevice;
 };
\ No newline at end of file
@@ -78,6 +78,21 @@ inline D3D12_CULL_MODE toD3D12(const CullMode cullMode)
     }
 }
 
+inline D3D12_VIEWPORT toD3D12(const Viewport& viewport)
+{
+    return { viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+}
+
+inline D3D12_RECT toD3D12(const Rect2D& rect)
+{
+    return {
+        .left   = rect.offset.x,
+        .top    = rect.offset.y,
+        .right  = rect.offset.x + static_cast<LONG>(rect.size.width),
+        .bottom = rect.offset.y + static_cast<LONG>(rect.size.height),
+    };
+}
+
 #pragma endregion
 
 #pragma region "D3D12 to RHI type conversion"
@@ -85,8 +100,8 @@ inline D3D12_CULL_MODE toD3D12(const CullMode cullMode)
 inline Rect2D toRHI(const CD3DX12_RECT& rect)
 {
     return {
-        .offset = Offset2D(rect.top, rect.left),
-        .size = Size2D(rect.bottom, rect.right),
+        .offset = { .x = rect.left, .y = rect.top },
+        .size = { .width = static_cast<uint32_t>(rect.right - rect.left), .height = static_cast<uint32_t>(rect.bottom - rect.top) },
     };
 }
 
@@ -16,8 +16,10 @@ D3D12Device::D3D12Device(const ComPtr<IDXGIAdapter1>& adapter)
 
     mDirectQueue = D3D12CommandQueue::createD3D12CommandQueue({
         .device = mDevice.Get(),
+        .pDevice = this,
         .type = RHICommandQueueType::Graphics,
-        .commandListCount = 2,
+        // Frame slots are indexed by the swapchain back buffer
+        .frameCount = 2,
     });
 
     D3D12MA::ALLOCATOR_DESC allocatorDesc = {};
@@ -37,10 +39,11 @@ std::unique_ptr<D3D12Device> D3D12Device::createD3D12Device(const ComPtr<IDXGIAd
     return std::make_unique<D3D12Device>(adapter);
 }
 
-void D3D12Device::makeRootSignature(ID3D12RootSignature** ppRootSignature, D3D12_ROOT_SIGNATURE_FLAGS flags) const
+void D3D12Device::makeRootSignature(ID3D12RootSignature** ppRootSignature, D3D12_ROOT_SIGNATURE_FLAGS flags,
+                                    const std::span<const D3D12_ROOT_PARAMETER> parameters) const
 {
     CD3DX12_ROOT_SIGNATURE_DESC rootSignatureDesc;
-    rootSignatureDesc.Init(0, nullptr, 0, nullptr, flags);
+    rootSignatureDesc.Init(static_cast<UINT>(parameters.size()), parameters.data(), 0, nullptr, flags);
 
     ComPtr<ID3DBlob> signature;
     ComPtr<ID3DBlob> error;
@@ -58,11 +61,54 @@ void D3D12Device::createGraphicsPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& gr
         "Failed to create GraphicsPipelineState");
 }
 
+void D3D12Device::createComputePSO(const D3D12_COMPUTE_PIPELINE_STATE_DESC& computePipelineStateDesc,
+    ComPtr<ID3D12PipelineState>& pipelineState) const
+{
+    D3D12_CHECK(mDevice->CreateComputePipelineState(&computePipelineStateDesc, IID_PPV_ARGS(&pipelineState)),
+        "Failed to create ComputePipelineState");
+}
+
 void D3D12Device::createFence(const uint64_t initialValue, const D3D12_FENCE_FLAGS flags, ComPtr<ID3D12Fence>& fence) const
 {
     D3D12_CHECK(mDevice->CreateFence(initialValue, flags, IID_PPV_ARGS(&fence)), "Failed to create Fence");
 }
 
+ID3D12CommandSignature* D3D12Device::getCommandSignature(const D3D12_INDIRECT_ARGUMENT_TYPE argumentType, const uint32_t byteStride)
+{
+    std::lock_guard lock(mCommandSignaturesMutex);
+
+    auto& commandSignature = mCommandSignatures[{ argumentType, byteStride }];
+    if (commandSignature == nullptr)
+    {
+        const D3D12_INDIRECT_ARGUMENT_DESC argumentDesc = { .Type = argumentType };
+
+        const D3D12_COMMAND_SIGNATURE_DESC signatureDesc = {
+            .ByteStride       = byteStride,
+            .NumArgumentDescs = 1,
+            .pArgumentDescs   = &argumentDesc,
+            .NodeMask         = 0,
+        };
+
+        // The signatures only draw or dispatch and change no root arguments, so they need no root signature
+        D3D12_CHECK(mDevice->CreateCommandSignature(&signatureDesc, nullptr, IID_PPV_ARGS(&commandSignature)),
+            "Failed to create CommandSignature");
+    }
+    return commandSignature.Get();
+}
+
+void D3D12Device::getCopyableFootprint(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint,
+                                       uint32_t& rowCount, uint64_t& rowSize, uint64_t& totalSize) const
+{
+    UINT   numRows = 0;
+    UINT64 rowSizeInBytes = 0;
+    UINT64 totalBytes = 0;
+    mDevice->GetCopyableFootprints(&resourceDesc, 0, 1, 0, &footprint, &numRows, &rowSizeInBytes, &totalBytes);
+
+    rowCount  = numRows;
+    rowSize   = rowSizeInBytes;
+    totalSize = totalBytes;
+}
+
 void D3D12Device::createDescriptorHeap(const D3D12CreateDescriptorHeapParams& params) const
 {
     D3D12_CHECK(
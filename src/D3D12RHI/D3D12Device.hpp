@@ -1,5 +1,8 @@
 #pragma once
 
+#include <map>
+#include <mutex>
+#include <span>
 #include "D3D12Core.hpp"
 
 class D3D12CommandQueue;
@@ -36,12 +39,22 @@ public:
     /**
      * Internal D3D12 Wrappers
      */
-    void makeRootSignature(ID3D12RootSignature** ppRootSignature, D3D12_ROOT_SIGNATURE_FLAGS flags) const;
+    void makeRootSignature(ID3D12RootSignature** ppRootSignature, D3D12_ROOT_SIGNATURE_FLAGS flags,
+                           std::span<const D3D12_ROOT_PARAMETER> parameters = {}) const;
 
     void createGraphicsPSO(const D3D12_GRAPHICS_PIPELINE_STATE_DESC& graphicsPipelineStateDesc, ComPtr<ID3D12PipelineState>& pipelineState) const;
 
+    void createComputePSO(const D3D12_COMPUTE_PIPELINE_STATE_DESC& computePipelineStateDesc, ComPtr<ID3D12PipelineState>& pipelineState) const;
+
     void createFence(uint64_t initialValue, D3D12_FENCE_FLAGS flags, ComPtr<ID3D12Fence>& fence) const;
 
+    // Created on first use and cached per argument type and stride. Thread safe.
+    ID3D12CommandSignature* getCommandSignature(D3D12_INDIRECT_ARGUMENT_TYPE argumentType, uint32_t byteStride);
+
+    // Layout of the first subresource when copied through a buffer, rows are padded to D3D12_TEXTURE_DATA_PITCH_ALIGNMENT
+    void getCopyableFootprint(const D3D12_RESOURCE_DESC& resourceDesc, D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint,
+                              uint32_t& rowCount, uint64_t& rowSize, uint64_t& totalSize) const;
+
     D3D12MA::Allocator* getAllocator() const { return mAllocator; }
 
     /**
@@ -65,6 +78,9 @@ private:
 
     std::unique_ptr<D3D12CommandQueue> mDirectQueue;
 
+    std::map<std::pair<D3D12_INDIRECT_ARGUMENT_TYPE, uint32_t>, ComPtr<ID3D12CommandSignature>> mCommandSignatures;
+    std::mutex                                                                                   mCommandSignaturesMutex;
+
     std::string mAdapterName {"No Adapter"};
     DXGI_ADAPTER_DESC1 mAdapterDesc {};
 };
\ No newline at end of file
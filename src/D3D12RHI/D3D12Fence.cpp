@@ -0,0 +1,62 @@
+#include "D3D12Fence.hpp"
+
+#include <algorithm>
+#include "D3D12Device.hpp"
+
+D3D12Fence::D3D12Fence(const D3D12FenceCreateInfo& createInfo)
+: mDebugName(createInfo.debugName)
+{
+    createInfo.pDevice->createFence(createInfo.initialValue, D3D12_FENCE_FLAG_NONE, mFence);
+    D3D12_CHECK(mFence->SetName(TO_LPCWSTR(mDebugName)), "Failed to name ID3D12Fence");
+}
+
+std::unique_ptr<D3D12Fence> D3D12Fence::createD3D12Fence(const D3D12FenceCreateInfo& createInfo)
+{
+    return std::make_unique<D3D12Fence>(createInfo);
+}
+
+uint64_t D3D12Fence::getCompletedValue()
+{
+    return mFence->GetCompletedValue();
+}
+
+void D3D12Fence::signal(const uint64_t value)
+{
+    D3D12_CHECK(mFence->Signal(value), "Failed to signal Fence");
+}
+
+bool D3D12Fence::wait(const uint64_t value, const uint64_t timeout)
+{
+    if (mFence->GetCompletedValue() >= value)
+    {
+        return true;
+    }
+
+    // Waits are in milliseconds, rounded up so short timeouts do not turn into polling
+    DWORD timeoutMs = INFINITE;
+    if (timeout != std::numeric_limits<uint64_t>::max())
+    {
+        timeoutMs = static_cast<DWORD>(std::min<uint64_t>((timeout + 999'999) / 1'000'000, INFINITE - 1));
+    }
+
+    // One event per wait, so several threads can wait on the same fence
+    const HANDLE event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+    if (event == nullptr)
+    {
+        throw std::runtime_error(fmt::format("Failed to create wait event for fence {}", mDebugName));
+    }
+
+    D3D12_CHECK(mFence->SetEventOnCompletion(value, event), "Fence set event on completion failed");
+    const DWORD result = WaitForSingleObject(event, timeoutMs);
+    CloseHandle(event);
+
+    if (result == WAIT_TIMEOUT)
+    {
+        return false;
+    }
+    if (result != WAIT_OBJECT_0)
+    {
+        throw std::runtime_error(fmt::format("Failed to wait for fence {}", mDebugName));
+    }
+    return true;
+}
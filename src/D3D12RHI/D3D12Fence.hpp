@@ -0,0 +1,37 @@
+#pragma once
+
+#include "D3D12Core.hpp"
+#include "RHI/RHIFence.hpp"
+
+class D3D12Device;
+
+struct D3D12FenceCreateInfo
+{
+    uint64_t      initialValue {0};
+    std::string   debugName;
+    D3D12Device*  pDevice;
+};
+
+/**
+ * RHIFence backed by an ID3D12Fence, which already is a monotonically increasing 64-bit value.
+ */
+class D3D12Fence final : public RHIFence
+{
+public:
+    DISABLE_COPY_CTOR(D3D12Fence);
+    explicit DEF_PRIMARY_CTOR(D3D12Fence, const D3D12FenceCreateInfo& createInfo);
+
+    ~D3D12Fence() override = default;
+
+    uint64_t getCompletedValue() override;
+
+    void     signal(uint64_t value) override;
+
+    bool     wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max()) override;
+
+    ID3D12Fence* handle() const { return mFence.Get(); }
+
+private:
+    ComPtr<ID3D12Fence> mFence;
+    std::string         mDebugName;
+};
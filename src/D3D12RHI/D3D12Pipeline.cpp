@@ -1,5 +1,6 @@
 #include "D3D12Pipeline.hpp"
 
+#include <algorithm>
 #include <ranges>
 
 D3D12Pipeline::D3D12Pipeline(D3D12PipelineCreateInfo& createInfo)
@@ -10,11 +11,24 @@ D3D12Pipeline::D3D12Pipeline(D3D12PipelineCreateInfo& createInfo)
      * Root Signature
      */
     const auto rootSignatureFlags = getRootSignatureFlags(createInfo.inputElements.empty());
-    mDevice->makeRootSignature(&mRootSignature, rootSignatureFlags);
+
+    std::vector<D3D12_ROOT_PARAMETER> rootParameters;
+    if (!createInfo.pushConstantRanges.empty())
+    {
+        mPushConstantsRootIndex = static_cast<UINT>(rootParameters.size());
+        rootParameters.push_back(makePushConstantsParameter(createInfo.pushConstantRanges));
+    }
+    mDevice->makeRootSignature(&mRootSignature, rootSignatureFlags, rootParameters);
 
     const auto rootSignatureName = fmt::format("{} RootSignature", mName);
     D3D12_CHECK(mRootSignature->SetName(TO_LPCWSTR(rootSignatureName)), "Failed to name ID3D12RootSignature");
 
+    if (mPipelineType == PipelineType::Compute)
+    {
+        createComputePipelineState(createInfo);
+        return;
+    }
+
     /**
      * Pipeline State
      */
@@ -74,6 +88,9 @@ D3D12Pipeline::D3D12Pipeline(D3D12PipelineCreateInfo& createInfo)
                 psoDesc.PS = blob;
                 break;
             }
+            case ShaderStage::Compute:{
+                throw std::runtime_error(fmt::format("Graphics Pipeline {} can't contain a compute shader", mName ? mName : "Unknown"));
+            }
             default: {
                 fmt::println("Unsupported shader type");
             }
@@ -93,9 +110,60 @@ D3D12Pipeline::~D3D12Pipeline()
 {
 }
 
+void D3D12Pipeline::createComputePipelineState(const D3D12PipelineCreateInfo& createInfo)
+{
+    if (createInfo.shadersCreateInfos.size() != 1 or createInfo.shadersCreateInfos[0].shaderStage != ShaderStage::Compute)
+    {
+        throw std::runtime_error(fmt::format("Compute Pipeline {} must be created from a single compute shader", mName ? mName : "Unknown"));
+    }
+
+    const auto pathStr = std::string(createInfo.shadersCreateInfos[0].filePath);
+    const auto path = TO_WSTR(pathStr);
+
+    ComPtr<ID3DBlob> shaderBlob;
+    D3D12_CHECK(D3DReadFileToBlob(path.c_str(), &shaderBlob), "Failed to read shader bytecode");
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC psoDesc = {};
+    psoDesc.pRootSignature = mRootSignature.Get();
+    psoDesc.CS = CD3DX12_SHADER_BYTECODE(shaderBlob.Get());
+
+    mDevice->createComputePSO(psoDesc, mPipelineState);
+}
+
 D3D12_ROOT_SIGNATURE_FLAGS D3D12Pipeline::getRootSignatureFlags(const bool hasVertexInputs)
 {
     return hasVertexInputs
         ? D3D12_ROOT_SIGNATURE_FLAG_NONE
         : D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
 }
+
+D3D12_ROOT_PARAMETER D3D12Pipeline::makePushConstantsParameter(const std::vector<RHIPushConstantRange>& ranges)
+{
+    uint32_t size = 0;
+    bool vertex = false, fragment = false, compute = false;
+    for (const auto& range : ranges)
+    {
+        size = std::max(size, range.offset + range.size);
+        for (const auto stage : range.stages)
+        {
+            vertex   |= (stage == ShaderStage::Vertex);
+            fragment |= (stage == ShaderStage::Fragment);
+            compute  |= (stage == ShaderStage::Compute);
+        }
+    }
+
+    // Compute shaders only see parameters visible to all stages
+    D3D12_SHADER_VISIBILITY visibility = D3D12_SHADER_VISIBILITY_ALL;
+    if (vertex and !fragment and !compute)
+    {
+        visibility = D3D12_SHADER_VISIBILITY_VERTEX;
+    }
+    if (fragment and !vertex and !compute)
+    {
+        visibility = D3D12_SHADER_VISIBILITY_PIXEL;
+    }
+
+    CD3DX12_ROOT_PARAMETER parameter;
+    parameter.InitAsConstants((size + 3) / 4, 0, 0, visibility);
+    return parameter;
+}
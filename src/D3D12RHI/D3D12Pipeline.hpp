@@ -5,6 +5,7 @@
 #include "D3D12Device.hpp"
 #include "D3D12RenderPass.hpp"
 #include "RHI/RHICommandList.hpp"
+#include "RHI/RHICommandStream.hpp"
 #include "RHI/RHIPipeline.hpp"
 
 struct D3D12GraphicsPipelineStateInfo
@@ -26,6 +27,8 @@ struct D3D12PipelineCreateInfo
 
     bool                                    enableDepth {};
     std::vector<RHIShaderCreateInfo>        shadersCreateInfos {};
+    std::vector<RHIPushConstantRange>       pushConstantRanges {};
+    // Graphics pipelines only, compute pipelines take a single compute shader and ignore the graphics state
     D3D12RenderPass*                        renderPass = nullptr;
     PipelineType                            pipelineType { PipelineType::Graphics };
     D3D12GraphicsPipelineStateInfo          graphicsPiplineState {};
@@ -44,18 +47,36 @@ public:
 
     void bind(RHICommandList* commandList) override
     {
+        // Streams record the pipeline and bind it when executed into a D3D12CommandList
+        if (commandList->as<RHICommandStream>())
+        {
+            commandList->bindPipeline(this);
+            return;
+        }
+
         // Insight: CommandLists are converted as soon as possible to API type, to avoid interface pollution
-        const auto graphicsCommandList = commandList->as<D3D12CommandList>()->asGraphicsCommandList();
-        graphicsCommandList->SetPipelineState(mPipelineState.Get());
-        graphicsCommandList->SetGraphicsRootSignature(mRootSignature.Get());
+        D3D12CommandList::fromRHI(commandList, "D3D12Pipeline::bind()")->bindPipeline(this);
     }
 
+    ID3D12PipelineState* getPipelineState() const { return mPipelineState.Get(); }
+    ID3D12RootSignature* getRootSignature() const { return mRootSignature.Get(); }
+    PipelineType         getPipelineType()  const { return mPipelineType; }
+
+    // Root parameter holding the push constant ranges as 32-bit root constants, std::nullopt if the pipeline declares none
+    std::optional<UINT>  getPushConstantsRootIndex() const { return mPushConstantsRootIndex; }
+
 private:
+    void createComputePipelineState(const D3D12PipelineCreateInfo& createInfo);
+
     static D3D12_ROOT_SIGNATURE_FLAGS getRootSignatureFlags(bool hasVertexInputs);
 
+    // Push constants are bound to register b0, visible to the stages of the declared ranges
+    static D3D12_ROOT_PARAMETER makePushConstantsParameter(const std::vector<RHIPushConstantRange>& ranges);
+
     ComPtr<ID3D12RootSignature> mRootSignature;
     ComPtr<ID3D12PipelineState> mPipelineState;
     PipelineType                mPipelineType;
+    std::optional<UINT>         mPushConstantsRootIndex;
     D3D12Device*                mDevice;
     const char*                 mName;
 };
\ No newline at end of file
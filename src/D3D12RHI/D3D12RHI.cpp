@@ -3,6 +3,7 @@
 #include "D3D12Buffer.hpp"
 #include "D3D12CommandList.hpp"
 #include "D3D12Device.hpp"
+#include "D3D12Fence.hpp"
 #include "D3D12CommandQueue.hpp"
 #include "D3D12Framebuffer.hpp"
 #include "D3D12Pipeline.hpp"
@@ -39,6 +40,12 @@ D3D12RHI::D3D12RHI(const D3D12RHICreateInfo& createInfo)
 
     mCurrentFrame = 0;
 
+    mTransientAllocator = D3D12TransientAllocator::createD3D12TransientAllocator({
+        .bufferSize     = createInfo.transientBufferSize,
+        .framesInFlight = mFramesInFlight,
+        .pDevice        = mDevice.get(),
+    });
+
     D3D12_PRINTLN(fmt::format("{} RHI initialized", D3D12_STYLED_PREFIX));
 }
 
@@ -74,6 +81,12 @@ Frame D3D12RHI::beginFrame(const RHIFrameBeginInfo& frameBeginInfo)
 
     mFenceValues[mFrameIndex] = currentFence + 1;
 
+    // The allocator of this back buffer is no longer in use by the GPU
+    mDevice->getDirectQueue()->setFrameIndex(mFrameIndex);
+
+    // submitFrame waits for the GPU to go idle, so the transient data of this frame slot is no longer in use
+    mTransientAllocator->reset(mCurrentFrame);
+
     return {
         .mCurrentFrame = mCurrentFrame,
         .mAcquiredFrameIndex = mFrameIndex,
@@ -106,7 +119,8 @@ std::unique_ptr<RHIRenderPass> D3D12RHI::createRenderPass(const RHIRenderPassCre
 {
     D3D12RenderPassCreateInfo d3d12CreateInfo = {};
 
-    for (uint32_t i = 0; i < mFramesInFlight; i++)
+    // Render targets are looked up by the current back buffer index
+    for (uint32_t i = 0; i < mSwapchain->getFrameCount(); i++)
     {
         std::vector<D3D12RenderTarget> frameRenderTargets;
         for (const auto& [j, colorAttachment] : std::views::enumerate(createInfo.colorAttachments))
@@ -169,7 +183,8 @@ std::unique_ptr<RHIPipeline> D3D12RHI::createPipeline(const RHIPipelineCreateInf
         .inputElements = inputElements,
         .enableDepth = createInfo.graphicsPipelineState.depthTest,
         .shadersCreateInfos = createInfo.shaderCreateInfos,
-        .renderPass = createInfo.renderPass->as<D3D12RenderPass>(),
+        .pushConstantRanges = createInfo.pushConstantRanges,
+        .renderPass = createInfo.renderPass ? createInfo.renderPass->as<D3D12RenderPass>() : nullptr,
         .pipelineType = createInfo.pipelineType,
         .graphicsPiplineState = D3D12GraphicsPipelineStateInfo().setCullMode(toD3D12(createInfo.graphicsPipelineState.cullMode)),
         .device = mDevice.get(),
@@ -189,6 +204,105 @@ std::unique_ptr<RHIBuffer> D3D12RHI::createBuffer(const RHIBufferCreateInfo& cre
     });
 }
 
+RHITransientAllocation D3D12RHI::allocateTransient(const uint64_t size, const uint64_t alignment, const RHIBufferType usage)
+{
+    return mTransientAllocator->allocate(mCurrentFrame, size, alignment, usage);
+}
+
+RHIUploadToken D3D12RHI::uploadBuffer(RHIBuffer* dstBuffer, const void* pData, const uint64_t dataSize, const uint64_t dstOffset)
+{
+    // Not batched yet: copies through a temporary upload heap buffer and blocks until the copy has completed
+    const auto stagingBuffer = createBuffer({
+        .bufferSize = dataSize,
+        .bufferType = Staging,
+        .debugName  = "Upload Staging",
+    });
+    stagingBuffer->setData(pData, dataSize);
+
+    getGraphicsQueue()->executeSingleTimeCommand([&](RHICommandList* commandList) {
+        dstBuffer->uploadData({
+            .pData          = pData,
+            .dataSize       = dataSize,
+            .pCommandList   = commandList,
+            .pStagingBuffer = stagingBuffer.get(),
+            .dstOffset      = dstOffset,
+        });
+    });
+
+    return {};
+}
+
+RHIUploadToken D3D12RHI::uploadTexture(RHITexture* dstTexture, const void* pData, const uint64_t dataSize)
+{
+    auto* texture = dstTexture->as<D3D12Texture>();
+    const auto resourceDesc = texture->getResource()->GetDesc();
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    uint32_t rowCount  = 0;
+    uint64_t rowSize   = 0;
+    uint64_t totalSize = 0;
+    mDevice->getCopyableFootprint(resourceDesc, footprint, rowCount, rowSize, totalSize);
+
+    if (dataSize < rowSize * rowCount)
+    {
+        throw std::runtime_error(fmt::format("Texture upload of {} bytes is smaller than the {} bytes of texel data", dataSize, rowSize * rowCount));
+    }
+
+    // Same as uploadBuffer: a temporary upload heap buffer, with the tightly packed rows spread out to the aligned row pitch
+    const auto stagingBuffer = createBuffer({
+        .bufferSize = totalSize,
+        .bufferType = Staging,
+        .debugName  = "Texture Upload Staging",
+    });
+
+    auto* pStaging = static_cast<char*>(stagingBuffer->getMappedData()) + footprint.Offset;
+    for (uint32_t row = 0; row < rowCount; row++)
+    {
+        memcpy(pStaging + row * footprint.Footprint.RowPitch, static_cast<const char*>(pData) + row * rowSize, rowSize);
+    }
+
+    getGraphicsQueue()->executeSingleTimeCommand([&](RHICommandList* commandList) {
+        texture->uploadData(commandList->as<D3D12CommandList>()->asGraphicsCommandList(),
+                            stagingBuffer->as<D3D12Buffer>()->getResource(), footprint);
+    });
+
+    return {};
+}
+
+std::unique_ptr<RHIPipeline> D3D12RHI::createPipelineAsync(const RHIPipelineCreateInfo& createInfo, RHIPipeline* fallback)
+{
+    // No worker pool yet, the pipeline is ready when returned
+    return createPipeline(createInfo);
+}
+
+std::vector<std::unique_ptr<RHIPipeline>> D3D12RHI::createPipelines(const std::span<const RHIPipelineCreateInfo> createInfos)
+{
+    std::vector<std::unique_ptr<RHIPipeline>> pipelines;
+    for (const auto& createInfo : createInfos)
+    {
+        pipelines.push_back(createPipeline(createInfo));
+    }
+    return pipelines;
+}
+
+bool D3D12RHI::isUploadComplete(const RHIUploadToken token)
+{
+    return true;
+}
+
+void D3D12RHI::waitForUpload(const RHIUploadToken token)
+{
+}
+
+std::unique_ptr<RHIFence> D3D12RHI::createFence(const RHIFenceCreateInfo& createInfo)
+{
+    return D3D12Fence::createD3D12Fence({
+        .initialValue = createInfo.initialValue,
+        .debugName    = createInfo.debugName,
+        .pDevice      = mDevice.get(),
+    });
+}
+
 std::unique_ptr<RHITexture> D3D12RHI::createTexture(const RHITextureCreateInfo& createInfo)
 {
     return D3D12Texture::createD3D12Texture({
@@ -205,6 +319,18 @@ RHICommandQueue* D3D12RHI::getGraphicsQueue()
     return mDevice->getDirectQueue();
 }
 
+RHICommandQueue* D3D12RHI::getTransferQueue()
+{
+    // No copy queue is created yet, transfers share the direct queue
+    return mDevice->getDirectQueue();
+}
+
+RHICommandQueue* D3D12RHI::getComputeQueue()
+{
+    // No compute queue is created yet, compute work shares the direct queue
+    return mDevice->getDirectQueue();
+}
+
 void D3D12RHI::createFactory()
 {
     uint32_t factory_flags = 0;
@@ -6,10 +6,12 @@
 #include "D3D12Core.hpp"
 #include "D3D12Device.hpp"
 #include "D3D12Swapchain.hpp"
+#include "D3D12TransientAllocator.hpp"
 
 struct D3D12RHICreateInfo
 {
     RHIWindow* pWindow;
+    uint64_t   transientBufferSize = 16ull * 1024 * 1024;
 };
 
 class D3D12RHI final : public DynamicRHI
@@ -32,13 +34,33 @@ public:
 
     std::unique_ptr<RHIPipeline> createPipeline(const RHIPipelineCreateInfo& createInfo) override;
 
+    std::unique_ptr<RHIPipeline> createPipelineAsync(const RHIPipelineCreateInfo& createInfo, RHIPipeline* fallback = nullptr) override;
+
+    std::vector<std::unique_ptr<RHIPipeline>> createPipelines(std::span<const RHIPipelineCreateInfo> createInfos) override;
+
     std::unique_ptr<RHIBuffer> createBuffer(const RHIBufferCreateInfo& createInfo) override;
 
     std::unique_ptr<RHITexture> createTexture(const RHITextureCreateInfo& createInfo) override;
 
+    RHITransientAllocation allocateTransient(uint64_t size, uint64_t alignment, RHIBufferType usage) override;
+
+    RHIUploadToken uploadBuffer(RHIBuffer* dstBuffer, const void* pData, uint64_t dataSize, uint64_t dstOffset = 0) override;
+
+    RHIUploadToken uploadTexture(RHITexture* dstTexture, const void* pData, uint64_t dataSize) override;
+
+    bool isUploadComplete(RHIUploadToken token) override;
+
+    void waitForUpload(RHIUploadToken token) override;
+
+    std::unique_ptr<RHIFence> createFence(const RHIFenceCreateInfo& createInfo) override;
+
 
     RHICommandQueue* getGraphicsQueue() override;
 
+    RHICommandQueue* getTransferQueue() override;
+
+    RHICommandQueue* getComputeQueue() override;
+
     RHIInterfaceType      getType()      const override { return RHIInterfaceType::D3D12; }
     RHISwapchain*         getSwapchain() const override { return mSwapchain.get(); }
     ComPtr<IDXGIFactory4> getFactory()   const { return mFactory; }
@@ -56,6 +78,8 @@ private:
     std::unique_ptr<D3D12Device>    mDevice;
     std::unique_ptr<D3D12Swapchain> mSwapchain;
 
+    std::unique_ptr<D3D12TransientAllocator> mTransientAllocator;
+
     std::vector<uint64_t>           mFenceValues;
     ComPtr<ID3D12Fence>             mFence;
     HANDLE                          mFenceEvent {nullptr};
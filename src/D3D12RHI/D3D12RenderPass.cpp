@@ -16,7 +16,7 @@ std::unique_ptr<D3D12RenderPass> D3D12RenderPass::createD3D12RenderPass(D3D12Ren
 
 void D3D12RenderPass::execute(RHICommandList* commandList, RHIFramebufferHandle* framebuffer, std::function<void(RHICommandList*)> lambda)
 {
-    const auto graphicsCommandList = commandList->as<D3D12CommandList>()->asGraphicsCommandList();
+    const auto graphicsCommandList = D3D12CommandList::fromRHI(commandList, "D3D12RenderPass::execute()")->asGraphicsCommandList();
 
     std::vector<CD3DX12_CPU_DESCRIPTOR_HANDLE> rtvHandles;
     std::vector<CD3DX12_RESOURCE_BARRIER> rtvBeginBarriers;
@@ -74,7 +74,7 @@ uint32_t D3D12Swapchain::getNextFrameIndex(uint32_t currentFrame) const
 
 void D3D12Swapchain::setScissorViewport(RHICommandList* commandList) const
 {
-    const auto graphicsCommandList = commandList->as<D3D12CommandList>()->asGraphicsCommandList();
-    graphicsCommandList->RSSetViewports(1, &mViewport);
-    graphicsCommandList->RSSetScissorRects(1, &mScissor);
+    // Through the RHI interface, so deferred streams record the state as well
+    commandList->setViewport(toRHI(mViewport));
+    commandList->setScissor(toRHI(mScissor));
 }
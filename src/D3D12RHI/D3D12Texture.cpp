@@ -91,3 +91,20 @@ void D3D12Texture::createDSV()
         .debugName = "DSV",
     });
 }
+
+void D3D12Texture::uploadData(ID3D12GraphicsCommandList* commandList, ID3D12Resource* srcBuffer, const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint)
+{
+    if (mState != D3D12_RESOURCE_STATE_COPY_DEST)
+    {
+        const auto toCopyBarrier = CD3DX12_RESOURCE_BARRIER::Transition(mResource, mState, D3D12_RESOURCE_STATE_COPY_DEST);
+        commandList->ResourceBarrier(1, &toCopyBarrier);
+    }
+
+    const CD3DX12_TEXTURE_COPY_LOCATION dst(mResource, 0);
+    const CD3DX12_TEXTURE_COPY_LOCATION src(srcBuffer, footprint);
+    commandList->CopyTextureRegion(&dst, 0, 0, 0, &src, nullptr);
+
+    mState = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE | D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    const auto toShaderReadBarrier = CD3DX12_RESOURCE_BARRIER::Transition(mResource, D3D12_RESOURCE_STATE_COPY_DEST, mState);
+    commandList->ResourceBarrier(1, &toShaderReadBarrier);
+}
@@ -29,6 +29,11 @@ public:
         return dsvHandle;
     }
 
+    ID3D12Resource* getResource() const { return mResource; }
+
+    // Copies the first subresource from the buffer laid out as footprint, the texture is left shader readable
+    void uploadData(ID3D12GraphicsCommandList* commandList, ID3D12Resource* srcBuffer, const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint);
+
 private:
     void createDSV();
 
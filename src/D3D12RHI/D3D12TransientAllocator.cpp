@@ -0,0 +1,86 @@
+#include "D3D12TransientAllocator.hpp"
+
+D3D12TransientAllocator::D3D12TransientAllocator(const D3D12TransientAllocatorCreateInfo& createInfo)
+: mDevice(createInfo.pDevice)
+{
+    const uint64_t regionAlignment = getUsageAlignment(Uniform);
+    mRegionSize = createInfo.bufferSize / createInfo.framesInFlight / regionAlignment * regionAlignment;
+
+    mBuffer = D3D12Buffer::createD3D12Buffer({
+        .bufferSize  = mRegionSize * createInfo.framesInFlight,
+        .bufferType  = Uniform,
+        .pDevice     = mDevice,
+        .debugName   = L"Transient Ring Buffer",
+        .hostVisible = true,
+    });
+
+    mFrameRegions.resize(createInfo.framesInFlight);
+    for (uint32_t i = 0; i < createInfo.framesInFlight; i++)
+    {
+        mFrameRegions[i].begin = i * mRegionSize;
+        mFrameRegions[i].head  = mFrameRegions[i].begin;
+    }
+}
+
+std::unique_ptr<D3D12TransientAllocator> D3D12TransientAllocator::createD3D12TransientAllocator(const D3D12TransientAllocatorCreateInfo& createInfo)
+{
+    return std::make_unique<D3D12TransientAllocator>(createInfo);
+}
+
+RHITransientAllocation D3D12TransientAllocator::allocate(const uint32_t frameIndex, const uint64_t size, const uint64_t alignment, const RHIBufferType usage)
+{
+    auto& region = mFrameRegions[frameIndex];
+
+    const uint64_t effectiveAlignment = std::max<uint64_t>({ alignment, getUsageAlignment(usage), 1 });
+    const uint64_t offset = (region.head + effectiveAlignment - 1) / effectiveAlignment * effectiveAlignment;
+
+    if (offset + size <= region.begin + mRegionSize)
+    {
+        region.head = offset + size;
+        return {
+            .buffer = mBuffer.get(),
+            .offset = offset,
+            .size   = size,
+            .pData  = static_cast<char*>(mBuffer->getMappedData()) + offset,
+        };
+    }
+
+    // The region is exhausted, fall back to a buffer that lives until the frame is reclaimed
+    D3D12_DEBUG(fmt::format("{}", styled(fmt::format("Transient region of frame {} exhausted, allocating {} byte overflow buffer", frameIndex, size), fg(fmt::color::light_yellow))));
+
+    region.overflowBuffers.push_back(D3D12Buffer::createD3D12Buffer({
+        .bufferSize  = size,
+        .bufferType  = Uniform,
+        .pDevice     = mDevice,
+        .debugName   = L"Transient Overflow Buffer",
+        .hostVisible = true,
+    }));
+
+    auto* overflowBuffer = region.overflowBuffers.back().get();
+    return {
+        .buffer = overflowBuffer,
+        .offset = 0,
+        .size   = size,
+        .pData  = overflowBuffer->getMappedData(),
+    };
+}
+
+void D3D12TransientAllocator::reset(const uint32_t frameIndex)
+{
+    auto& region = mFrameRegions[frameIndex];
+    region.head = region.begin;
+    region.overflowBuffers.clear();
+}
+
+uint64_t D3D12TransientAllocator::getUsageAlignment(const RHIBufferType usage)
+{
+    switch (usage)
+    {
+        case Uniform:   return D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+        case Storage:   return D3D12_RAW_UAV_SRV_BYTE_ALIGNMENT;
+        case Index:
+        case Indirect:
+        case Vertex:    return sizeof(uint32_t);
+        default:        return 1;
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "D3D12Buffer.hpp"
+#include "D3D12Core.hpp"
+
+struct D3D12TransientAllocatorCreateInfo
+{
+    uint64_t        bufferSize {16ull * 1024 * 1024};
+    uint32_t        framesInFlight {2};
+    D3D12Device*    pDevice {nullptr};
+};
+
+/**
+ * Upload heap ring buffer for per-frame transient data, the D3D12 counterpart of VulkanTransientAllocator.
+ * The ring is split into one linear region per frame in flight, reclaimed as a whole once the frame has completed.
+ */
+class D3D12TransientAllocator
+{
+public:
+    DISABLE_COPY_CTOR(D3D12TransientAllocator);
+    explicit DEF_PRIMARY_CTOR(D3D12TransientAllocator, const D3D12TransientAllocatorCreateInfo& createInfo);
+
+    ~D3D12TransientAllocator() = default;
+
+    RHITransientAllocation allocate(uint32_t frameIndex, uint64_t size, uint64_t alignment, RHIBufferType usage);
+
+    // Reclaims every allocation made for the frame, the GPU must have completed the frame before calling this
+    void reset(uint32_t frameIndex);
+
+private:
+    struct FrameRegion
+    {
+        uint64_t                                  begin  {0};
+        uint64_t                                  head   {0};
+        std::vector<std::unique_ptr<D3D12Buffer>> overflowBuffers;
+    };
+
+    static uint64_t getUsageAlignment(RHIBufferType usage);
+
+    std::unique_ptr<D3D12Buffer> mBuffer;
+    std::vector<FrameRegion>     mFrameRegions;
+    uint64_t                     mRegionSize;
+
+    D3D12Device*                 mDevice;
+};
@@ -18,7 +18,9 @@ std::unique_ptr<DynamicRHI> createRHI(const RHICreateInfo& rhiCreateInfo)
     if (rhiCreateInfo.apiType == RHIInterfaceType::Vulkan)
     {
         return VulkanRHI::createVulkanRHI({
-            .pWindow = rhiCreateInfo.pWindow
+            .pWindow        = rhiCreateInfo.pWindow,
+            .framesInFlight = rhiCreateInfo.framesInFlight,
+            .workerThreadCount = rhiCreateInfo.workerThreadCount,
         });
     }
     if (rhiCreateInfo.apiType == RHIInterfaceType::D3D12)
@@ -19,6 +19,8 @@ class DynamicRHI;
 class RHIBuffer;
 class RHICommandList;
 class RHICommandQueue;
+class RHICommandStream;
+class RHIFence;
 class RHIFramebuffer;
 class RHIFramebufferHandle;
 class RHIPipeline;
@@ -117,12 +119,14 @@ enum RHIBufferType
     Storage,
     Uniform,
     Vertex,
+    Indirect,
 };
 
 enum class RHICommandQueueType
 {
     Graphics,
     AsyncCompute,
+    Transfer,
 };
 
 enum class AttachmentLoadOp
@@ -237,6 +241,7 @@ enum class ShaderStage
 {
     Vertex,
     Fragment,
+    Compute,
 };
 
 enum class VertexInputRate
@@ -269,8 +274,12 @@ inline std::string toString(const RHIInterfaceType interfaceType) noexcept
  */
 struct RHICreateInfo
 {
-    RHIInterfaceType apiType = RHIInterfaceType::Vulkan;
-    RHIWindow*       pWindow = nullptr;
+    RHIInterfaceType apiType        = RHIInterfaceType::Vulkan;
+    RHIWindow*       pWindow        = nullptr;
+    // Frames the CPU may record ahead of the GPU, ignored by D3D12 which uses one per back buffer
+    uint32_t         framesInFlight = 2;
+    // Threads recording in parallel besides the calling one, defaults to one per additional hardware thread
+    std::optional<uint32_t> workerThreadCount = std::nullopt;
 };
 
 /**
@@ -411,13 +420,22 @@ struct RHIGraphicsPipelineState
     std::vector<AttachmentState>          attachmentStates      = {};
 };
 
+// Bytes [offset, offset + size) of the pipeline's push constant block, visible to the listed stages
+struct RHIPushConstantRange
+{
+    std::vector<ShaderStage> stages = {};
+    uint32_t                 offset = 0;
+    uint32_t                 size   = 0;
+};
+
 struct RHIPipelineCreateInfo
 {
-    std::vector<RHIShaderCreateInfo> shaderCreateInfos     = {};
-    RHIGraphicsPipelineState         graphicsPipelineState = {};
-    RHIRenderPass*                   renderPass            = nullptr;
-    PipelineType                     pipelineType          = PipelineType::Graphics;
-    const char*                      debugName             = {};
+    std::vector<RHIShaderCreateInfo>  shaderCreateInfos     = {};
+    std::vector<RHIPushConstantRange> pushConstantRanges    = {};
+    RHIGraphicsPipelineState          graphicsPipelineState = {};
+    RHIRenderPass*                    renderPass            = nullptr;
+    PipelineType                      pipelineType          = PipelineType::Graphics;
+    const char*                       debugName             = {};
 };
 
 #pragma endregion
@@ -433,6 +451,82 @@ struct RHIBufferCreateInfo
     RHIBufferType   bufferType;
     void*           pData      = nullptr;
     std::string     debugName  = {};
+    // Lets the backend move the buffer to other memory between frames, see RHIBuffer::getGeneration
+    bool            relocatable = false;
+    // Accessed from the compute queue while graphics uses it as well. Other buffers change queues through ownership transfers.
+    bool            sharedWithAsyncCompute = false;
+};
+
+// Argument layouts read by the indirect commands of RHICommandList, matching the native layouts of every backend
+struct RHIDrawIndirectArguments
+{
+    uint32_t        vertexCount   = 0;
+    uint32_t        instanceCount = 0;
+    uint32_t        firstVertex   = 0;
+    uint32_t        firstInstance = 0;
+};
+
+struct RHIDrawIndexedIndirectArguments
+{
+    uint32_t        indexCount    = 0;
+    uint32_t        instanceCount = 0;
+    uint32_t        firstIndex    = 0;
+    int32_t         vertexOffset  = 0;
+    uint32_t        firstInstance = 0;
+};
+
+struct RHIDispatchIndirectArguments
+{
+    uint32_t        groupCountX = 0;
+    uint32_t        groupCountY = 0;
+    uint32_t        groupCountZ = 0;
+};
+
+// Sub-range of a per-frame buffer, valid until the frame it was allocated in has finished on the GPU
+struct RHITransientAllocation
+{
+    RHIBuffer*      buffer = nullptr;
+    uint64_t        offset = 0;
+    uint64_t        size   = 0;
+    void*           pData  = nullptr;
+};
+
+// Identifies a batch of uploads, a value of 0 refers to data that is already resident
+struct RHIUploadToken
+{
+    uint64_t        value = 0;
+};
+
+#pragma endregion
+
+#pragma region "synchronization"
+
+struct RHIFenceCreateInfo
+{
+    uint64_t        initialValue = 0;
+    std::string     debugName    = {};
+};
+
+// A point on a fence's timeline, reached once the fence's value is greater than or equal to it
+struct RHIFenceValue
+{
+    RHIFence*       pFence = nullptr;
+    uint64_t        value  = 0;
+};
+
+struct RHISubmitInfo
+{
+    std::vector<RHICommandList*> commandLists;
+    // Waited on by the GPU before any of the command lists execute, fences may be signaled by other queues
+    std::vector<RHIFenceValue>   waitFences;
+    // Signaled by the GPU once all command lists have completed
+    std::vector<RHIFenceValue>   signalFences;
+};
+
+// Identifies a submission of single-time commands on a queue, a value of 0 refers to work that has already completed
+struct RHICommandTicket
+{
+    uint64_t        value = 0;
 };
 
 #pragma endregion
@@ -1,9 +1,11 @@
 #pragma once
 
 #include <memory>
+#include <span>
 #include "Definitions.hpp"
 #include "Frame.hpp"
 #include "RHIBuffer.hpp"
+#include "RHIFence.hpp"
 #include "RHIRenderPass.hpp"
 #include "RHITexture.hpp"
 
@@ -21,6 +23,20 @@ public:
 
     virtual std::unique_ptr<RHIBuffer>      createBuffer(const RHIBufferCreateInfo& createInfo) = 0;
 
+    // Allocates host-writable memory for the current frame, reclaimed automatically once the frame has completed
+    virtual RHITransientAllocation          allocateTransient(uint64_t size, uint64_t alignment, RHIBufferType usage) = 0;
+
+    // Queues a copy into the buffer through shared staging memory, the copy is submitted with the next frame
+    virtual RHIUploadToken                  uploadBuffer(RHIBuffer* dstBuffer, const void* pData, uint64_t dataSize, uint64_t dstOffset = 0) = 0;
+
+    // Copies tightly packed texel data into the first mip level, the texture is left in a shader readable layout
+    virtual RHIUploadToken                  uploadTexture(RHITexture* dstTexture, const void* pData, uint64_t dataSize) = 0;
+
+    virtual bool                            isUploadComplete(RHIUploadToken token) = 0;
+
+    // Submits the token's uploads if they are still pending, then blocks until they have completed
+    virtual void                            waitForUpload(RHIUploadToken token) = 0;
+
     virtual std::unique_ptr<RHITexture>     createTexture(const RHITextureCreateInfo& createInfo) = 0;
 
     virtual std::unique_ptr<RHIFramebuffer> createFramebuffer(const RHIFramebufferCreateInfo& createInfo) = 0;
@@ -29,7 +45,25 @@ public:
 
     virtual std::unique_ptr<RHIPipeline>    createPipeline(const RHIPipelineCreateInfo& createInfo) = 0;
 
+    /**
+     * Returns right away and compiles the pipeline on a worker thread, see RHIPipeline::isReady.
+     * Until then binding the pipeline binds the fallback instead. Without one, binding compiles the pipeline on the calling thread
+     * if no worker has picked it up yet, or waits for the worker that has, so it is safe to bind from worker threads.
+     * Everything the create info points to (paths, render pass, fallback) must outlive compilation.
+     */
+    virtual std::unique_ptr<RHIPipeline>    createPipelineAsync(const RHIPipelineCreateInfo& createInfo, RHIPipeline* fallback = nullptr) = 0;
+
+    // Compiles the pipelines in parallel and blocks until all are ready, e.g. to warm up at startup
+    virtual std::vector<std::unique_ptr<RHIPipeline>> createPipelines(std::span<const RHIPipelineCreateInfo> createInfos) = 0;
+
+    virtual std::unique_ptr<RHIFence>       createFence(const RHIFenceCreateInfo& createInfo) = 0;
+
     virtual RHICommandQueue* getGraphicsQueue()       = 0;
+    // Falls back to the graphics queue on devices without a dedicated transfer queue
+    virtual RHICommandQueue* getTransferQueue()       = 0;
+    // Falls back to the graphics queue on devices without a dedicated compute queue.
+    // Hand results over to the graphics queue by signaling an RHIFence the consuming submission waits on.
+    virtual RHICommandQueue* getComputeQueue()        = 0;
     virtual RHISwapchain*    getSwapchain()     const = 0;
 
     virtual RHIInterfaceType getType() const
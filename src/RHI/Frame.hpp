@@ -18,11 +18,27 @@ struct Frame
 
     uint32_t getAcquiredFrameIndex() const { return mAcquiredFrameIndex; }
 
+    // Fence values the frame's work waits for and signals, e.g. to consume results of another queue
+    std::vector<RHIFenceValue>   mWaitFences;
+    std::vector<RHIFenceValue>   mSignalFences;
+
     Frame& addCommandLists(const std::initializer_list<RHICommandList*> commandLists)
     {
         mCommandLists.insert(std::end(mCommandLists), std::begin(commandLists), std::end(commandLists));
         return *this;
     }
+
+    Frame& addWait(RHIFence* fence, const uint64_t value)
+    {
+        mWaitFences.push_back({ fence, value });
+        return *this;
+    }
+
+    Frame& addSignal(RHIFence* fence, const uint64_t value)
+    {
+        mSignalFences.push_back({ fence, value });
+        return *this;
+    }
 };
 
 rhi_END_NAMESPACE;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <limits>
 #include "Definitions.hpp"
 
 rhi_BEGIN_NAMESPACE;
@@ -11,6 +12,7 @@ struct RHIBufferUploadInfo
     uint64_t          dataSize       = 0;
     RHICommandList*   pCommandList   = nullptr;
     RHIBuffer*        pStagingBuffer = nullptr;
+    uint64_t          dstOffset      = 0;
 };
 
 class RHIBuffer
@@ -20,14 +22,27 @@ public:
 
     DEF_AS_CONVERT(RHIBuffer);
 
-    // Set buffer data via memory mapping, only for host-visible buffers.
-    virtual void setData(const void* pData, uint64_t dataSize) const = 0;
+    static constexpr uint64_t WholeSize = std::numeric_limits<uint64_t>::max();
 
-    // Upload data to a buffer via the specified Staging buffer.
+    // Set buffer data via the persistent mapping at the given offset, only for host-visible buffers.
+    virtual void setData(const void* pData, uint64_t dataSize, uint64_t offset = 0) const = 0;
+
+    // Stable CPU pointer to the buffer contents for host-visible buffers, nullptr otherwise.
+    virtual void* getMappedData() const = 0;
+
+    // Flush CPU writes to the GPU / invalidate CPU caches for GPU writes, required for non-coherent memory.
+    virtual void flush(uint64_t offset = 0, uint64_t size = WholeSize) const = 0;
+    virtual void invalidate(uint64_t offset = 0, uint64_t size = WholeSize) const = 0;
+
+    // Upload data to a buffer via the specified Staging buffer. Prefer DynamicRHI::uploadBuffer, which manages staging memory.
     virtual void uploadData(const RHIBufferUploadInfo& uploadInfo) = 0;
 
     virtual uint64_t getSize()   = 0;
     virtual uint64_t getOffset() = 0;
+
+    // Changes whenever a relocatable buffer was moved to new memory, which happens only between frames.
+    // Descriptors and device addresses cached from an older generation refer to freed memory and must be rebuilt.
+    virtual uint32_t getGeneration() const { return 0; }
 };
 
 rhi_END_NAMESPACE;
@@ -22,14 +22,51 @@ public:
      */
     virtual void draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) = 0;
     virtual void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance) = 0;
-    virtual void bindVertexBuffer(RHIBuffer* buffer) = 0;
-    virtual void bindIndexBuffer(RHIBuffer* buffer) = 0;
+    virtual void bindVertexBuffer(RHIBuffer* buffer, uint64_t offset = 0) = 0;
+    virtual void bindIndexBuffer(RHIBuffer* buffer, uint64_t offset = 0) = 0;
+
+    // Equivalent to pipeline->bind(this), deferred streams record the pipeline and bind it when executed
+    virtual void bindPipeline(RHIPipeline* pipeline) = 0;
+    virtual void setViewport(const Viewport& viewport) = 0;
+    virtual void setScissor(const Rect2D& scissor) = 0;
+
+    /**
+     * Indirect commands, reading their arguments from the buffer at offset, consecutive draws are stride bytes apart.
+     * Buffers must be created as RHIBufferType::Indirect.
+     */
+    virtual void drawIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndirectArguments)) = 0;
+    virtual void drawIndexedIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) = 0;
+    // The draw count is read as a uint32_t from countBuffer at countOffset, and clamped to maxDrawCount
+    virtual void drawIndexedIndirectCount(RHIBuffer* buffer, uint64_t offset, RHIBuffer* countBuffer, uint64_t countOffset,
+                                          uint32_t maxDrawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) = 0;
+
+    /**
+     * Compute commands, running the last bound compute pipeline.
+     * Indirect dispatches read an RHIDispatchIndirectArguments from the buffer at offset.
+     */
+    virtual void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) = 0;
+    virtual void dispatchIndirect(RHIBuffer* buffer, uint64_t offset) = 0;
+
+    // Updates push constants of the last bound pipeline, the bytes must lie within its declared ranges
+    virtual void pushConstants(ShaderStage stage, uint32_t offset, uint32_t size, const void* pData) = 0;
+
+    template <class T>
+    void pushConstants(const ShaderStage stage, const T& data, const uint32_t offset = 0)
+    {
+        pushConstants(stage, offset, sizeof(T), &data);
+    }
 
     /**
      * Transfer operations
      */
     virtual void copyBuffer(RHIBuffer* src, RHIBuffer* dst) = 0;
 
+    /**
+     * Records the commands of a deferred stream into this list.
+     * The default implementation replays every packet through the virtual interface, backends translate the packets directly.
+     */
+    virtual void executeStream(const RHICommandStream& stream);
+
 protected:
     bool mIsRecording = false;
 };
@@ -13,10 +13,31 @@ public:
 
     DEF_AS_CONVERT(RHICommandQueue);
 
-    virtual RHICommandList*     getCommandList(uint32_t index) = 0;
+    // Hands out a command list for the current frame, from a pool owned by the calling thread.
+    // The list stays valid until the frame has been submitted, its memory is recycled once the GPU has completed it.
+    virtual RHICommandList*     acquireCommandList() = 0;
+    // Marks a command list acquired this frame as no longer used by the caller
+    virtual void                releaseCommandList(RHICommandList* commandList) = 0;
+
     virtual RHICommandQueueType getType() = 0;
 
-    virtual void executeSingleTimeCommand(const std::function<void(RHICommandList*)>& lambda) = 0;
+    // Submits the command lists after the GPU has reached the wait values, may be called from any thread
+    virtual void                submit(const RHISubmitInfo& submitInfo) = 0;
+
+    // Records and submits the commands, then blocks until the GPU has completed them
+    virtual void             executeSingleTimeCommand(const std::function<void(RHICommandList*)>& lambda) = 0;
+
+    // Records the commands without waiting for them. Commands recorded in the same frame are submitted together,
+    // at the latest ahead of the frame's work, or earlier when flushed or waited on.
+    virtual RHICommandTicket executeSingleTimeCommandAsync(const std::function<void(RHICommandList*)>& lambda) = 0;
+
+    virtual bool             isComplete(RHICommandTicket ticket) = 0;
+
+    // Submits the ticket's commands if still pending and blocks until they have completed
+    virtual void             wait(RHICommandTicket ticket) = 0;
+
+    // Submits the single-time commands recorded so far, may be called from any thread
+    virtual void             flushSingleTimeCommands() = 0;
 };
 
 rhi_END_NAMESPACE;
@@ -0,0 +1,147 @@
+#include "RHICommandStream.hpp"
+
+rhi_BEGIN_NAMESPACE;
+
+void RHICommandList::executeStream(const RHICommandStream& stream)
+{
+    stream.visit(RHICommandVisitor {
+        [this](const RHIDrawCommand& command) {
+            draw(command.vertexCount, command.instanceCount, command.firstVertex, command.firstInstance);
+        },
+        [this](const RHIDrawIndexedCommand& command) {
+            drawIndexed(command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+        },
+        [this](const RHIBindVertexBufferCommand& command) {
+            bindVertexBuffer(command.pBuffer, command.offset);
+        },
+        [this](const RHIBindIndexBufferCommand& command) {
+            bindIndexBuffer(command.pBuffer, command.offset);
+        },
+        [this](const RHIDrawIndirectCommand& command) {
+            drawIndirect(command.pBuffer, command.offset, command.drawCount, command.stride);
+        },
+        [this](const RHIDrawIndexedIndirectCommand& command) {
+            drawIndexedIndirect(command.pBuffer, command.offset, command.drawCount, command.stride);
+        },
+        [this](const RHIDrawIndexedIndirectCountCommand& command) {
+            drawIndexedIndirectCount(command.pBuffer, command.offset, command.pCountBuffer, command.countOffset, command.maxDrawCount, command.stride);
+        },
+        [this](const RHIDispatchCommand& command) {
+            dispatch(command.groupCountX, command.groupCountY, command.groupCountZ);
+        },
+        [this](const RHIDispatchIndirectCommand& command) {
+            dispatchIndirect(command.pBuffer, command.offset);
+        },
+        [this](const RHIPushConstantsCommand& command) {
+            pushConstants(command.stage, command.offset, command.size, command.getData());
+        },
+        [this](const RHICopyBufferCommand& command) {
+            copyBuffer(command.pSrc, command.pDst);
+        },
+        [this](const RHIBindPipelineCommand& command) {
+            bindPipeline(command.pPipeline);
+        },
+        [this](const RHISetViewportCommand& command) {
+            setViewport(command.viewport);
+        },
+        [this](const RHISetScissorCommand& command) {
+            setScissor(command.scissor);
+        },
+    });
+}
+
+RHICommandStream::RHICommandStream(const uint64_t initialCapacity)
+: RHICommandList()
+{
+    mData.resize(initialCapacity);
+}
+
+std::unique_ptr<RHICommandStream> RHICommandStream::createRHICommandStream(const uint64_t initialCapacity)
+{
+    return std::make_unique<RHICommandStream>(initialCapacity);
+}
+
+void RHICommandStream::begin()
+{
+    mSize         = 0;
+    mCommandCount = 0;
+    mIsRecording  = true;
+}
+
+void RHICommandStream::end()
+{
+    mIsRecording = false;
+}
+
+void RHICommandStream::draw(const uint32_t vertexCount, const uint32_t instanceCount, const uint32_t firstVertex, const uint32_t firstInstance)
+{
+    push(RHIDrawCommand { vertexCount, instanceCount, firstVertex, firstInstance });
+}
+
+void RHICommandStream::drawIndexed(const uint32_t indexCount, const uint32_t instanceCount, const uint32_t firstIndex, const uint32_t vertexOffset, const uint32_t firstInstance)
+{
+    push(RHIDrawIndexedCommand { indexCount, instanceCount, firstIndex, vertexOffset, firstInstance });
+}
+
+void RHICommandStream::bindVertexBuffer(RHIBuffer* buffer, const uint64_t offset)
+{
+    push(RHIBindVertexBufferCommand { buffer, offset });
+}
+
+void RHICommandStream::bindIndexBuffer(RHIBuffer* buffer, const uint64_t offset)
+{
+    push(RHIBindIndexBufferCommand { buffer, offset });
+}
+
+void RHICommandStream::bindPipeline(RHIPipeline* pipeline)
+{
+    push(RHIBindPipelineCommand { pipeline });
+}
+
+void RHICommandStream::setViewport(const Viewport& viewport)
+{
+    push(RHISetViewportCommand { viewport });
+}
+
+void RHICommandStream::setScissor(const Rect2D& scissor)
+{
+    push(RHISetScissorCommand { scissor });
+}
+
+void RHICommandStream::drawIndirect(RHIBuffer* buffer, const uint64_t offset, const uint32_t drawCount, const uint32_t stride)
+{
+    push(RHIDrawIndirectCommand { buffer, offset, drawCount, stride });
+}
+
+void RHICommandStream::drawIndexedIndirect(RHIBuffer* buffer, const uint64_t offset, const uint32_t drawCount, const uint32_t stride)
+{
+    push(RHIDrawIndexedIndirectCommand { buffer, offset, drawCount, stride });
+}
+
+void RHICommandStream::drawIndexedIndirectCount(RHIBuffer* buffer, const uint64_t offset, RHIBuffer* countBuffer, const uint64_t countOffset,
+                                                const uint32_t maxDrawCount, const uint32_t stride)
+{
+    push(RHIDrawIndexedIndirectCountCommand { buffer, offset, countBuffer, countOffset, maxDrawCount, stride });
+}
+
+void RHICommandStream::dispatch(const uint32_t groupCountX, const uint32_t groupCountY, const uint32_t groupCountZ)
+{
+    push(RHIDispatchCommand { groupCountX, groupCountY, groupCountZ });
+}
+
+void RHICommandStream::dispatchIndirect(RHIBuffer* buffer, const uint64_t offset)
+{
+    push(RHIDispatchIndirectCommand { buffer, offset });
+}
+
+void RHICommandStream::pushConstants(const ShaderStage stage, const uint32_t offset, const uint32_t size, const void* pData)
+{
+    push(RHIPushConstantsCommand { stage, offset, size }, pData, size);
+}
+
+void RHICommandStream::copyBuffer(RHIBuffer* src, RHIBuffer* dst)
+{
+    push(RHICopyBufferCommand { src, dst });
+}
+
+rhi_END_NAMESPACE;
@@ -0,0 +1,306 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <vector>
+#include "RHICommandList.hpp"
+
+rhi_BEGIN_NAMESPACE;
+
+#pragma region "Command packets"
+
+enum class RHICommandType : uint32_t
+{
+    Draw,
+    DrawIndexed,
+    BindVertexBuffer,
+    BindIndexBuffer,
+    DrawIndirect,
+    DrawIndexedIndirect,
+    DrawIndexedIndirectCount,
+    Dispatch,
+    DispatchIndirect,
+    PushConstants,
+    CopyBuffer,
+    BindPipeline,
+    SetViewport,
+    SetScissor,
+};
+
+struct RHICommandHeader
+{
+    RHICommandType type;
+    // Bytes from this header to the next one
+    uint32_t       size;
+};
+
+struct RHIDrawCommand
+{
+    static constexpr auto Type = RHICommandType::Draw;
+    uint32_t vertexCount;
+    uint32_t instanceCount;
+    uint32_t firstVertex;
+    uint32_t firstInstance;
+};
+
+struct RHIDrawIndexedCommand
+{
+    static constexpr auto Type = RHICommandType::DrawIndexed;
+    uint32_t indexCount;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    uint32_t vertexOffset;
+    uint32_t firstInstance;
+};
+
+struct RHIBindVertexBufferCommand
+{
+    static constexpr auto Type = RHICommandType::BindVertexBuffer;
+    RHIBuffer* pBuffer;
+    uint64_t   offset;
+};
+
+struct RHIBindIndexBufferCommand
+{
+    static constexpr auto Type = RHICommandType::BindIndexBuffer;
+    RHIBuffer* pBuffer;
+    uint64_t   offset;
+};
+
+struct RHIDrawIndirectCommand
+{
+    static constexpr auto Type = RHICommandType::DrawIndirect;
+    RHIBuffer* pBuffer;
+    uint64_t   offset;
+    uint32_t   drawCount;
+    uint32_t   stride;
+};
+
+struct RHIDrawIndexedIndirectCommand
+{
+    static constexpr auto Type = RHICommandType::DrawIndexedIndirect;
+    RHIBuffer* pBuffer;
+    uint64_t   offset;
+    uint32_t   drawCount;
+    uint32_t   stride;
+};
+
+struct RHIDrawIndexedIndirectCountCommand
+{
+    static constexpr auto Type = RHICommandType::DrawIndexedIndirectCount;
+    RHIBuffer* pBuffer;
+    uint64_t   offset;
+    RHIBuffer* pCountBuffer;
+    uint64_t   countOffset;
+    uint32_t   maxDrawCount;
+    uint32_t   stride;
+};
+
+struct RHIDispatchCommand
+{
+    static constexpr auto Type = RHICommandType::Dispatch;
+    uint32_t groupCountX;
+    uint32_t groupCountY;
+    uint32_t groupCountZ;
+};
+
+struct RHIDispatchIndirectCommand
+{
+    static constexpr auto Type = RHICommandType::DispatchIndirect;
+    RHIBuffer* pBuffer;
+    uint64_t   offset;
+};
+
+// Followed by size bytes of push constant data within the same packet
+struct RHIPushConstantsCommand
+{
+    static constexpr auto Type = RHICommandType::PushConstants;
+    ShaderStage stage;
+    uint32_t    offset;
+    uint32_t    size;
+
+    const void* getData() const { return this + 1; }
+};
+
+struct RHICopyBufferCommand
+{
+    static constexpr auto Type = RHICommandType::CopyBuffer;
+    RHIBuffer* pSrc;
+    RHIBuffer* pDst;
+};
+
+struct RHIBindPipelineCommand
+{
+    static constexpr auto Type = RHICommandType::BindPipeline;
+    RHIPipeline* pPipeline;
+};
+
+struct RHISetViewportCommand
+{
+    static constexpr auto Type = RHICommandType::SetViewport;
+    Viewport viewport;
+};
+
+struct RHISetScissorCommand
+{
+    static constexpr auto Type = RHICommandType::SetScissor;
+    Rect2D scissor;
+};
+
+// Combines lambdas into one visitor for RHICommandStream::visit
+template <class... Fns>
+struct RHICommandVisitor : Fns...
+{
+    using Fns::operator()...;
+};
+
+#pragma endregion
+
+/**
+ * Backend independent command list, recording compact command packets into a linear arena.
+ * Recording needs no device objects, so a stream can be filled on any thread and executed into a backend
+ * command list later with RHICommandList::executeStream. A recorded stream stays valid until begin() is called
+ * again and may be executed any number of times, e.g. once every frame.
+ * Referenced resources must outlive every execution of the stream.
+ */
+class RHICommandStream final : public RHICommandList
+{
+public:
+    DISABLE_COPY_CTOR(RHICommandStream);
+    explicit DEF_PRIMARY_CTOR(RHICommandStream, uint64_t initialCapacity);
+
+    ~RHICommandStream() override = default;
+
+    // Discards previously recorded commands, the arena's memory is kept
+    void begin() override;
+    void end() override;
+
+    void draw(uint32_t vertexCount, uint32_t instanceCount, uint32_t firstVertex, uint32_t firstInstance) override;
+    void drawIndexed(uint32_t indexCount, uint32_t instanceCount, uint32_t firstIndex, uint32_t vertexOffset, uint32_t firstInstance) override;
+    void bindVertexBuffer(RHIBuffer* buffer, uint64_t offset = 0) override;
+    void bindIndexBuffer(RHIBuffer* buffer, uint64_t offset = 0) override;
+
+    void bindPipeline(RHIPipeline* pipeline) override;
+    void setViewport(const Viewport& viewport) override;
+    void setScissor(const Rect2D& scissor) override;
+
+    void drawIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndirectArguments)) override;
+    void drawIndexedIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) override;
+    void drawIndexedIndirectCount(RHIBuffer* buffer, uint64_t offset, RHIBuffer* countBuffer, uint64_t countOffset,
+                                  uint32_t maxDrawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) override;
+    void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) override;
+    void dispatchIndirect(RHIBuffer* buffer, uint64_t offset) override;
+
+    // The data is copied into the stream
+    void pushConstants(ShaderStage stage, uint32_t offset, uint32_t size, const void* pData) override;
+    using RHICommandList::pushConstants;
+
+    void copyBuffer(RHIBuffer* src, RHIBuffer* dst) override;
+
+    // Invokes visitor with every recorded packet, in recording order
+    template <class Visitor>
+    void visit(Visitor&& visitor) const;
+
+    uint32_t getCommandCount() const { return mCommandCount; }
+    uint64_t getSize()         const { return mSize; }
+
+private:
+    // Appends a packet, optionally followed by dataSize bytes of inline data
+    template <class Command>
+    void push(const Command& command, const void* pData = nullptr, uint32_t dataSize = 0);
+
+    // Packet members are at most 8-byte aligned
+    static constexpr uint64_t sPacketAlignment = 8;
+
+    std::vector<std::byte> mData;
+    uint64_t               mSize         {0};
+    uint32_t               mCommandCount {0};
+};
+
+template <class Command>
+void RHICommandStream::push(const Command& command, const void* pData, const uint32_t dataSize)
+{
+    static_assert(std::is_trivially_copyable_v<Command>, "Command packets are copied as raw bytes");
+
+    const uint64_t packetSize = (sizeof(RHICommandHeader) + sizeof(Command) + dataSize + sPacketAlignment - 1) & ~(sPacketAlignment - 1);
+    if (mSize + packetSize > mData.size())
+    {
+        mData.resize(std::max(mData.size() * 2, mSize + packetSize));
+    }
+
+    const RHICommandHeader header = { Command::Type, static_cast<uint32_t>(packetSize) };
+    std::memcpy(mData.data() + mSize, &header, sizeof(RHICommandHeader));
+    std::memcpy(mData.data() + mSize + sizeof(RHICommandHeader), &command, sizeof(Command));
+    if (dataSize > 0)
+    {
+        std::memcpy(mData.data() + mSize + sizeof(RHICommandHeader) + sizeof(Command), pData, dataSize);
+    }
+
+    mSize += packetSize;
+    mCommandCount++;
+}
+
+template <class Visitor>
+void RHICommandStream::visit(Visitor&& visitor) const
+{
+    const std::byte* data = mData.data();
+    for (uint64_t offset = 0; offset < mSize;)
+    {
+        const auto* header  = reinterpret_cast<const RHICommandHeader*>(data + offset);
+        const std::byte* payload = data + offset + sizeof(RHICommandHeader);
+
+        switch (header->type)
+        {
+            case RHICommandType::Draw:
+                visitor(*reinterpret_cast<const RHIDrawCommand*>(payload));
+                break;
+            case RHICommandType::DrawIndexed:
+                visitor(*reinterpret_cast<const RHIDrawIndexedCommand*>(payload));
+                break;
+            case RHICommandType::BindVertexBuffer:
+                visitor(*reinterpret_cast<const RHIBindVertexBufferCommand*>(payload));
+                break;
+            case RHICommandType::BindIndexBuffer:
+                visitor(*reinterpret_cast<const RHIBindIndexBufferCommand*>(payload));
+                break;
+            case RHICommandType::DrawIndirect:
+                visitor(*reinterpret_cast<const RHIDrawIndirectCommand*>(payload));
+                break;
+            case RHICommandType::DrawIndexedIndirect:
+                visitor(*reinterpret_cast<const RHIDrawIndexedIndirectCommand*>(payload));
+                break;
+            case RHICommandType::DrawIndexedIndirectCount:
+                visitor(*reinterpret_cast<const RHIDrawIndexedIndirectCountCommand*>(payload));
+                break;
+            case RHICommandType::Dispatch:
+                visitor(*reinterpret_cast<const RHIDispatchCommand*>(payload));
+                break;
+            case RHICommandType::DispatchIndirect:
+                visitor(*reinterpret_cast<const RHIDispatchIndirectCommand*>(payload));
+                break;
+            case RHICommandType::PushConstants:
+                visitor(*reinterpret_cast<const RHIPushConstantsCommand*>(payload));
+                break;
+            case RHICommandType::CopyBuffer:
+                visitor(*reinterpret_cast<const RHICopyBufferCommand*>(payload));
+                break;
+            case RHICommandType::BindPipeline:
+                visitor(*reinterpret_cast<const RHIBindPipelineCommand*>(payload));
+                break;
+            case RHICommandType::SetViewport:
+                visitor(*reinterpret_cast<const RHISetViewportCommand*>(payload));
+                break;
+            case RHICommandType::SetScissor:
+                visitor(*reinterpret_cast<const RHISetScissorCommand*>(payload));
+                break;
+        }
+
+        offset += header->size;
+    }
+}
+
+rhi_END_NAMESPACE;
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include "Definitions.hpp"
+
+rhi_BEGIN_NAMESPACE;
+
+/**
+ * Monotonically increasing 64-bit value shared between the CPU and the GPU queues.
+ * Queues signal and wait on values through RHICommandQueue::submit, the CPU can query, signal and wait on it directly.
+ */
+class RHIFence
+{
+public:
+    virtual ~RHIFence() = default;
+
+    DEF_AS_CONVERT(RHIFence);
+
+    // Highest value signaled so far
+    virtual uint64_t getCompletedValue() = 0;
+
+    // Sets the value from the CPU, it must be greater than the current value
+    virtual void     signal(uint64_t value) = 0;
+
+    // Blocks until the fence has reached the value, returns false if the timeout (in nanoseconds) expired first
+    virtual bool     wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max()) = 0;
+
+    bool isComplete(const uint64_t value) { return getCompletedValue() >= value; }
+};
+
+rhi_END_NAMESPACE;
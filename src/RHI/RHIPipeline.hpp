@@ -11,6 +11,9 @@ public:
     virtual ~RHIPipeline() = default;
 
     virtual void bind(RHICommandList* commandList) = 0;
+
+    // False while an asynchronously created pipeline is still compiling
+    virtual bool isReady() const { return true; }
 };
 
 rhi_END_NAMESPACE;
@@ -14,6 +14,23 @@ public:
     DEF_AS_CONVERT(RHIRenderPass);
 
     virtual void execute(RHICommandList* commandList, RHIFramebufferHandle* framebuffer, std::function<void(RHICommandList*)> lambda) = 0;
+
+    /**
+     * Splits the render pass into taskCount parts, invoking lambda(commandList, taskIndex) for each of them.
+     * Backends may record the parts concurrently into separate command lists, which are executed in task order.
+     * No state is shared between parts, each one has to bind its pipeline and set its dynamic state.
+     * The default implementation records all parts inline, one after the other.
+     */
+    virtual void executeParallel(RHICommandList* commandList, RHIFramebufferHandle* framebuffer, uint32_t taskCount,
+                                 const std::function<void(RHICommandList*, uint32_t)>& lambda)
+    {
+        execute(commandList, framebuffer, [&](RHICommandList* cmd) {
+            for (uint32_t i = 0; i < taskCount; i++)
+            {
+                lambda(cmd, i);
+            }
+        });
+    }
 };
 
 rhi_END_NAMESPACE;
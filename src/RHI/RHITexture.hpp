@@ -4,12 +4,33 @@
 
 rhi_BEGIN_NAMESPACE;
 
+/**
+ * Range of passes a transient texture is used in, both ends inclusive.
+ * Passes are numbered in the order they are executed within a frame.
+ */
+struct RHITextureLifetime
+{
+    uint32_t firstPass = 0;
+    uint32_t lastPass  = 0;
+
+    bool overlaps(const RHITextureLifetime& other) const
+    {
+        return firstPass <= other.lastPass and other.firstPass <= lastPass;
+    }
+};
+
 struct RHITextureCreateInfo
 {
-    Size2D      size        = {};
-    Format      format      = Format::R32G32B32A32Sfloat;
-    bool        sampled     = true;
-    std::string debugName   = {};
+    Size2D             size        = {};
+    Format             format      = Format::R32G32B32A32Sfloat;
+    bool               sampled     = true;
+    // Transient textures may share memory with other transients whose lifetimes do not overlap,
+    // their contents are undefined at the start of the first pass of their lifetime
+    bool               transient   = false;
+    RHITextureLifetime lifetime    = {};
+    std::string        debugName   = {};
+    // Lets the backend move the texture to other memory between frames, see RHITexture::getGeneration
+    bool               relocatable = false;
 };
 
 class RHITexture
@@ -18,6 +39,10 @@ public:
     virtual ~RHITexture() = default;
 
     DEF_AS_CONVERT(RHITexture);
+
+    // Changes whenever a relocatable texture was moved to new memory, which happens only between frames.
+    // Descriptors and views cached from an older generation refer to destroyed handles and must be rebuilt.
+    virtual uint32_t getGeneration() const { return 0; }
 };
 
 rhi_END_NAMESPACE;
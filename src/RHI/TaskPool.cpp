@@ -0,0 +1,151 @@
+#include "TaskPool.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+rhi_BEGIN_NAMESPACE;
+
+namespace
+{
+    // Identifies the pool a worker thread belongs to, threads of other pools use the outside slot
+    thread_local const TaskPool* tWorkerPool  = nullptr;
+    thread_local uint32_t        tWorkerIndex = 0;
+}
+
+TaskPool::TaskPool(const uint32_t workerCount)
+{
+    mWorkers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; i++)
+    {
+        mWorkers.emplace_back(&TaskPool::workerLoop, this, i);
+    }
+}
+
+std::unique_ptr<TaskPool> TaskPool::createTaskPool(const uint32_t workerCount)
+{
+    return std::make_unique<TaskPool>(workerCount);
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard lock(mMutex);
+        mStopping = true;
+    }
+    mCondition.notify_all();
+
+    for (auto& worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void TaskPool::parallelFor(const uint32_t taskCount, const std::function<void(uint32_t, uint32_t)>& fn)
+{
+    if (taskCount == 0)
+    {
+        return;
+    }
+
+    struct SharedState
+    {
+        std::atomic<uint32_t>   nextTask      {0};
+        std::atomic<uint32_t>   finishedTasks {0};
+        std::exception_ptr      exception;
+        std::mutex              mutex;
+        std::condition_variable finished;
+    };
+
+    const auto state = std::make_shared<SharedState>();
+
+    // Claims tasks until none are left. Helpers that start late find nothing to do and return,
+    // so the caller only ever waits for tasks, never for helpers to be scheduled.
+    const auto work = [state, &fn, taskCount](const uint32_t slotIndex) {
+        for (uint32_t task = state->nextTask++; task < taskCount; task = state->nextTask++)
+        {
+            try
+            {
+                fn(task, slotIndex);
+            }
+            catch (...)
+            {
+                std::lock_guard lock(state->mutex);
+                if (!state->exception)
+                {
+                    state->exception = std::current_exception();
+                }
+            }
+
+            if (state->finishedTasks.fetch_add(1) + 1 == taskCount)
+            {
+                std::lock_guard lock(state->mutex);
+                state->finished.notify_all();
+            }
+        }
+    };
+
+    const uint32_t helperCount = std::min(getWorkerCount(), taskCount - 1);
+    for (uint32_t i = 0; i < helperCount; i++)
+    {
+        // fn is only touched while tasks are left, which the caller outlives
+        enqueue([this, work] { work(getSlotIndex()); });
+    }
+
+    work(getSlotIndex());
+
+    std::unique_lock lock(state->mutex);
+    state->finished.wait(lock, [&] { return state->finishedTasks.load() == taskCount; });
+
+    if (state->exception)
+    {
+        std::rethrow_exception(state->exception);
+    }
+}
+
+uint32_t TaskPool::getSlotIndex() const
+{
+    return (tWorkerPool == this) ? tWorkerIndex : getWorkerCount();
+}
+
+void TaskPool::enqueue(std::function<void()> job)
+{
+    // Without workers nothing would ever pick the job up
+    if (mWorkers.empty())
+    {
+        job();
+        return;
+    }
+
+    {
+        std::lock_guard lock(mMutex);
+        mJobs.push_back(std::move(job));
+    }
+    mCondition.notify_one();
+}
+
+void TaskPool::workerLoop(const uint32_t workerIndex)
+{
+    tWorkerPool  = this;
+    tWorkerIndex = workerIndex;
+
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mMutex);
+            mCondition.wait(lock, [this] { return mStopping or !mJobs.empty(); });
+
+            if (mStopping and mJobs.empty())
+            {
+                return;
+            }
+
+            job = std::move(mJobs.front());
+            mJobs.pop_front();
+        }
+        job();
+    }
+}
+
+rhi_END_NAMESPACE;
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Macros.hpp"
+
+rhi_BEGIN_NAMESPACE;
+
+/**
+ * Fixed set of worker threads executing queued tasks.
+ * Every thread is given a stable slot index, workers use [0, workerCount) and any other thread uses workerCount.
+ * Per-thread resources (e.g. command pools) can be indexed by slot, provided only one outside thread uses them at a time.
+ */
+class TaskPool
+{
+public:
+    DISABLE_COPY_CTOR(TaskPool);
+    explicit DEF_PRIMARY_CTOR(TaskPool, uint32_t workerCount);
+
+    ~TaskPool();
+
+    // Runs fn on a worker, or right away on the calling thread if the pool has no workers
+    template <class Fn>
+    auto submit(Fn&& fn) -> std::future<std::invoke_result_t<Fn>>
+    {
+        using Result = std::invoke_result_t<Fn>;
+
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::forward<Fn>(fn));
+        std::future<Result> future = task->get_future();
+        enqueue([task] { (*task)(); });
+        return future;
+    }
+
+    /**
+     * Invokes fn(taskIndex, slotIndex) for every task and blocks until all of them have completed.
+     * The calling thread takes part in the work, so a pool without workers runs the tasks serially.
+     * The first exception thrown by a task is rethrown once the remaining tasks have finished.
+     */
+    void parallelFor(uint32_t taskCount, const std::function<void(uint32_t, uint32_t)>& fn);
+
+    uint32_t getWorkerCount() const { return static_cast<uint32_t>(mWorkers.size()); }
+
+    // Number of distinct slot indices, workers plus one for outside threads
+    uint32_t getSlotCount()   const { return getWorkerCount() + 1; }
+
+    // Slot index of the calling thread
+    uint32_t getSlotIndex()   const;
+
+private:
+    void enqueue(std::function<void()> job);
+
+    void workerLoop(uint32_t workerIndex);
+
+    std::vector<std::thread>          mWorkers;
+    std::deque<std::function<void()>> mJobs;
+    std::mutex                        mMutex;
+    std::condition_variable           mCondition;
+    bool                              mStopping {false};
+};
+
+rhi_END_NAMESPACE;
@@ -0,0 +1,112 @@
+#include "VulkanAliasingAllocator.hpp"
+
+VulkanAliasingAllocator::VulkanAliasingAllocator(const VulkanAliasingAllocatorCreateInfo& createInfo)
+: mDevice(createInfo.pDevice)
+{
+}
+
+std::unique_ptr<VulkanAliasingAllocator> VulkanAliasingAllocator::createVulkanAliasingAllocator(const VulkanAliasingAllocatorCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanAliasingAllocator>(createInfo);
+}
+
+VulkanAliasingAllocator::~VulkanAliasingAllocator()
+{
+    for (const auto& slot : mSlots)
+    {
+        mDevice->freeMemory(slot.allocation);
+    }
+}
+
+void VulkanAliasingAllocator::bind(const vk::Image image, const RHITextureLifetime& lifetime)
+{
+    const vk::MemoryRequirements requirements = mDevice->handle().getImageMemoryRequirements(image);
+
+    for (auto& slot : mSlots)
+    {
+        if (!isCompatible(slot, requirements, lifetime))
+        {
+            continue;
+        }
+
+        mDevice->handle().bindImageMemory(image, slot.allocation->getMemory(), slot.allocation->getOffset());
+        slot.occupants.push_back({ image, requirements.size, lifetime });
+        mAliasedBytes += requirements.size;
+
+        VK_VERBOSE(fmt::format("Aliased transient image with {} other image(s) ({} bytes)", slot.occupants.size() - 1, requirements.size));
+        return;
+    }
+
+    // Transients are never relocated, their allocation is left without an owner
+    VulkanAllocation* allocation = mDevice->allocateMemory({
+        .propertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal,
+        .target = image,
+        .avoidedFlags = vk::MemoryPropertyFlagBits::eHostVisible,
+    });
+    allocation->bind();
+
+    mSlots.push_back({
+        .allocation = allocation,
+        .occupants  = { { image, requirements.size, lifetime } },
+    });
+}
+
+void VulkanAliasingAllocator::release(const vk::Image image)
+{
+    const auto slot = findSlot(image);
+    if (slot == std::end(mSlots))
+    {
+        return;
+    }
+
+    const auto occupant = std::ranges::find(slot->occupants, image, &Occupant::image);
+
+    // The slot's memory was allocated for its first occupant, the others were aliased onto it
+    if (occupant != std::begin(slot->occupants))
+    {
+        mAliasedBytes -= occupant->size;
+    }
+    else if (slot->occupants.size() > 1)
+    {
+        mAliasedBytes -= std::next(occupant)->size;
+    }
+    slot->occupants.erase(occupant);
+
+    if (slot->occupants.empty())
+    {
+        mDevice->freeMemory(slot->allocation);
+        mSlots.erase(slot);
+    }
+}
+
+bool VulkanAliasingAllocator::isAliased(const vk::Image image) const
+{
+    return std::ranges::any_of(mSlots, [&](const Slot& slot) {
+        return slot.occupants.size() > 1 and std::ranges::contains(slot.occupants, image, &Occupant::image);
+    });
+}
+
+bool VulkanAliasingAllocator::isCompatible(const Slot& slot, const vk::MemoryRequirements& requirements, const RHITextureLifetime& lifetime) const
+{
+    const VulkanAllocation* allocation = slot.allocation;
+
+    if (!(requirements.memoryTypeBits & (1u << allocation->getBlock()->getMemoryTypeIndex())))
+    {
+        return false;
+    }
+    if (requirements.size > allocation->getSize() or allocation->getOffset() % requirements.alignment != 0)
+    {
+        return false;
+    }
+
+    return std::ranges::none_of(slot.occupants, [&](const Occupant& occupant) {
+        return occupant.lifetime.overlaps(lifetime);
+    });
+}
+
+std::vector<VulkanAliasingAllocator::Slot>::iterator VulkanAliasingAllocator::findSlot(const vk::Image image)
+{
+    return std::ranges::find_if(mSlots, [&](const Slot& slot) {
+        return std::ranges::contains(slot.occupants, image, &Occupant::image);
+    });
+}
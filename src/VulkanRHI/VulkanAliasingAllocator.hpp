@@ -0,0 +1,58 @@
+#pragma once
+
+#include "VulkanBase.hpp"
+#include "VulkanDevice.hpp"
+#include <RHI/RHITexture.hpp>
+
+struct VulkanAliasingAllocatorCreateInfo
+{
+    VulkanDevice* pDevice {nullptr};
+};
+
+/**
+ * Places transient images into shared memory slots.
+ * An image joins the first compatible slot whose occupants' lifetimes do not overlap its own, otherwise a new
+ * slot is allocated for it. A slot's memory is released together with its last occupant.
+ */
+class VulkanAliasingAllocator
+{
+public:
+    DISABLE_COPY_CTOR(VulkanAliasingAllocator);
+    explicit DEF_PRIMARY_CTOR(VulkanAliasingAllocator, const VulkanAliasingAllocatorCreateInfo& createInfo);
+
+    ~VulkanAliasingAllocator();
+
+    // Binds memory to the image, which must not have memory bound yet
+    void bind(vk::Image image, const RHITextureLifetime& lifetime);
+
+    void release(vk::Image image);
+
+    // Whether other images currently share memory with this one
+    bool isAliased(vk::Image image) const;
+
+    // Bytes that did not have to be allocated because images were placed into existing slots
+    vk::DeviceSize getAliasedBytes() const { return mAliasedBytes; }
+
+private:
+    struct Occupant
+    {
+        vk::Image          image;
+        vk::DeviceSize     size;
+        RHITextureLifetime lifetime;
+    };
+
+    struct Slot
+    {
+        VulkanAllocation*     allocation;
+        std::vector<Occupant> occupants;
+    };
+
+    bool isCompatible(const Slot& slot, const vk::MemoryRequirements& requirements, const RHITextureLifetime& lifetime) const;
+
+    std::vector<Slot>::iterator findSlot(vk::Image image);
+
+    std::vector<Slot> mSlots;
+    vk::DeviceSize    mAliasedBytes {0};
+
+    VulkanDevice*     mDevice;
+};
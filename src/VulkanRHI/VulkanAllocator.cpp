@@ -1,14 +1,326 @@
 #include "VulkanAllocator.hpp"
 
+#pragma region "Memory Block"
+
+VulkanMemoryBlock::VulkanMemoryBlock(const VulkanMemoryBlockCreateInfo& createInfo)
+: mSize(createInfo.size)
+, mMemoryTypeIndex(createInfo.memoryTypeIndex)
+, mDedicated(createInfo.dedicated)
+, mDevice(createInfo.device)
+{
+    constexpr auto allocateFlags = vk::MemoryAllocateFlagsInfo().setFlags(vk::MemoryAllocateFlagBits::eDeviceAddress);
+    const auto allocateInfo = vk::MemoryAllocateInfo()
+        .setAllocationSize(mSize)
+        .setMemoryTypeIndex(mMemoryTypeIndex)
+        .setPNext(&allocateFlags);
+
+    VK_CHECK(mMemory = mDevice.allocateMemory(allocateInfo););
+
+    insertFreeRange(0, mSize);
+
+    VK_VERBOSE(fmt::format("Allocated {}MemoryBlock of {} bytes (memory type: {})", mDedicated ? "dedicated " : "", mSize, mMemoryTypeIndex));
+}
+
+std::unique_ptr<VulkanMemoryBlock> VulkanMemoryBlock::createVulkanMemoryBlock(const VulkanMemoryBlockCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanMemoryBlock>(createInfo);
+}
+
+VulkanMemoryBlock::~VulkanMemoryBlock()
+{
+    if (mMapCount > 0)
+    {
+        mDevice.unmapMemory(mMemory);
+    }
+    mDevice.free(mMemory);
+}
+
+std::optional<vk::DeviceSize> VulkanMemoryBlock::allocate(const vk::DeviceSize size, const vk::DeviceSize alignment)
+{
+    // Best-fit: start at the smallest free range that could hold the request and skip the ones the alignment padding rules out
+    for (auto it = mFreeBySize.lower_bound(size); it != std::end(mFreeBySize); ++it)
+    {
+        const auto [rangeSize, rangeOffset] = *it;
+        const vk::DeviceSize alignedOffset = (rangeOffset + alignment - 1) / alignment * alignment;
+        const vk::DeviceSize padding = alignedOffset - rangeOffset;
+
+        if (padding + size > rangeSize)
+        {
+            continue;
+        }
+
+        eraseFreeRange(mFreeByOffset.find(rangeOffset));
+
+        if (padding > 0)
+        {
+            insertFreeRange(rangeOffset, padding);
+        }
+        if (const vk::DeviceSize remainder = rangeSize - padding - size; remainder > 0)
+        {
+            insertFreeRange(alignedOffset + size, remainder);
+        }
+
+        mUsedSize += size;
+        return alignedOffset;
+    }
+
+    return std::nullopt;
+}
+
+void VulkanMemoryBlock::release(vk::DeviceSize offset, vk::DeviceSize size)
+{
+    mUsedSize -= size;
+
+    // Coalesce with the neighbouring free ranges
+    if (const auto next = mFreeByOffset.find(offset + size); next != std::end(mFreeByOffset))
+    {
+        size += next->second;
+        eraseFreeRange(next);
+    }
+    if (auto prev = mFreeByOffset.lower_bound(offset); prev != std::begin(mFreeByOffset))
+    {
+        --prev;
+        if (prev->first + prev->second == offset)
+        {
+            offset = prev->first;
+            size += prev->second;
+            eraseFreeRange(prev);
+        }
+    }
+
+    insertFreeRange(offset, size);
+}
+
+void* VulkanMemoryBlock::map()
+{
+    if (mMapCount == 0)
+    {
+        VK_CHECK_DEBUG(mMapped = mDevice.mapMemory(mMemory, 0, VK_WHOLE_SIZE, {}););
+    }
+    mMapCount++;
+    return mMapped;
+}
+
+void VulkanMemoryBlock::unmap()
+{
+    if (mMapCount == 0)
+    {
+        return;
+    }
+
+    if (--mMapCount == 0)
+    {
+        mDevice.unmapMemory(mMemory);
+        mMapped = nullptr;
+    }
+}
+
+void VulkanMemoryBlock::insertFreeRange(const vk::DeviceSize offset, const vk::DeviceSize size)
+{
+    mFreeByOffset.emplace(offset, size);
+    mFreeBySize.emplace(size, offset);
+}
+
+void VulkanMemoryBlock::eraseFreeRange(const std::map<vk::DeviceSize, vk::DeviceSize>::iterator it)
+{
+    auto [first, last] = mFreeBySize.equal_range(it->second);
+    for (; first != last; ++first)
+    {
+        if (first->second == it->first)
+        {
+            mFreeBySize.erase(first);
+            break;
+        }
+    }
+    mFreeByOffset.erase(it);
+}
+
+#pragma endregion
+
+#pragma region "Memory Allocator"
+
+VulkanMemoryAllocator::VulkanMemoryAllocator(const VulkanMemoryAllocatorCreateInfo& createInfo)
+: mBlockSize(createInfo.blockSize)
+, mDevice(createInfo.device)
+{
+}
+
+std::unique_ptr<VulkanMemoryAllocator> VulkanMemoryAllocator::createVulkanMemoryAllocator(const VulkanMemoryAllocatorCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanMemoryAllocator>(createInfo);
+}
+
+VulkanMemoryRange VulkanMemoryAllocator::allocate(const VulkanMemoryRequest& request)
+{
+    const vk::DeviceSize size      = request.requirements.size;
+    const vk::DeviceSize alignment = request.requirements.alignment;
+    auto& pool = mPools[poolKey(request.memoryTypeIndex, request.linear)];
+
+    if (size > mBlockSize / 2)
+    {
+        if (!request.allowNewBlock)
+        {
+            return {};
+        }
+
+        pool.push_back(VulkanMemoryBlock::createVulkanMemoryBlock({
+            .device          = mDevice,
+            .size            = size,
+            .memoryTypeIndex = request.memoryTypeIndex,
+            .dedicated       = true,
+        }));
+
+        auto* block = pool.back().get();
+        return { block, block->allocate(size, alignment).value(), size };
+    }
+
+    for (const auto& block : pool)
+    {
+        if (block->isDedicated() or block.get() == request.excludedBlock)
+        {
+            continue;
+        }
+
+        if (const auto offset = block->allocate(size, alignment); offset.has_value())
+        {
+            return { block.get(), offset.value(), size };
+        }
+    }
+
+    if (!request.allowNewBlock)
+    {
+        return {};
+    }
+
+    pool.push_back(VulkanMemoryBlock::createVulkanMemoryBlock({
+        .device          = mDevice,
+        .size            = mBlockSize,
+        .memoryTypeIndex = request.memoryTypeIndex,
+    }));
+
+    auto* block = pool.back().get();
+    return { block, block->allocate(size, alignment).value(), size };
+}
+
+void VulkanMemoryAllocator::free(const VulkanMemoryRange& range)
+{
+    VulkanMemoryBlock* block = range.block;
+    block->release(range.offset, range.size);
+
+    if (!block->isEmpty())
+    {
+        return;
+    }
+
+    for (auto& pool : mPools | std::views::values)
+    {
+        const auto it = std::ranges::find_if(pool, [&](const auto& value) { return value.get() == block; });
+        if (it == std::end(pool))
+        {
+            continue;
+        }
+
+        // Keep a single empty shared block around per pool to avoid allocation churn
+        const bool hasOtherSharedBlock = std::ranges::any_of(pool, [&](const auto& value) {
+            return value.get() != block and !value->isDedicated();
+        });
+
+        if (block->isDedicated() or hasOtherSharedBlock)
+        {
+            pool.erase(it);
+        }
+        return;
+    }
+}
+
+uint32_t VulkanMemoryAllocator::getBlockCount() const
+{
+    uint32_t count = 0;
+    for (const auto& pool : mPools | std::views::values)
+    {
+        count += static_cast<uint32_t>(pool.size());
+    }
+    return count;
+}
+
+vk::DeviceSize VulkanMemoryAllocator::getBlockBytes(const uint32_t memoryTypeIndex) const
+{
+    vk::DeviceSize bytes = 0;
+    for (const bool linear : { false, true })
+    {
+        const auto it = mPools.find(poolKey(memoryTypeIndex, linear));
+        if (it == std::end(mPools))
+        {
+            continue;
+        }
+
+        for (const auto& block : it->second)
+        {
+            bytes += block->getSize();
+        }
+    }
+    return bytes;
+}
+
+std::vector<const VulkanMemoryBlock*> VulkanMemoryAllocator::getDefragmentationSources(const float maxUtilization) const
+{
+    std::vector<const VulkanMemoryBlock*> sources;
+    for (const auto& pool : mPools | std::views::values)
+    {
+        // Evacuating a block only pays off if another block in use can absorb its allocations
+        const VulkanMemoryBlock* sparsest = nullptr;
+        uint32_t usedBlockCount = 0;
+
+        for (const auto& block : pool)
+        {
+            if (block->isDedicated() or block->isEmpty())
+            {
+                continue;
+            }
+
+            usedBlockCount++;
+            if (sparsest == nullptr or block->getUsedSize() < sparsest->getUsedSize())
+            {
+                sparsest = block.get();
+            }
+        }
+
+        if (usedBlockCount < 2)
+        {
+            continue;
+        }
+
+        if (static_cast<float>(sparsest->getUsedSize()) / static_cast<float>(sparsest->getSize()) <= maxUtilization)
+        {
+            sources.push_back(sparsest);
+        }
+    }
+    return sources;
+}
+
+#pragma endregion
+
+#pragma region "Allocation"
+
 uint32_t VulkanAllocation::sSequence = 0;
 
 VulkanAllocation::VulkanAllocation(const VulkanAllocationCreateInfo& createInfo)
-: mMemory(createInfo.memory)
-, mSize(createInfo.size)
+: mMemory(createInfo.range.block->getMemory())
+, mOffset(createInfo.range.offset)
+, mSize(createInfo.range.size)
+, mBlock(createInfo.range.block)
+, mAllocator(createInfo.allocator)
+, mHeapIndex(createInfo.heapIndex)
+, mPropertyFlags(createInfo.propertyFlags)
+, mNonCoherentAtomSize(createInfo.nonCoherentAtomSize)
 , mUser(createInfo.target)
 , mDevice(createInfo.device)
 , mId(sSequence++)
 {
+    if (isHostVisible())
+    {
+        mMapped = static_cast<char*>(mBlock->map()) + mOffset;
+    }
 }
 
 std::unique_ptr<VulkanAllocation> VulkanAllocation::createVulkanAllocation(const VulkanAllocationCreateInfo& createInfo)
@@ -44,31 +356,58 @@ void VulkanAllocation::bind()
     mIsBound = true;
 }
 
-void* VulkanAllocation::map()
+void VulkanAllocation::free()
+{
+    if (!mInvalid)
+    {
+        if (mMapped != nullptr)
+        {
+            mBlock->unmap();
+            mMapped = nullptr;
+        }
+        mAllocator->free({ mBlock, mOffset, mSize });
+        mInvalid = true;
+    }
+}
+
+void VulkanAllocation::flush(const vk::DeviceSize offset, const vk::DeviceSize size) const
 {
-    void* mapped_memory = nullptr;
-    VK_CHECK_DEBUG(mapped_memory = mDevice.mapMemory(mMemory, mOffset, mSize, {}););
+    if (mMapped == nullptr or isHostCoherent())
+    {
+        return;
+    }
 
-    mIsMapped = true;
-    return mapped_memory;
+    const auto range = getMappedRange(offset, size);
+    VK_CHECK_DEBUG(mDevice.flushMappedMemoryRanges(range););
 }
 
-void VulkanAllocation::unmap()
+void VulkanAllocation::invalidate(const vk::DeviceSize offset, const vk::DeviceSize size) const
 {
-    if (mIsMapped)
+    if (mMapped == nullptr or isHostCoherent())
     {
-        mDevice.unmapMemory(mMemory);
-        mIsMapped = false;
+        return;
     }
+
+    const auto range = getMappedRange(offset, size);
+    VK_CHECK_DEBUG(mDevice.invalidateMappedMemoryRanges(range););
 }
 
-void VulkanAllocation::free()
+vk::MappedMemoryRange VulkanAllocation::getMappedRange(const vk::DeviceSize offset, vk::DeviceSize size) const
 {
-    if (!mInvalid)
+    if (size == VK_WHOLE_SIZE)
     {
-        mDevice.free(mMemory);
-        mInvalid = true;
+        size = mSize - offset;
     }
+
+    // Ranges have to be aligned to nonCoherentAtomSize, or end at the end of the memory object
+    const vk::DeviceSize atom  = mNonCoherentAtomSize;
+    const vk::DeviceSize begin = (mOffset + offset) / atom * atom;
+    const vk::DeviceSize end   = std::min((mOffset + offset + size + atom - 1) / atom * atom, mBlock->getSize());
+
+    return vk::MappedMemoryRange()
+        .setMemory(mMemory)
+        .setOffset(begin)
+        .setSize(end - begin);
 }
 
 std::optional<vk::DeviceAddress> VulkanAllocation::getAddress() const
@@ -82,3 +421,76 @@ std::optional<vk::DeviceAddress> VulkanAllocation::getAddress() const
 
     return mAddress;
 }
+
+#pragma endregion
+
+#pragma region "Allocation Registry"
+
+VulkanAllocationRegistry::VulkanAllocationRegistry(const uint32_t heapCount)
+: mHeapStatistics(heapCount)
+{
+}
+
+std::unique_ptr<VulkanAllocationRegistry> VulkanAllocationRegistry::createVulkanAllocationRegistry(const uint32_t heapCount)
+{
+    return std::make_unique<VulkanAllocationRegistry>(heapCount);
+}
+
+VulkanAllocation* VulkanAllocationRegistry::insert(std::unique_ptr<VulkanAllocation> allocation)
+{
+    uint32_t index;
+    if (!mFreeSlots.empty())
+    {
+        index = mFreeSlots.back();
+        mFreeSlots.pop_back();
+    }
+    else
+    {
+        index = static_cast<uint32_t>(mSlots.size());
+        mSlots.emplace_back();
+    }
+
+    auto& slot = mSlots[index];
+    allocation->mHandle = { index, slot.generation };
+
+    auto& heapStatistics = mHeapStatistics[allocation->getHeapIndex()];
+    heapStatistics.allocationCount++;
+    heapStatistics.allocatedBytes += allocation->getSize();
+    mLiveCount++;
+
+    slot.allocation = std::move(allocation);
+    return slot.allocation.get();
+}
+
+VulkanAllocation* VulkanAllocationRegistry::get(const VulkanAllocationHandle handle) const
+{
+    if (!handle.isValid() or handle.index >= mSlots.size())
+    {
+        return nullptr;
+    }
+
+    const auto& slot = mSlots[handle.index];
+    return (slot.generation == handle.generation) ? slot.allocation.get() : nullptr;
+}
+
+void VulkanAllocationRegistry::release(const VulkanAllocationHandle handle)
+{
+    const VulkanAllocation* allocation = get(handle);
+    if (allocation == nullptr)
+    {
+        VK_DEBUG(fmt::format("{}", styled("Tried to release an already released VulkanAllocation", fg(fmt::color::light_yellow))));
+        return;
+    }
+
+    auto& heapStatistics = mHeapStatistics[allocation->getHeapIndex()];
+    heapStatistics.allocationCount--;
+    heapStatistics.allocatedBytes -= allocation->getSize();
+    mLiveCount--;
+
+    auto& slot = mSlots[handle.index];
+    slot.allocation.reset();
+    slot.generation++;
+    mFreeSlots.push_back(handle.index);
+}
+
+#pragma endregion
@@ -2,11 +2,184 @@
 
 #include "VulkanBase.hpp"
 
+class VulkanAllocation;
+class VulkanMemoryAllocator;
+
+#pragma region "Memory Block"
+
+struct VulkanMemoryBlockCreateInfo
+{
+    vk::Device     device;
+    vk::DeviceSize size {};
+    uint32_t       memoryTypeIndex {};
+    bool           dedicated {false};
+};
+
+/**
+ * A single VkDeviceMemory object that is carved into aligned ranges.
+ * Free ranges are tracked both by offset (for coalescing) and by size (for best-fit lookup).
+ */
+class VulkanMemoryBlock
+{
+public:
+    DISABLE_COPY_CTOR(VulkanMemoryBlock);
+    explicit DEF_PRIMARY_CTOR(VulkanMemoryBlock, const VulkanMemoryBlockCreateInfo& createInfo);
+
+    ~VulkanMemoryBlock();
+
+    // Reserves a range of the requested size and alignment, returns the offset of the range on success
+    std::optional<vk::DeviceSize> allocate(vk::DeviceSize size, vk::DeviceSize alignment);
+
+    // Returns a previously reserved range to the block
+    void release(vk::DeviceSize offset, vk::DeviceSize size);
+
+    // Maps the whole block, mappings are reference counted as a VkDeviceMemory can only be mapped once
+    void* map();
+    void  unmap();
+
+    vk::DeviceMemory getMemory()          const { return mMemory; }
+    vk::DeviceSize   getSize()            const { return mSize; }
+    vk::DeviceSize   getUsedSize()        const { return mUsedSize; }
+    uint32_t         getMemoryTypeIndex() const { return mMemoryTypeIndex; }
+    bool             isDedicated()        const { return mDedicated; }
+    bool             isEmpty()            const { return mUsedSize == 0; }
+
+private:
+    void insertFreeRange(vk::DeviceSize offset, vk::DeviceSize size);
+    void eraseFreeRange(std::map<vk::DeviceSize, vk::DeviceSize>::iterator it);
+
+    vk::DeviceMemory                              mMemory;
+    const vk::DeviceSize                          mSize;
+    vk::DeviceSize                                mUsedSize {0};
+    const uint32_t                                mMemoryTypeIndex;
+    const bool                                    mDedicated;
+
+    void*                                         mMapped {nullptr};
+    uint32_t                                      mMapCount {0};
+
+    std::map<vk::DeviceSize, vk::DeviceSize>      mFreeByOffset;
+    std::multimap<vk::DeviceSize, vk::DeviceSize> mFreeBySize;
+
+    const vk::Device                              mDevice;
+};
+
+#pragma endregion
+
+#pragma region "Memory Allocator"
+
+struct VulkanMemoryAllocatorCreateInfo
+{
+    vk::Device     device;
+    vk::DeviceSize blockSize {64ull * 1024 * 1024};
+};
+
+struct VulkanMemoryRequest
+{
+    vk::MemoryRequirements requirements;
+    uint32_t               memoryTypeIndex {};
+    // Buffers and linear images are kept apart from optimal images to respect bufferImageGranularity
+    bool                   linear {true};
+
+    // Used when relocating, a request that cannot be placed in an existing block returns an empty range
+    const VulkanMemoryBlock* excludedBlock {nullptr};
+    bool                     allowNewBlock {true};
+};
+
+struct VulkanMemoryRange
+{
+    VulkanMemoryBlock* block {nullptr};
+    vk::DeviceSize     offset {};
+    vk::DeviceSize     size {};
+};
+
+/**
+ * Sub-allocates device memory from large per memory type blocks.
+ * Requests larger than half a block receive a dedicated block of their own.
+ */
+class VulkanMemoryAllocator
+{
+public:
+    DISABLE_COPY_CTOR(VulkanMemoryAllocator);
+    explicit DEF_PRIMARY_CTOR(VulkanMemoryAllocator, const VulkanMemoryAllocatorCreateInfo& createInfo);
+
+    ~VulkanMemoryAllocator() = default;
+
+    VulkanMemoryRange allocate(const VulkanMemoryRequest& request);
+
+    void              free(const VulkanMemoryRange& range);
+
+    uint32_t          getBlockCount() const;
+
+    // Bytes of device memory held in blocks of the given memory type
+    vk::DeviceSize    getBlockBytes(uint32_t memoryTypeIndex) const;
+
+    // The least utilized shared block of every pool that has more than one, if below the given utilization
+    std::vector<const VulkanMemoryBlock*> getDefragmentationSources(float maxUtilization) const;
+
+private:
+    static uint32_t poolKey(const uint32_t memoryTypeIndex, const bool linear)
+    {
+        return (memoryTypeIndex << 1) | (linear ? 1u : 0u);
+    }
+
+    std::map<uint32_t, std::vector<std::unique_ptr<VulkanMemoryBlock>>> mPools;
+
+    const vk::DeviceSize                                                mBlockSize;
+    const vk::Device                                                    mDevice;
+};
+
+#pragma endregion
+
+#pragma region "Allocation"
+
+struct VulkanAllocationHandle
+{
+    static constexpr uint32_t kInvalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index      {kInvalidIndex};
+    uint32_t generation {0};
+
+    bool isValid() const { return index != kInvalidIndex; }
+};
+
+// Handles of a resource that was moved to new memory, kept alive until the GPU no longer uses them
+struct VulkanRetiredResource
+{
+    std::variant<vk::Buffer, vk::Image> handle;
+    vk::ImageView                       imageView;
+    VulkanAllocation*                   allocation {nullptr};
+};
+
+/**
+ * Implemented by resources whose memory can be moved by the defragmenter, which resources opt into at creation.
+ * Relocation recreates the resource handles in new memory and records a copy of the contents,
+ * the previous handles are returned so they can be destroyed once every frame that used them has completed.
+ * Each relocation bumps the generation, so owners know to rebuild descriptors and cached addresses.
+ */
+class VulkanRelocatable
+{
+public:
+    virtual ~VulkanRelocatable() = default;
+
+    virtual bool isRelocatable() const = 0;
+
+    // Returns std::nullopt if no other block could hold the resource
+    virtual std::optional<VulkanRetiredResource> relocate(vk::CommandBuffer commandBuffer) = 0;
+
+    uint32_t getRelocationGeneration() const { return mRelocationGeneration; }
+
+protected:
+    uint32_t mRelocationGeneration {0};
+};
+
 struct VulkanAllocationCreateInfo
 {
     vk::Device                          device;
-    vk::DeviceMemory                    memory;
-    vk::DeviceSize                      size {};
+    VulkanMemoryAllocator*              allocator {nullptr};
+    VulkanMemoryRange                   range;
+    uint32_t                            heapIndex {};
+    vk::MemoryPropertyFlags             propertyFlags {};
+    vk::DeviceSize                      nonCoherentAtomSize {1};
     std::variant<vk::Buffer, vk::Image> target;
 };
 
@@ -19,30 +192,120 @@ public:
     ~VulkanAllocation();
 
     void  bind();
-    void* map();
-    void  unmap();
     void  free();
 
-    vk::DeviceMemory                 getMemory()  const { return mMemory; };
-    vk::DeviceSize                   getSize()    const { return mSize; }
-    vk::DeviceSize                   getOffset()  const { return mOffset; }
+    // Host-visible allocations are mapped once on creation and stay mapped until freed, nullptr otherwise
+    void* getMappedData() const { return mMapped; }
+
+    // Make host writes visible to the device, and device writes visible to the host. No-ops for coherent memory.
+    void  flush(vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE) const;
+    void  invalidate(vk::DeviceSize offset = 0, vk::DeviceSize size = VK_WHOLE_SIZE) const;
+
+    bool  isHostVisible()  const { return static_cast<bool>(mPropertyFlags & vk::MemoryPropertyFlagBits::eHostVisible); }
+    bool  isHostCoherent() const { return static_cast<bool>(mPropertyFlags & vk::MemoryPropertyFlagBits::eHostCoherent); }
+
+    vk::DeviceMemory                 getMemory()    const { return mMemory; };
+    vk::DeviceSize                   getSize()      const { return mSize; }
+    vk::DeviceSize                   getOffset()    const { return mOffset; }
+    uint32_t                         getHeapIndex() const { return mHeapIndex; }
+    VulkanAllocationHandle           getHandle()    const { return mHandle; }
+    const VulkanMemoryBlock*         getBlock()     const { return mBlock; }
+
+    // The resource bound to this allocation, set by resources that support relocation
+    VulkanRelocatable*               getOwner()     const { return mOwner; }
+    void                             setOwner(VulkanRelocatable* owner) { mOwner = owner; }
 
     // Contains a value if the allocation was created for a Buffer and memory has been bound to it
     std::optional<vk::DeviceAddress> getAddress() const;
 
 private:
+    vk::MappedMemoryRange getMappedRange(vk::DeviceSize offset, vk::DeviceSize size) const;
+
             bool                                mInvalid = false;
             bool                                mIsBound = false;
-            bool                                mIsMapped = false;
 
             vk::DeviceMemory                    mMemory;
             std::optional<vk::DeviceAddress>    mAddress {std::nullopt};
     const   vk::DeviceSize                      mOffset {0};
     const   vk::DeviceSize                      mSize;
 
+            VulkanMemoryBlock*                  mBlock;
+            VulkanMemoryAllocator*              mAllocator;
+    const   uint32_t                            mHeapIndex;
+            VulkanAllocationHandle              mHandle {};
+            VulkanRelocatable*                  mOwner {nullptr};
+
+    const   vk::MemoryPropertyFlags             mPropertyFlags;
+    const   vk::DeviceSize                      mNonCoherentAtomSize;
+            void*                               mMapped {nullptr};
+
     const   std::variant<vk::Buffer, vk::Image> mUser;
     const   vk::Device                          mDevice;
 
     const   uint32_t                            mId;
     static  uint32_t                            sSequence;
+
+    friend class VulkanAllocationRegistry;
+};
+
+#pragma endregion
+
+#pragma region "Allocation Registry"
+
+struct VulkanHeapStatistics
+{
+    uint32_t       allocationCount {0};
+    vk::DeviceSize allocatedBytes  {0};
+};
+
+/**
+ * Owns every live VulkanAllocation in generation-checked slots.
+ * Released slots are recycled, so bookkeeping stays bounded by the live resource set.
+ */
+class VulkanAllocationRegistry
+{
+public:
+    DISABLE_COPY_CTOR(VulkanAllocationRegistry);
+    explicit DEF_PRIMARY_CTOR(VulkanAllocationRegistry, uint32_t heapCount);
+
+    ~VulkanAllocationRegistry() = default;
+
+    // Takes ownership of the allocation and returns a non-owning pointer to it
+    VulkanAllocation* insert(std::unique_ptr<VulkanAllocation> allocation);
+
+    // Returns nullptr for handles that were already released
+    VulkanAllocation* get(VulkanAllocationHandle handle) const;
+
+    void              release(VulkanAllocationHandle handle);
+
+    template <class Fn>
+    void              forEach(Fn&& fn) const
+    {
+        for (const auto& slot : mSlots)
+        {
+            if (slot.allocation)
+            {
+                fn(slot.allocation.get());
+            }
+        }
+    }
+
+    uint32_t                                 getLiveCount()       const { return mLiveCount; }
+    uint32_t                                 getSlotCount()       const { return static_cast<uint32_t>(mSlots.size()); }
+    const std::vector<VulkanHeapStatistics>& getHeapStatistics()  const { return mHeapStatistics; }
+
+private:
+    struct Slot
+    {
+        std::unique_ptr<VulkanAllocation> allocation;
+        uint32_t                          generation {0};
+    };
+
+    std::vector<Slot>                 mSlots;
+    std::vector<uint32_t>             mFreeSlots;
+    uint32_t                          mLiveCount {0};
+
+    std::vector<VulkanHeapStatistics> mHeapStatistics;
 };
+
+#pragma endregion
@@ -112,6 +112,38 @@ inline std::vector<const char*> getSupportedExtensions(const std::vector<const c
     return {std::begin(supportedExtensions), std::end(supportedExtensions)};
 }
 
+/**
+ * Byte string identifying a state description, usable as an unordered_map key.
+ * Values are appended field by field so padding never takes part, strings are length prefixed.
+ */
+class VulkanStateKey
+{
+public:
+    template <class T> requires std::is_trivially_copyable_v<T>
+    VulkanStateKey& add(const T& value)
+    {
+        mKey.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        return *this;
+    }
+
+    VulkanStateKey& add(const std::string_view value)
+    {
+        add(value.size());
+        mKey.append(value);
+        return *this;
+    }
+
+    VulkanStateKey& add(const char* value)
+    {
+        return add(std::string_view(value ? value : ""));
+    }
+
+    const std::string& get() const { return mKey; }
+
+private:
+    std::string mKey;
+};
+
 #pragma endregion
 
 #pragma region "RHI to Vulkan Type Conversion"
@@ -131,6 +163,11 @@ inline vk::Rect2D toVulkan(const Rect2D rect2d)
     return { toVulkan(rect2d.offset), toVulkan(rect2d.size) };
 }
 
+inline vk::Viewport toVulkan(const Viewport& viewport)
+{
+    return { viewport.x, viewport.y, viewport.width, viewport.height, viewport.minDepth, viewport.maxDepth };
+}
+
 inline vk::Format toVulkan(const Format format)
 {
     switch (format)
@@ -201,6 +238,8 @@ inline vk::ShaderStageFlagBits toVulkan(const ShaderStage shaderStage)
             return vk::ShaderStageFlagBits::eVertex;
         case ShaderStage::Fragment:
             return vk::ShaderStageFlagBits::eFragment;
+        case ShaderStage::Compute:
+            return vk::ShaderStageFlagBits::eCompute;
     }
     throw std::exception();
 }
@@ -221,6 +260,56 @@ inline vk::CullModeFlagBits toVulkan(const CullMode cullMode)
     throw std::exception();
 }
 
+inline vk::PolygonMode toVulkan(const PolygonMode polygonMode)
+{
+    switch (polygonMode)
+    {
+        case PolygonMode::Fill:
+            return vk::PolygonMode::eFill;
+        case PolygonMode::Line:
+            return vk::PolygonMode::eLine;
+    }
+    throw std::exception();
+}
+
+inline vk::ColorComponentFlagBits toVulkan(const ColorComponent colorComponent)
+{
+    switch (colorComponent)
+    {
+        case ColorComponent::R:
+            return vk::ColorComponentFlagBits::eR;
+        case ColorComponent::G:
+            return vk::ColorComponentFlagBits::eG;
+        case ColorComponent::B:
+            return vk::ColorComponentFlagBits::eB;
+        case ColorComponent::A:
+            return vk::ColorComponentFlagBits::eA;
+    }
+    throw std::exception();
+}
+
+inline vk::BlendFactor toVulkan(const BlendFactor blendFactor)
+{
+    switch (blendFactor)
+    {
+        case BlendFactor::One:
+            return vk::BlendFactor::eOne;
+        case BlendFactor::Zero:
+            return vk::BlendFactor::eZero;
+    }
+    throw std::exception();
+}
+
+inline vk::BlendOp toVulkan(const BlendOp blendOp)
+{
+    switch (blendOp)
+    {
+        case BlendOp::Add:
+            return vk::BlendOp::eAdd;
+    }
+    throw std::exception();
+}
+
 #pragma endregion
 
 #pragma region "Vulkan to RHI Type Conversion"
@@ -3,6 +3,8 @@
 struct BufferTypeFlags
 {
     vk::MemoryPropertyFlags memoryFlags;
+    vk::MemoryPropertyFlags preferredMemoryFlags;
+    vk::MemoryPropertyFlags avoidedMemoryFlags;
     vk::BufferUsageFlags    usageFlags;
 
     static BufferTypeFlags forType(RHIBufferType bufferType);
@@ -12,6 +14,8 @@ BufferTypeFlags BufferTypeFlags::forType(const RHIBufferType bufferType)
 {
     BufferTypeFlags result = {
         .memoryFlags = {},
+        .preferredMemoryFlags = {},
+        .avoidedMemoryFlags = {},
         .usageFlags = vk::BufferUsageFlagBits::eShaderDeviceAddress | vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eTransferSrc,
     };
 
@@ -22,28 +26,42 @@ BufferTypeFlags BufferTypeFlags::forType(const RHIBufferType bufferType)
         using enum vk::MemoryPropertyFlagBits;
 
         case Index: {
-            result.usageFlags  |= eIndexBuffer | eStorageBuffer;
-            result.memoryFlags |= eDeviceLocal;
+            result.usageFlags         |= eIndexBuffer | eStorageBuffer;
+            result.memoryFlags        |= eDeviceLocal;
+            result.avoidedMemoryFlags |= eHostVisible;
+            break;
+        }
+        case Indirect: {
+            // Filled by compute shaders for GPU-driven rendering, or uploaded from the CPU
+            result.usageFlags         |= eIndirectBuffer | eStorageBuffer;
+            result.memoryFlags        |= eDeviceLocal;
+            result.avoidedMemoryFlags |= eHostVisible;
             break;
         }
         case Staging: {
-            result.usageFlags  |= eTransferSrc;
-            result.memoryFlags |= eHostVisible | eHostCoherent;
+            result.usageFlags           |= eTransferSrc;
+            result.memoryFlags          |= eHostVisible;
+            result.preferredMemoryFlags |= eHostCoherent;
+            result.avoidedMemoryFlags   |= eDeviceLocal;
             break;
         }
         case Storage: {
-            result.usageFlags  |= eStorageBuffer;
-            result.memoryFlags |= eHostVisible | eHostCoherent;
+            // Prefer device-local host-visible memory (ReBAR) when the heap has room for it
+            result.usageFlags           |= eStorageBuffer;
+            result.memoryFlags          |= eHostVisible;
+            result.preferredMemoryFlags |= eDeviceLocal | eHostCoherent;
             break;
         }
         case Uniform: {
-            result.usageFlags  |= eUniformBuffer;
-            result.memoryFlags |= eHostVisible | eHostCoherent;
+            result.usageFlags           |= eUniformBuffer;
+            result.memoryFlags          |= eHostVisible;
+            result.preferredMemoryFlags |= eDeviceLocal | eHostCoherent;
             break;
         }
         case Vertex: {
-            result.usageFlags  |= eVertexBuffer | eStorageBuffer;
-            result.memoryFlags |= eDeviceLocal;
+            result.usageFlags         |= eVertexBuffer | eStorageBuffer;
+            result.memoryFlags        |= eDeviceLocal;
+            result.avoidedMemoryFlags |= eHostVisible;
             break;
         }
         default:
@@ -56,26 +74,52 @@ VulkanBuffer::VulkanBuffer(const VulkanBufferCreateInfo& createInfo)
 : RHIBuffer()
 , mDevice(createInfo.pDevice)
 {
-    const auto [memoryFlags, usageFlags] = BufferTypeFlags::forType(createInfo.bufferType);
+    const auto typeFlags = BufferTypeFlags::forType(createInfo.bufferType);
+
+    // Explicit memory flags replace the type's requirements along with its preferences
+    mMemoryFlags          = createInfo.memoryFlags ? createInfo.memoryFlags : typeFlags.memoryFlags;
+    mPreferredMemoryFlags = createInfo.memoryFlags ? vk::MemoryPropertyFlags() : typeFlags.preferredMemoryFlags;
+    mAvoidedMemoryFlags   = createInfo.memoryFlags ? vk::MemoryPropertyFlags() : typeFlags.avoidedMemoryFlags;
+    mUsageFlags           = typeFlags.usageFlags | createInfo.additionalUsage;
+    mSize                 = createInfo.bufferSize;
+    mDebugName            = createInfo.debugName;
+    mRelocatable          = createInfo.relocatable;
+
+    // Concurrent sharing costs every access, so only buffers used by async compute and graphics alike opt into it
+    if (createInfo.sharedWithAsyncCompute and mDevice->hasDedicatedComputeQueue())
+    {
+        mQueueFamilies = {
+            mDevice->getGraphicsQueue()->getQueueFamilyIndex(),
+            mDevice->getComputeQueue()->getQueueFamilyIndex(),
+        };
+        if (mDevice->hasDedicatedTransferQueue())
+        {
+            mQueueFamilies.push_back(mDevice->getTransferQueue()->getQueueFamilyIndex());
+        }
+    }
+
     const auto bufferCreateInfo = vk::BufferCreateInfo()
-        .setSharingMode(vk::SharingMode::eExclusive)
-        .setSize(createInfo.bufferSize)
-        .setUsage(usageFlags);
+        .setSharingMode(mQueueFamilies.empty() ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent)
+        .setQueueFamilyIndices(mQueueFamilies)
+        .setSize(mSize)
+        .setUsage(mUsageFlags);
 
     VK_CHECK(mBuffer = mDevice->handle().createBuffer(bufferCreateInfo););
 
     const auto allocationInfo = VulkanAllocationInfo()
         .setTarget(mBuffer)
-        .setPropertyFlags(memoryFlags);
+        .setPropertyFlags(mMemoryFlags)
+        .setPreferredFlags(mPreferredMemoryFlags)
+        .setAvoidedFlags(mAvoidedMemoryFlags);
 
     mMemory  = mDevice->allocateMemory(allocationInfo);
     mMemory->bind();
+    mMemory->setOwner(this);
 
     mAddress = mMemory->getAddress().value();
-    mSize    = createInfo.bufferSize;
 
     mDevice->nameObject<vk::Buffer>({
-        .debugName  = createInfo.debugName.c_str(),
+        .debugName  = mDebugName.c_str(),
         .handle     = mBuffer,
     });
 
@@ -90,7 +134,20 @@ std::unique_ptr<VulkanBuffer> VulkanBuffer::createVulkanBuffer(const VulkanBuffe
 VulkanBuffer::~VulkanBuffer()
 {
     mDevice->handle().destroyBuffer(mBuffer);
-    mMemory->free();
+    mDevice->freeMemory(mMemory);
+}
+
+void VulkanBuffer::setData(const void* pData, const uint64_t dataSize, const uint64_t offset) const
+{
+    void* mappedMemory = mMemory->getMappedData();
+    if (mappedMemory == nullptr)
+    {
+        VK_PRINTLN(fmt::format("{}", styled("VulkanBuffer::setData() called on a Buffer that isn't host-visible, the call has no effect.", fg(fmt::color::light_yellow))));
+        return;
+    }
+
+    std::memcpy(static_cast<char*>(mappedMemory) + offset, pData, dataSize);
+    mMemory->flush(offset, dataSize);
 }
 
 void VulkanBuffer::uploadData(const RHIBufferUploadInfo& uploadInfo)
@@ -102,8 +159,61 @@ void VulkanBuffer::uploadData(const RHIBufferUploadInfo& uploadInfo)
     const auto bufferCopy = vk::BufferCopy()
         .setSize(uploadInfo.dataSize)
         .setSrcOffset(0)
-        .setDstOffset(0);
+        .setDstOffset(uploadInfo.dstOffset);
 
     auto* commandBuffer = uploadInfo.pCommandList->as<VulkanCommandList>();
     commandBuffer->handle().copyBuffer(stagingBuffer->mBuffer, mBuffer, 1, &bufferCopy);
 }
+
+std::optional<VulkanRetiredResource> VulkanBuffer::relocate(const vk::CommandBuffer commandBuffer)
+{
+    const auto bufferCreateInfo = vk::BufferCreateInfo()
+        .setSharingMode(mQueueFamilies.empty() ? vk::SharingMode::eExclusive : vk::SharingMode::eConcurrent)
+        .setQueueFamilyIndices(mQueueFamilies)
+        .setSize(mSize)
+        .setUsage(mUsageFlags);
+
+    vk::Buffer buffer;
+    VK_CHECK(buffer = mDevice->handle().createBuffer(bufferCreateInfo););
+
+    const auto allocationInfo = VulkanAllocationInfo()
+        .setTarget(buffer)
+        .setPropertyFlags(mMemoryFlags)
+        .setPreferredFlags(mPreferredMemoryFlags)
+        .setAvoidedFlags(mAvoidedMemoryFlags)
+        .setRelocationSource(mMemory->getBlock());
+
+    VulkanAllocation* memory = mDevice->allocateMemory(allocationInfo);
+    if (memory == nullptr)
+    {
+        mDevice->handle().destroyBuffer(buffer);
+        return std::nullopt;
+    }
+    memory->bind();
+
+    const auto bufferCopy = vk::BufferCopy()
+        .setSize(mSize)
+        .setSrcOffset(0)
+        .setDstOffset(0);
+    commandBuffer.copyBuffer(mBuffer, buffer, 1, &bufferCopy);
+
+    const VulkanRetiredResource retired = {
+        .handle     = mBuffer,
+        .allocation = mMemory,
+    };
+
+    mMemory->setOwner(nullptr);
+    memory->setOwner(this);
+
+    mBuffer  = buffer;
+    mMemory  = memory;
+    mAddress = mMemory->getAddress().value();
+    mRelocationGeneration++;
+
+    mDevice->nameObject<vk::Buffer>({
+        .debugName  = mDebugName.c_str(),
+        .handle     = mBuffer,
+    });
+
+    return retired;
+}
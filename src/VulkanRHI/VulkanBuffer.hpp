@@ -11,9 +11,19 @@ struct VulkanBufferCreateInfo
     RHIBufferType       bufferType;
     VulkanDevice*       pDevice;
     std::string         debugName;
+
+    // Backend-internal buffers may widen the usage implied by bufferType, or replace its memory flags
+    vk::BufferUsageFlags    additionalUsage {};
+    vk::MemoryPropertyFlags memoryFlags     {};
+
+    // Opts into defragmentation, the owner must rebuild what it derived from the handle or address on a new generation
+    bool                    relocatable     {false};
+
+    // Concurrent sharing between the graphics, compute and transfer families instead of exclusive ownership
+    bool                    sharedWithAsyncCompute {false};
 };
 
-class VulkanBuffer : public RHIBuffer
+class VulkanBuffer : public RHIBuffer, public VulkanRelocatable
 {
 public:
     DISABLE_COPY_CTOR(VulkanBuffer);
@@ -21,11 +31,18 @@ public:
 
     ~VulkanBuffer() override;
 
-    void setData(const void* pData, const uint64_t dataSize) const override
+    void setData(const void* pData, uint64_t dataSize, uint64_t offset = 0) const override;
+
+    void* getMappedData() const override { return mMemory->getMappedData(); }
+
+    void flush(const uint64_t offset = 0, const uint64_t size = WholeSize) const override
+    {
+        mMemory->flush(offset, toVulkanSize(size));
+    }
+
+    void invalidate(const uint64_t offset = 0, const uint64_t size = WholeSize) const override
     {
-        void* mappedMemory = mMemory->map();
-        std::memcpy(mappedMemory, pData, dataSize);
-        mMemory->unmap();
+        mMemory->invalidate(offset, toVulkanSize(size));
     }
 
     void uploadData(const RHIBufferUploadInfo& uploadInfo) override;
@@ -33,14 +50,36 @@ public:
     vk::DeviceAddress getAddress() const { return mAddress; }
     vk::Buffer        handle()     const { return mBuffer; }
 
+    // Concurrent buffers are shared by the graphics, compute and transfer families without ownership transfers
+    bool              isConcurrent() const { return !mQueueFamilies.empty(); }
+
     uint64_t          getSize()    override { return mSize; }
     uint64_t          getOffset()  override { return mMemory->getOffset(); }
 
+    uint32_t          getGeneration() const override { return getRelocationGeneration(); }
+
+    // Host-visible buffers are never moved, as their mapped pointer is handed out to callers.
+    // A relocated buffer has a new handle and device address.
+    bool isRelocatable() const override { return mRelocatable and !mMemory->isHostVisible(); }
+
+    std::optional<VulkanRetiredResource> relocate(vk::CommandBuffer commandBuffer) override;
+
 private:
+    static vk::DeviceSize toVulkanSize(const uint64_t size) { return size == WholeSize ? VK_WHOLE_SIZE : size; }
+
     vk::Buffer          mBuffer;
     vk::DeviceSize      mSize;
     vk::DeviceAddress   mAddress {};
 
+    vk::BufferUsageFlags    mUsageFlags;
+    // Queue families sharing the buffer concurrently, empty for exclusive ownership by the graphics family
+    std::vector<uint32_t>   mQueueFamilies;
+    vk::MemoryPropertyFlags mMemoryFlags;
+    vk::MemoryPropertyFlags mPreferredMemoryFlags;
+    vk::MemoryPropertyFlags mAvoidedMemoryFlags;
+    std::string             mDebugName;
+    bool                    mRelocatable;
+
     VulkanAllocation*   mMemory;
     VulkanDevice*       mDevice;
 };
@@ -1,28 +1,282 @@
 #include "VulkanCommandQueue.hpp"
 
 #include "RHI/RHIBuffer.hpp"
+#include "RHI/RHICommandStream.hpp"
 #include "VulkanBuffer.hpp"
+#include "VulkanFence.hpp"
+#include "VulkanPipeline.hpp"
 
 #pragma region "Specific command implementations"
 
+VulkanCommandList* VulkanCommandList::fromRHI(RHICommandList* commandList, const char* caller)
+{
+    auto* vulkanCommandList = commandList->as<VulkanCommandList>();
+    if (vulkanCommandList == nullptr)
+    {
+        throw std::runtime_error(fmt::format("{} requires a VulkanCommandList, deferred streams only record commands of the RHICommandList interface", caller));
+    }
+    return vulkanCommandList;
+}
+
 void VulkanCommandList::copyBuffer(RHIBuffer* src, RHIBuffer* dst)
 {
     fmt::println("VulkanCommandList::copyBuffer() not implemented");
 }
 
-void VulkanCommandList::bindVertexBuffer(RHIBuffer* buffer)
+void VulkanCommandList::bindVertexBuffer(RHIBuffer* buffer, const uint64_t offset)
+{
+    bindVertexBuffer(buffer->as<VulkanBuffer>()->handle(), offset);
+}
+
+void VulkanCommandList::bindIndexBuffer(RHIBuffer* buffer, const uint64_t offset)
+{
+    bindIndexBuffer(buffer->as<VulkanBuffer>()->handle(), offset);
+}
+
+void VulkanCommandList::bindPipeline(RHIPipeline* pipeline)
+{
+    pipeline->bind(this);
+}
+
+void VulkanCommandList::drawIndirect(RHIBuffer* buffer, const uint64_t offset, const uint32_t drawCount, const uint32_t stride)
+{
+    mCommandList.drawIndirect(buffer->as<VulkanBuffer>()->handle(), offset, drawCount, stride);
+}
+
+void VulkanCommandList::drawIndexedIndirect(RHIBuffer* buffer, const uint64_t offset, const uint32_t drawCount, const uint32_t stride)
+{
+    mCommandList.drawIndexedIndirect(buffer->as<VulkanBuffer>()->handle(), offset, drawCount, stride);
+}
+
+void VulkanCommandList::drawIndexedIndirectCount(RHIBuffer* buffer, const uint64_t offset, RHIBuffer* countBuffer, const uint64_t countOffset,
+                                                 const uint32_t maxDrawCount, const uint32_t stride)
+{
+    mCommandList.drawIndexedIndirectCount(buffer->as<VulkanBuffer>()->handle(), offset,
+                                          countBuffer->as<VulkanBuffer>()->handle(), countOffset, maxDrawCount, stride);
+}
+
+void VulkanCommandList::dispatch(const uint32_t groupCountX, const uint32_t groupCountY, const uint32_t groupCountZ)
 {
-    static constexpr vk::DeviceSize offsets[1] = { 0 };
-    auto* vkBuffer = buffer->as<VulkanBuffer>();
-    auto handle = vkBuffer->handle();
-    mCommandList.bindVertexBuffers(0, 1, &handle, offsets);
+    mCommandList.dispatch(groupCountX, groupCountY, groupCountZ);
+}
+
+void VulkanCommandList::dispatchIndirect(RHIBuffer* buffer, const uint64_t offset)
+{
+    mCommandList.dispatchIndirect(buffer->as<VulkanBuffer>()->handle(), offset);
+}
+
+void VulkanCommandList::pushConstants(const ShaderStage stage, const uint32_t offset, const uint32_t size, const void* pData)
+{
+    if (!mPipeline)
+    {
+        throw std::runtime_error("Can't push constants without a bound pipeline");
+    }
+    if (size == 0)
+    {
+        return;
+    }
+
+    // Every byte has to be pushed with exactly the stages of the ranges containing it, so the update is split
+    // wherever a range begins or ends. Ranges of different stages may partially overlap, e.g. after reflection.
+    const auto& ranges = mPipeline->getPushConstantRanges();
+
+    std::vector<uint32_t> boundaries = { offset, offset + size };
+    for (const auto& range : ranges)
+    {
+        for (const uint32_t boundary : { range.offset, range.offset + range.size })
+        {
+            if (offset < boundary and boundary < offset + size)
+            {
+                boundaries.push_back(boundary);
+            }
+        }
+    }
+    std::ranges::sort(boundaries);
+    boundaries.erase(std::ranges::unique(boundaries).begin(), std::end(boundaries));
+
+    const auto getStageFlags = [&](const uint32_t begin, const uint32_t end) {
+        vk::ShaderStageFlags stageFlags;
+        for (const auto& range : ranges)
+        {
+            if (range.offset <= begin and end <= range.offset + range.size)
+            {
+                stageFlags |= range.stageFlags;
+            }
+        }
+        // Bytes outside every range are pushed for the given stage, so the validation layers report the misuse
+        return stageFlags ? stageFlags : vk::ShaderStageFlags(toVulkan(stage));
+    };
+
+    // Neighbouring sub-ranges with the same stages are pushed together
+    uint32_t begin = boundaries[0];
+    vk::ShaderStageFlags stageFlags = getStageFlags(boundaries[0], boundaries[1]);
+    for (size_t i = 1; i < boundaries.size(); i++)
+    {
+        const uint32_t end = boundaries[i];
+        const bool last = (i + 1 == boundaries.size());
+        const vk::ShaderStageFlags nextStageFlags = last ? vk::ShaderStageFlags() : getStageFlags(end, boundaries[i + 1]);
+
+        if (last or nextStageFlags != stageFlags)
+        {
+            mCommandList.pushConstants(mPipeline->layout(), stageFlags, begin, end - begin, static_cast<const std::byte*>(pData) + (begin - offset));
+            begin      = end;
+            stageFlags = nextStageFlags;
+        }
+    }
 }
 
-void VulkanCommandList::bindIndexBuffer(RHIBuffer* buffer)
+void VulkanCommandList::executeStream(const RHICommandStream& stream)
 {
-    auto* vkBuffer = buffer->as<VulkanBuffer>();
-    auto handle = vkBuffer->handle();
-    mCommandList.bindIndexBuffer(handle, 0, vk::IndexType::eUint32);
+    // Streams only ever reference Vulkan resources here, so packets translate without virtual calls or checked casts.
+    // Pipelines are the exception, their bind() resolves shared and asynchronously compiled pipelines.
+    stream.visit(RHICommandVisitor {
+        [this](const RHIDrawCommand& command) {
+            mCommandList.draw(command.vertexCount, command.instanceCount, command.firstVertex, command.firstInstance);
+        },
+        [this](const RHIDrawIndexedCommand& command) {
+            mCommandList.drawIndexed(command.indexCount, command.instanceCount, command.firstIndex, command.vertexOffset, command.firstInstance);
+        },
+        [this](const RHIBindVertexBufferCommand& command) {
+            bindVertexBuffer(static_cast<const VulkanBuffer*>(command.pBuffer)->handle(), command.offset);
+        },
+        [this](const RHIBindIndexBufferCommand& command) {
+            bindIndexBuffer(static_cast<const VulkanBuffer*>(command.pBuffer)->handle(), command.offset);
+        },
+        [this](const RHIDrawIndirectCommand& command) {
+            mCommandList.drawIndirect(static_cast<const VulkanBuffer*>(command.pBuffer)->handle(), command.offset, command.drawCount, command.stride);
+        },
+        [this](const RHIDrawIndexedIndirectCommand& command) {
+            mCommandList.drawIndexedIndirect(static_cast<const VulkanBuffer*>(command.pBuffer)->handle(), command.offset, command.drawCount, command.stride);
+        },
+        [this](const RHIDrawIndexedIndirectCountCommand& command) {
+            mCommandList.drawIndexedIndirectCount(static_cast<const VulkanBuffer*>(command.pBuffer)->handle(), command.offset,
+                                                  static_cast<const VulkanBuffer*>(command.pCountBuffer)->handle(), command.countOffset,
+                                                  command.maxDrawCount, command.stride);
+        },
+        [this](const RHIDispatchCommand& command) {
+            mCommandList.dispatch(command.groupCountX, command.groupCountY, command.groupCountZ);
+        },
+        [this](const RHIDispatchIndirectCommand& command) {
+            mCommandList.dispatchIndirect(static_cast<const VulkanBuffer*>(command.pBuffer)->handle(), command.offset);
+        },
+        [this](const RHIPushConstantsCommand& command) {
+            pushConstants(command.stage, command.offset, command.size, command.getData());
+        },
+        [this](const RHICopyBufferCommand& command) {
+            copyBuffer(command.pSrc, command.pDst);
+        },
+        [this](const RHIBindPipelineCommand& command) {
+            command.pPipeline->bind(this);
+        },
+        [this](const RHISetViewportCommand& command) {
+            setViewport(toVulkan(command.viewport));
+        },
+        [this](const RHISetScissorCommand& command) {
+            setScissor(toVulkan(command.scissor));
+        },
+    });
+
+    mStatistics.streamCommands += stream.getCommandCount();
+}
+
+#pragma endregion
+
+#pragma region "State filtering"
+
+namespace
+{
+    uint32_t toBindPointIndex(const vk::PipelineBindPoint bindPoint)
+    {
+        return (bindPoint == vk::PipelineBindPoint::eCompute) ? 1 : 0;
+    }
+}
+
+template <class T>
+bool VulkanCommandList::updateState(T& shadowed, const T& value)
+{
+    if (shadowed == value)
+    {
+        mStatistics.elidedStateCommands++;
+        return false;
+    }
+
+    shadowed = value;
+    mStatistics.issuedStateCommands++;
+    return true;
+}
+
+void VulkanCommandList::bindPipeline(const VulkanPipeline* pipeline)
+{
+    mPipeline = pipeline;
+    bindPipeline(pipeline->bindPoint(), pipeline->handle());
+}
+
+void VulkanCommandList::bindPipeline(const vk::PipelineBindPoint bindPoint, const vk::Pipeline pipeline)
+{
+    if (updateState(mBoundState.bindPoints[toBindPointIndex(bindPoint)].pipeline, pipeline))
+    {
+        mCommandList.bindPipeline(bindPoint, pipeline);
+    }
+}
+
+void VulkanCommandList::bindDescriptorSets(const vk::PipelineBindPoint bindPoint, const vk::PipelineLayout layout, const uint32_t firstSet,
+                                           const std::span<const vk::DescriptorSet> descriptorSets)
+{
+    auto& state = mBoundState.bindPoints[toBindPointIndex(bindPoint)];
+    const bool tracked = firstSet + descriptorSets.size() <= sMaxDescriptorSets;
+
+    if (tracked and state.layout == layout
+        and std::ranges::equal(descriptorSets, std::span(state.descriptorSets).subspan(firstSet, descriptorSets.size())))
+    {
+        mStatistics.elidedStateCommands++;
+        return;
+    }
+
+    // Sets bound with another layout may have been disturbed, only the sets bound now are known
+    if (state.layout != layout)
+    {
+        state.layout         = layout;
+        state.descriptorSets = {};
+    }
+    if (tracked)
+    {
+        std::ranges::copy(descriptorSets, std::begin(state.descriptorSets) + firstSet);
+    }
+
+    mStatistics.issuedStateCommands++;
+    mCommandList.bindDescriptorSets(bindPoint, layout, firstSet, static_cast<uint32_t>(descriptorSets.size()), descriptorSets.data(), 0, nullptr);
+}
+
+void VulkanCommandList::setViewport(const vk::Viewport& viewport)
+{
+    if (updateState(mBoundState.viewport, std::optional(viewport)))
+    {
+        mCommandList.setViewport(0, 1, &viewport);
+    }
+}
+
+void VulkanCommandList::setScissor(const vk::Rect2D& scissor)
+{
+    if (updateState(mBoundState.scissor, std::optional(scissor)))
+    {
+        mCommandList.setScissor(0, 1, &scissor);
+    }
+}
+
+void VulkanCommandList::bindVertexBuffer(const vk::Buffer buffer, const vk::DeviceSize offset)
+{
+    if (updateState(mBoundState.vertexBinding, std::pair(buffer, offset)))
+    {
+        mCommandList.bindVertexBuffers(0, 1, &buffer, &offset);
+    }
+}
+
+void VulkanCommandList::bindIndexBuffer(const vk::Buffer buffer, const vk::DeviceSize offset)
+{
+    if (updateState(mBoundState.indexBinding, std::pair(buffer, offset)))
+    {
+        mCommandList.bindIndexBuffer(buffer, offset, vk::IndexType::eUint32);
+    }
 }
 
 #pragma endregion
@@ -50,31 +304,24 @@ vk::CommandBuffer VulkanCommandList::getUnderlyingCommandBuffer() const
 #pragma region "CommandQueue"
 
 VulkanCommandQueue::VulkanCommandQueue(const VulkanCommandQueueCreateInfo& createInfo)
-: mDevice(createInfo.device)
+: mQueueFamilyIndex(createInfo.queueFamilyIndex)
+, mType(createInfo.type)
+, mFramesInFlight(createInfo.framesInFlight)
+, mDevice(createInfo.device)
 {
     VK_CHECK(mQueue = mDevice.getQueue(createInfo.queueFamilyIndex, 0););
 
-    const auto poolCreateInfo = vk::CommandPoolCreateInfo()
-        .setQueueFamilyIndex(createInfo.queueFamilyIndex)
-        .setFlags(vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+    auto semaphoreTypeCreateInfo = vk::SemaphoreTypeCreateInfo()
+        .setSemaphoreType(vk::SemaphoreType::eTimeline)
+        .setInitialValue(0);
 
-    VK_CHECK(mCommandPool = mDevice.createCommandPool(poolCreateInfo););
+    const auto semaphoreCreateInfo = vk::SemaphoreCreateInfo()
+        .setPNext(&semaphoreTypeCreateInfo);
 
-    const auto bufferAllocateInfo = vk::CommandBufferAllocateInfo()
-        .setCommandBufferCount(createInfo.commandBufferCount)
-        .setCommandPool(mCommandPool)
-        .setLevel(vk::CommandBufferLevel::ePrimary);
+    VK_CHECK(mSingleTimeTimeline = mDevice.createSemaphore(semaphoreCreateInfo););
+    VK_CHECK(mSubmitTimeline = mDevice.createSemaphore(semaphoreCreateInfo););
 
-    uint32_t id = 0;
-    for (const std::vector<vk::CommandBuffer> commandBuffers = mDevice.allocateCommandBuffers(bufferAllocateInfo);
-         const auto& commandBuffer : commandBuffers)
-    {
-        mCommandLists.push_back(VulkanCommandList::createVulkanCommandList({
-            .commandBuffer = commandBuffer,
-            .id            = id,
-        }));
-        id++;
-    }
+    mFrameSubmitValues.resize(mFramesInFlight, 0);
 }
 
 std::unique_ptr<VulkanCommandQueue> VulkanCommandQueue::createVulkanCommandQueue(const VulkanCommandQueueCreateInfo& createInfo)
@@ -84,61 +331,375 @@ std::unique_ptr<VulkanCommandQueue> VulkanCommandQueue::createVulkanCommandQueue
 
 VulkanCommandQueue::~VulkanCommandQueue()
 {
-    std::vector<vk::CommandBuffer> commandBuffers;
-    for (const auto& commandList : mCommandLists)
+    // Lists submitted through submit() may still be executing
+    const auto waitInfo = vk::SemaphoreWaitInfo()
+        .setSemaphores(mSubmitTimeline)
+        .setValues(mSubmitValue);
+    static_cast<void>(mDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max()));
+
+    // Destroying a pool frees the command buffers allocated from it
+    for (const auto& threadPools : mThreadPools | std::views::values)
+    {
+        for (const auto& framePool : threadPools.framePools)
+        {
+            mDevice.destroyCommandPool(framePool.commandPool);
+        }
+    }
+    mThreadPools.clear();
+
+    // Recorded but unsubmitted command buffers are freed with their pools
+    wait({ mLastSubmittedValue });
+    for (const auto commandPool : mSingleTimeCommandPools)
+    {
+        mDevice.destroyCommandPool(commandPool);
+    }
+    mDevice.destroySemaphore(mSingleTimeTimeline);
+    mDevice.destroySemaphore(mSubmitTimeline);
+}
+
+RHICommandList* VulkanCommandQueue::acquireCommandList()
+{
+    auto& framePool = getThreadPools()[mCurrentFrame];
+
+    if (framePool.acquiredCount == framePool.commandLists.size())
+    {
+        const auto bufferAllocateInfo = vk::CommandBufferAllocateInfo()
+            .setCommandBufferCount(1)
+            .setCommandPool(framePool.commandPool)
+            .setLevel(vk::CommandBufferLevel::ePrimary);
+
+        std::vector<vk::CommandBuffer> commandBuffers;
+        VK_CHECK(commandBuffers = mDevice.allocateCommandBuffers(bufferAllocateInfo););
+
+        framePool.commandLists.push_back(VulkanCommandList::createVulkanCommandList({
+            .commandBuffer = commandBuffers[0],
+            .id            = mNextListId++,
+        }));
+    }
+
+    auto* commandList = framePool.commandLists[framePool.acquiredCount++].get();
+    commandList->mReleased = false;
+    return commandList;
+}
+
+void VulkanCommandQueue::releaseCommandList(RHICommandList* commandList)
+{
+    auto* vulkanCommandList = commandList->as<VulkanCommandList>();
+    if (vulkanCommandList->mReleased)
+    {
+        VK_DEBUG(fmt::format("{}", styled(fmt::format("CommandList #{} was released twice", vulkanCommandList->mId), fg(fmt::color::light_yellow))));
+    }
+    vulkanCommandList->mReleased = true;
+}
+
+void VulkanCommandQueue::submit(const RHISubmitInfo& submitInfo)
+{
+    std::vector<vk::CommandBufferSubmitInfo> commandBufferSubmitInfos;
+    for (auto* commandList : submitInfo.commandLists)
+    {
+        commandBufferSubmitInfos.push_back(vk::CommandBufferSubmitInfo().setCommandBuffer(commandList->as<VulkanCommandList>()->handle()));
+    }
+
+    std::vector<vk::SemaphoreSubmitInfo> waitSemaphoreInfos;
+    for (const auto& [fence, value] : submitInfo.waitFences)
+    {
+        waitSemaphoreInfos.push_back(fence->as<VulkanFence>()->getSubmitInfo(value));
+    }
+
+    std::vector<vk::SemaphoreSubmitInfo> signalSemaphoreInfos;
+    for (const auto& [fence, value] : submitInfo.signalFences)
+    {
+        signalSemaphoreInfos.push_back(fence->as<VulkanFence>()->getSubmitInfo(value));
+    }
+
+    // Timeline signals must strictly increase in submission order, picking the value and submitting happen under one lock
+    std::lock_guard lock(mQueueMutex);
+
+    // Lets beginFrame know when the command lists of this frame slot may be reset
+    signalSemaphoreInfos.push_back(vk::SemaphoreSubmitInfo()
+        .setSemaphore(mSubmitTimeline)
+        .setValue(mSubmitValue + 1)
+        .setStageMask(vk::PipelineStageFlagBits2::eAllCommands));
+
+    const auto vkSubmitInfo = vk::SubmitInfo2()
+        .setCommandBufferInfos(commandBufferSubmitInfos)
+        .setWaitSemaphoreInfos(waitSemaphoreInfos)
+        .setSignalSemaphoreInfos(signalSemaphoreInfos);
+
+    if (const auto result = mQueue.submit2(1, &vkSubmitInfo, nullptr);
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to submit CommandLists");
+    }
+
+    mFrameSubmitValues[mCurrentFrame] = ++mSubmitValue;
+}
+
+vk::Result VulkanCommandQueue::submit2(const vk::SubmitInfo2& submitInfo)
+{
+    std::lock_guard lock(mQueueMutex);
+    return mQueue.submit2(1, &submitInfo, nullptr);
+}
+
+vk::Result VulkanCommandQueue::present(const vk::PresentInfoKHR& presentInfo)
+{
+    std::lock_guard lock(mQueueMutex);
+    return mQueue.presentKHR(&presentInfo);
+}
+
+void VulkanCommandQueue::beginFrame(const uint32_t frameIndex)
+{
+    std::lock_guard lock(mThreadPoolsMutex);
+
+    uint64_t frameSubmitValue;
     {
-        commandBuffers.push_back(commandList->getUnderlyingCommandBuffer());
+        std::lock_guard queueLock(mQueueMutex);
+        mCurrentFrame = frameIndex;
+        frameSubmitValue = mFrameSubmitValues[frameIndex];
     }
 
-    mDevice.freeCommandBuffers(mCommandPool, commandBuffers);
-    mCommandLists.clear();
+    // Usually long complete, the slot was last used frames in flight ago
+    const auto waitInfo = vk::SemaphoreWaitInfo()
+        .setSemaphores(mSubmitTimeline)
+        .setValues(frameSubmitValue);
+
+    if (const auto result = mDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to wait for the frame's submissions");
+    }
+
+    mFrameCount++;
+
+    for (auto it = std::begin(mThreadPools); it != std::end(mThreadPools);)
+    {
+        auto& threadPools = it->second;
+
+        // Every slot the thread recorded into has been waited on since, so none of its lists can still be pending
+        if (mFrameCount - threadPools.lastAcquireFrame > mFramesInFlight)
+        {
+            for (const auto& pool : threadPools.framePools)
+            {
+                mDevice.destroyCommandPool(pool.commandPool);
+            }
+            it = mThreadPools.erase(it);
+            continue;
+        }
 
-    mDevice.destroyCommandPool(mCommandPool);
+        auto& framePool = threadPools.framePools[frameIndex];
+        ++it;
+        if (framePool.acquiredCount == 0)
+        {
+            continue;
+        }
+
+        #ifdef VULKAN_DEBUGGING_ENABLED
+        for (uint32_t i = 0; i < framePool.acquiredCount; i++)
+        {
+            if (!framePool.commandLists[i]->mReleased)
+            {
+                VK_DEBUG(fmt::format("{}", styled(fmt::format("CommandList #{} was never released", framePool.commandLists[i]->mId), fg(fmt::color::light_yellow))));
+            }
+        }
+        #endif
+
+        mDevice.resetCommandPool(framePool.commandPool);
+        framePool.acquiredCount = 0;
+    }
 }
 
-RHICommandList* VulkanCommandQueue::getCommandList(uint32_t id)
+std::vector<VulkanCommandQueue::FrameCommandPool>& VulkanCommandQueue::getThreadPools()
 {
-    if (id >= mCommandLists.size())
+    std::lock_guard lock(mThreadPoolsMutex);
+
+    // References into an unordered_map stay valid when other threads insert their pools
+    auto [it, inserted] = mThreadPools.try_emplace(std::this_thread::get_id());
+    if (inserted)
     {
-        throw std::out_of_range(fmt::format("Index {} out of range for container of size {}",id, mCommandLists.size()));
+        const auto poolCreateInfo = vk::CommandPoolCreateInfo()
+            .setQueueFamilyIndex(mQueueFamilyIndex)
+            .setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+
+        it->second.framePools.resize(mFramesInFlight);
+        for (auto& framePool : it->second.framePools)
+        {
+            VK_CHECK(framePool.commandPool = mDevice.createCommandPool(poolCreateInfo););
+        }
     }
+    it->second.lastAcquireFrame = mFrameCount;
 
-    return mCommandLists[id].get();
+    return it->second.framePools;
 }
 
 void VulkanCommandQueue::executeSingleTimeCommand(const std::function<void(RHICommandList*)>& lambda)
 {
-    const auto singleTimeBufferAllocateInfo = vk::CommandBufferAllocateInfo()
-        .setCommandBufferCount(1)
-        .setCommandPool(mCommandPool)
-        .setLevel(vk::CommandBufferLevel::ePrimary);
+    // Waits for this submission only, instead of draining the queue
+    wait(executeSingleTimeCommandAsync(lambda));
+}
 
-    const std::vector<vk::CommandBuffer> commandBuffers = mDevice.allocateCommandBuffers(singleTimeBufferAllocateInfo);
-    mSingleTimeCommandList = VulkanCommandList::createVulkanCommandList({
-        .commandBuffer = commandBuffers[0],
-        .id            = 123123,
-    });
+RHICommandTicket VulkanCommandQueue::executeSingleTimeCommandAsync(const std::function<void(RHICommandList*)>& lambda)
+{
+    const SingleTimeCommandBuffer singleTimeCommandBuffer = acquireSingleTimeCommandBuffer();
+    const vk::CommandBuffer commandBuffer = singleTimeCommandBuffer.commandBuffer;
 
+    // Recorded without the lock held, the lambda may issue single-time commands on this queue itself.
+    // Beginning implicitly resets a recycled command buffer.
     constexpr auto beginInfo = vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
-    commandBuffers[0].begin(beginInfo);
-    mSingleTimeCommandList->mIsRecording = true;
+    VK_CHECK(commandBuffer.begin(beginInfo););
 
-    lambda(mSingleTimeCommandList.get());
+    VulkanCommandList commandList({
+        .commandBuffer = commandBuffer,
+        .id            = mNextListId++,
+    });
+    commandList.mIsRecording = true;
 
-    mSingleTimeCommandList->mIsRecording = false;
-    commandBuffers[0].end();
+    lambda(&commandList);
 
-    const auto submitInfo = vk::SubmitInfo()
-        .setCommandBufferCount(1)
-        .setPCommandBuffers(&commandBuffers[0]);
-    if (const auto result = mQueue.submit(1, &submitInfo, nullptr);
+    // Later submissions on this queue, e.g. the frame, see the results without waiting on the timeline
+    const auto memoryBarrier = vk::MemoryBarrier2()
+        .setSrcStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+        .setSrcAccessMask(vk::AccessFlagBits2::eMemoryWrite)
+        .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+        .setDstAccessMask(vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite);
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(memoryBarrier));
+
+    commandList.mIsRecording = false;
+    commandBuffer.end();
+
+    std::lock_guard lock(mSingleTimeMutex);
+    if (!mOpenSingleTimeBatch.has_value())
+    {
+        mOpenSingleTimeBatch = SingleTimeBatch { .timelineValue = mLastSubmittedValue + 1 };
+    }
+    mOpenSingleTimeBatch->commandBuffers.push_back(singleTimeCommandBuffer);
+
+    return { mOpenSingleTimeBatch->timelineValue };
+}
+
+bool VulkanCommandQueue::isComplete(const RHICommandTicket ticket)
+{
+    return ticket.value == 0 or mDevice.getSemaphoreCounterValue(mSingleTimeTimeline) >= ticket.value;
+}
+
+void VulkanCommandQueue::wait(const RHICommandTicket ticket)
+{
+    if (ticket.value == 0)
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(mSingleTimeMutex);
+        if (mOpenSingleTimeBatch.has_value() and ticket.value == mOpenSingleTimeBatch->timelineValue)
+        {
+            submitSingleTimeBatch();
+        }
+    }
+
+    const auto waitInfo = vk::SemaphoreWaitInfo()
+        .setSemaphores(mSingleTimeTimeline)
+        .setValues(ticket.value);
+
+    if (const auto result = mDevice.waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
         result != vk::Result::eSuccess)
     {
-        throw std::runtime_error("Failed to submit CommandLists");
+        throw std::runtime_error("Failed to wait for single-time commands");
     }
 
-    mQueue.waitIdle();
-    mDevice.freeCommandBuffers(mCommandPool, 1, &commandBuffers[0]);
+    std::lock_guard lock(mSingleTimeMutex);
+    retireSingleTimeBatches();
+}
+
+void VulkanCommandQueue::flushSingleTimeCommands()
+{
+    std::lock_guard lock(mSingleTimeMutex);
+    submitSingleTimeBatch();
+}
+
+void VulkanCommandQueue::submitSingleTimeBatch()
+{
+    if (!mOpenSingleTimeBatch.has_value())
+    {
+        return;
+    }
+
+    std::vector<vk::CommandBufferSubmitInfo> commandBufferSubmitInfos;
+    for (const auto& singleTimeCommandBuffer : mOpenSingleTimeBatch->commandBuffers)
+    {
+        commandBufferSubmitInfos.push_back(vk::CommandBufferSubmitInfo().setCommandBuffer(singleTimeCommandBuffer.commandBuffer));
+    }
+
+    const auto signalSemaphoreInfo = vk::SemaphoreSubmitInfo()
+        .setSemaphore(mSingleTimeTimeline)
+        .setValue(mOpenSingleTimeBatch->timelineValue)
+        .setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+
+    const auto submitInfo = vk::SubmitInfo2()
+        .setCommandBufferInfos(commandBufferSubmitInfos)
+        .setSignalSemaphoreInfos(signalSemaphoreInfo);
+
+    if (const auto result = submit2(submitInfo);
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to submit single-time commands");
+    }
+
+    mLastSubmittedValue = mOpenSingleTimeBatch->timelineValue;
+    mInFlightSingleTimeBatches.push_back(std::move(*mOpenSingleTimeBatch));
+    mOpenSingleTimeBatch.reset();
+}
+
+VulkanCommandQueue::SingleTimeCommandBuffer VulkanCommandQueue::acquireSingleTimeCommandBuffer()
+{
+    {
+        std::lock_guard lock(mSingleTimeMutex);
+
+        retireSingleTimeBatches();
+
+        if (!mFreeSingleTimeCommandBuffers.empty())
+        {
+            const auto singleTimeCommandBuffer = mFreeSingleTimeCommandBuffers.back();
+            mFreeSingleTimeCommandBuffers.pop_back();
+            return singleTimeCommandBuffer;
+        }
+    }
+
+    // A pool is externally synchronized, one per command buffer lets threads record at the same time
+    const auto poolCreateInfo = vk::CommandPoolCreateInfo()
+        .setQueueFamilyIndex(mQueueFamilyIndex)
+        .setFlags(vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+
+    SingleTimeCommandBuffer singleTimeCommandBuffer;
+    VK_CHECK(singleTimeCommandBuffer.commandPool = mDevice.createCommandPool(poolCreateInfo););
+
+    const auto bufferAllocateInfo = vk::CommandBufferAllocateInfo()
+        .setCommandBufferCount(1)
+        .setCommandPool(singleTimeCommandBuffer.commandPool)
+        .setLevel(vk::CommandBufferLevel::ePrimary);
+
+    std::vector<vk::CommandBuffer> commandBuffers;
+    VK_CHECK(commandBuffers = mDevice.allocateCommandBuffers(bufferAllocateInfo););
+    singleTimeCommandBuffer.commandBuffer = commandBuffers[0];
+
+    std::lock_guard lock(mSingleTimeMutex);
+    mSingleTimeCommandPools.push_back(singleTimeCommandBuffer.commandPool);
+    return singleTimeCommandBuffer;
+}
+
+void VulkanCommandQueue::retireSingleTimeBatches()
+{
+    if (mInFlightSingleTimeBatches.empty())
+    {
+        return;
+    }
+
+    const uint64_t completedValue = mDevice.getSemaphoreCounterValue(mSingleTimeTimeline);
+    while (!mInFlightSingleTimeBatches.empty() and mInFlightSingleTimeBatches.front().timelineValue <= completedValue)
+    {
+        auto& batch = mInFlightSingleTimeBatches.front();
+        mFreeSingleTimeCommandBuffers.insert(std::end(mFreeSingleTimeCommandBuffers), std::begin(batch.commandBuffers), std::end(batch.commandBuffers));
+        mInFlightSingleTimeBatches.pop_front();
+    }
 }
 
 #pragma endregion "CommandQueue"
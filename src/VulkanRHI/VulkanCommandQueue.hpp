@@ -1,15 +1,32 @@
 #pragma once
 
+#include <atomic>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
 #include "VulkanBase.hpp"
 #include "RHI/RHICommandList.hpp"
 #include "RHI/RHICommandQueue.hpp"
 
+class VulkanPipeline;
+
 struct VulkanCommandListCreateInfo
 {
     vk::CommandBuffer commandBuffer;
     uint32_t          id {};
 };
 
+struct VulkanCommandListStatistics
+{
+    // State changes recorded into the command buffer, and those skipped because the state was already bound
+    uint32_t issuedStateCommands {0};
+    uint32_t elidedStateCommands {0};
+    // Packets of RHICommandStreams translated by executeStream
+    uint32_t streamCommands      {0};
+};
+
 class VulkanCommandList final : public RHICommandList
 {
 public:
@@ -18,11 +35,17 @@ public:
 
     ~VulkanCommandList() override = default;
 
+    // Conversion for callers recording Vulkan commands directly, throws for other lists such as deferred RHICommandStreams
+    static VulkanCommandList* fromRHI(RHICommandList* commandList, const char* caller);
+
     void begin() override
     {
         constexpr auto beginInfo = vk::CommandBufferBeginInfo();
         VK_CHECK(mCommandList.begin(beginInfo););
         mIsRecording = true;
+        mBoundState  = {};
+        mStatistics  = {};
+        mPipeline    = nullptr;
     }
 
     void end() override
@@ -43,9 +66,46 @@ public:
         mCommandList.drawIndexed(indexCount, instanceCount, firstIndex, vertexOffset, firstInstance);
     }
 
-    void bindVertexBuffer(RHIBuffer* buffer) override;
+    void bindVertexBuffer(RHIBuffer* buffer, uint64_t offset = 0) override;
+
+    void bindIndexBuffer(RHIBuffer* buffer, uint64_t offset = 0) override;
+
+    void bindPipeline(RHIPipeline* pipeline) override;
+
+    void setViewport(const Viewport& viewport) override { setViewport(toVulkan(viewport)); }
+
+    void setScissor(const Rect2D& scissor) override { setScissor(toVulkan(scissor)); }
+
+    void drawIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndirectArguments)) override;
+
+    void drawIndexedIndirect(RHIBuffer* buffer, uint64_t offset, uint32_t drawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) override;
 
-    void bindIndexBuffer(RHIBuffer* buffer) override;
+    void drawIndexedIndirectCount(RHIBuffer* buffer, uint64_t offset, RHIBuffer* countBuffer, uint64_t countOffset,
+                                  uint32_t maxDrawCount, uint32_t stride = sizeof(RHIDrawIndexedIndirectArguments)) override;
+
+    void dispatch(uint32_t groupCountX, uint32_t groupCountY = 1, uint32_t groupCountZ = 1) override;
+    void dispatchIndirect(RHIBuffer* buffer, uint64_t offset) override;
+
+    // Stage flags are widened to every range of the bound pipeline overlapping the updated bytes, as Vulkan requires
+    void pushConstants(ShaderStage stage, uint32_t offset, uint32_t size, const void* pData) override;
+    using RHICommandList::pushConstants;
+
+    void executeStream(const RHICommandStream& stream) override;
+
+    /**
+     * State setters skipping the Vulkan call when the same state is already bound in the command buffer.
+     * Commands recorded through handle() bypass the shadowed state, call invalidateState() afterward.
+     */
+    void bindPipeline(const VulkanPipeline* pipeline);
+    void bindPipeline(vk::PipelineBindPoint bindPoint, vk::Pipeline pipeline);
+    void bindDescriptorSets(vk::PipelineBindPoint bindPoint, vk::PipelineLayout layout, uint32_t firstSet, std::span<const vk::DescriptorSet> descriptorSets);
+    void setViewport(const vk::Viewport& viewport);
+    void setScissor(const vk::Rect2D& scissor);
+
+    // Forgets the shadowed state, e.g. after executing secondary command buffers which leave it undefined
+    void invalidateState() { mBoundState = {}; }
+
+    const VulkanCommandListStatistics& getStatistics() const { return mStatistics; }
 
     vk::CommandBuffer handle() const { return mCommandList; }
 
@@ -53,20 +113,55 @@ private:
     friend class VulkanCommandQueue;
     vk::CommandBuffer getUnderlyingCommandBuffer() const;
 
+    void bindVertexBuffer(vk::Buffer buffer, vk::DeviceSize offset);
+    void bindIndexBuffer(vk::Buffer buffer, vk::DeviceSize offset);
+
+    // Returns false and counts the command as elided if the shadowed value already equals value, updates it otherwise
+    template <class T>
+    bool updateState(T& shadowed, const T& value);
+
 private:
     vk::CommandBuffer mCommandList;
     uint32_t          mId;
 
+    static constexpr uint32_t sMaxDescriptorSets = 8;
+
+    struct BindPointState
+    {
+        vk::Pipeline                                      pipeline;
+        vk::PipelineLayout                                layout;
+        std::array<vk::DescriptorSet, sMaxDescriptorSets> descriptorSets;
+    };
+
+    // State known to be bound in the command buffer, null handles and empty optionals are unknown
+    struct BoundState
+    {
+        // Graphics and compute bind points
+        std::array<BindPointState, 2>                   bindPoints;
+        std::pair<vk::Buffer, vk::DeviceSize>           vertexBinding;
+        std::pair<vk::Buffer, vk::DeviceSize>           indexBinding;
+        std::optional<vk::Viewport>                     viewport;
+        std::optional<vk::Rect2D>                       scissor;
+    };
+
+    BoundState                  mBoundState;
+    VulkanCommandListStatistics mStatistics;
+
+    // Last pipeline bound through bindPipeline(const VulkanPipeline*), its layout receives push constants
+    const VulkanPipeline*       mPipeline {nullptr};
+
     bool              mIsRecording = false;
+    bool              mReleased    = false;
 };
 
 struct VulkanCommandQueueCreateInfo
 {
     vk::Device                device;
-    uint32_t                  commandBufferCount;
+    uint32_t                  framesInFlight {2};
     vk::QueueFamilyProperties queueFamilyProperties;
     uint32_t                  queueFamilyIndex;
     const char*               debugName;
+    RHICommandQueueType       type {RHICommandQueueType::Graphics};
 };
 
 class VulkanCommandQueue final : public RHICommandQueue
@@ -77,19 +172,99 @@ public:
 
     ~VulkanCommandQueue() override;
 
-    RHICommandList* getCommandList(uint32_t id)                                                  override;
-    void            executeSingleTimeCommand(const std::function<void(RHICommandList*)>& lambda) override;
+    RHICommandList*  acquireCommandList()                                                              override;
+    void             releaseCommandList(RHICommandList* commandList)                                   override;
+
+    void             executeSingleTimeCommand(const std::function<void(RHICommandList*)>& lambda)      override;
+    RHICommandTicket executeSingleTimeCommandAsync(const std::function<void(RHICommandList*)>& lambda) override;
+    bool             isComplete(RHICommandTicket ticket)                                               override;
+    void             wait(RHICommandTicket ticket)                                                     override;
+    void             flushSingleTimeCommands()                                                         override;
+
+    void             submit(const RHISubmitInfo& submitInfo)                                           override;
 
-    RHICommandQueueType getType() override { return RHICommandQueueType::Graphics; }
+    RHICommandQueueType getType() override { return mType; }
 
-    vk::Queue getQueue() const { return mQueue; }
+    // Makes the frame slot current, resets its pools on every thread and destroys the pools of threads that stopped acquiring lists. Waits for the slot's work submitted through submit(),
+    // work submitted elsewhere (e.g. the frame itself) must have completed. Must not be called while other threads acquire command lists.
+    void      beginFrame(uint32_t frameIndex);
+
+    // Every submission and present on the queue goes through these, the queue must be externally synchronized
+    vk::Result submit2(const vk::SubmitInfo2& submitInfo);
+    vk::Result present(const vk::PresentInfoKHR& presentInfo);
+
+    uint32_t  getQueueFamilyIndex() const { return mQueueFamilyIndex; }
 
 private:
     vk::Queue                                       mQueue;
+    // Serializes frame, single-time, upload and defragmentation submissions, which may come from any thread.
+    // Also guards the submit timeline values below.
+    std::mutex                                      mQueueMutex;
+    uint32_t                                        mQueueFamilyIndex;
+    RHICommandQueueType                             mType;
+
+    struct FrameCommandPool
+    {
+        vk::CommandPool                                 commandPool;
+        // Lists past acquiredCount were reset with the pool and are handed out again before allocating more
+        std::vector<std::unique_ptr<VulkanCommandList>> commandLists;
+        uint32_t                                        acquiredCount {0};
+    };
+
+    struct ThreadCommandPools
+    {
+        // Indexed by frame in flight
+        std::vector<FrameCommandPool> framePools;
+        // Value of mFrameCount when the thread last acquired a list
+        uint64_t                      lastAcquireFrame {0};
+    };
+
+    // Pools of the calling thread, created on its first acquire
+    std::vector<FrameCommandPool>& getThreadPools();
+
+    // Short-lived threads would leak their pools, a thread that acquired nothing for frames in flight frames is retired
+    std::unordered_map<std::thread::id, ThreadCommandPools> mThreadPools;
+    std::mutex                                      mThreadPoolsMutex;
+    uint32_t                                        mFramesInFlight;
+    uint32_t                                        mCurrentFrame {0};
+    // Number of beginFrame calls
+    uint64_t                                        mFrameCount {0};
+    std::atomic<uint32_t>                           mNextListId {0};
+
+    // Signaled by every submit(), indexed by frame in flight with the last value submitted in that slot
+    vk::Semaphore                                   mSubmitTimeline;
+    uint64_t                                        mSubmitValue {0};
+    std::vector<uint64_t>                           mFrameSubmitValues;
+
+    struct SingleTimeCommandBuffer
+    {
+        vk::CommandPool   commandPool;
+        vk::CommandBuffer commandBuffer;
+    };
+
+    struct SingleTimeBatch
+    {
+        uint64_t                             timelineValue {0};
+        std::vector<SingleTimeCommandBuffer> commandBuffers;
+    };
+
+    // Takes a free command buffer or creates one, locks mSingleTimeMutex itself
+    SingleTimeCommandBuffer acquireSingleTimeCommandBuffer();
+
+    // Both expect mSingleTimeMutex to be held
+    void submitSingleTimeBatch();
+    // Returns the command buffers of batches the GPU has completed to the free list
+    void retireSingleTimeBatches();
 
-    vk::CommandPool                                 mCommandPool;
-    std::vector<std::unique_ptr<VulkanCommandList>> mCommandLists;
-    std::unique_ptr<VulkanCommandList>              mSingleTimeCommandList;
+    // Single-time command buffers are recycled by timeline value instead of being freed after every submit.
+    // Each has a pool of its own, so they are recorded without holding mSingleTimeMutex.
+    std::vector<vk::CommandPool>                    mSingleTimeCommandPools;
+    vk::Semaphore                                   mSingleTimeTimeline;
+    std::optional<SingleTimeBatch>                  mOpenSingleTimeBatch;
+    std::deque<SingleTimeBatch>                     mInFlightSingleTimeBatches;
+    std::vector<SingleTimeCommandBuffer>            mFreeSingleTimeCommandBuffers;
+    uint64_t                                        mLastSubmittedValue {0};
+    std::mutex                                      mSingleTimeMutex;
 
     vk::Device                                      mDevice;
 };
@@ -0,0 +1,187 @@
+#include "VulkanDefragmenter.hpp"
+
+VulkanDefragmenter::VulkanDefragmenter(const VulkanDefragmenterCreateInfo& createInfo)
+: mBytesPerFrame(createInfo.bytesPerFrame)
+, mMaxSourceUtilization(createInfo.maxSourceUtilization)
+, mQueue(createInfo.pQueue)
+, mDevice(createInfo.pDevice)
+{
+    const auto poolCreateInfo = vk::CommandPoolCreateInfo()
+        .setQueueFamilyIndex(mQueue->getQueueFamilyIndex())
+        .setFlags(vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+
+    VK_CHECK(mCommandPool = mDevice->handle().createCommandPool(poolCreateInfo););
+
+    const auto bufferAllocateInfo = vk::CommandBufferAllocateInfo()
+        .setCommandBufferCount(createInfo.framesInFlight)
+        .setCommandPool(mCommandPool)
+        .setLevel(vk::CommandBufferLevel::ePrimary);
+
+    std::vector<vk::CommandBuffer> commandBuffers;
+    VK_CHECK(commandBuffers = mDevice->handle().allocateCommandBuffers(bufferAllocateInfo););
+
+    mFrames.resize(createInfo.framesInFlight);
+    for (uint32_t i = 0; i < createInfo.framesInFlight; i++)
+    {
+        mFrames[i].commandBuffer = commandBuffers[i];
+    }
+}
+
+std::unique_ptr<VulkanDefragmenter> VulkanDefragmenter::createVulkanDefragmenter(const VulkanDefragmenterCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanDefragmenter>(createInfo);
+}
+
+VulkanDefragmenter::~VulkanDefragmenter()
+{
+    mDevice->waitIdle();
+
+    for (auto& frame : mFrames)
+    {
+        releaseRetired(frame);
+    }
+    mDevice->handle().destroyCommandPool(mCommandPool);
+}
+
+void VulkanDefragmenter::beginFrame(const uint32_t frameIndex)
+{
+    releaseRetired(mFrames[frameIndex]);
+}
+
+void VulkanDefragmenter::execute(const uint32_t frameIndex)
+{
+    if (mBytesPerFrame == 0)
+    {
+        return;
+    }
+
+    const auto sources = mDevice->getMemoryAllocator()->getDefragmentationSources(mMaxSourceUtilization);
+    if (sources.empty())
+    {
+        return;
+    }
+
+    // Gather first, relocating inserts into the registry that is being iterated
+    std::vector<VulkanAllocation*> candidates;
+    mDevice->getAllocationRegistry()->forEach([&](VulkanAllocation* allocation) {
+        const VulkanRelocatable* owner = allocation->getOwner();
+        if (owner != nullptr and owner->isRelocatable() and std::ranges::find(sources, allocation->getBlock()) != std::end(sources))
+        {
+            candidates.push_back(allocation);
+        }
+    });
+
+    if (candidates.empty())
+    {
+        return;
+    }
+
+    // Large allocations first, they are the hardest to place once other blocks fill up
+    std::ranges::sort(candidates, std::ranges::greater{}, &VulkanAllocation::getSize);
+
+    auto& frame = mFrames[frameIndex];
+    const auto commandBuffer = frame.commandBuffer;
+
+    constexpr auto beginInfo = vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    commandBuffer.begin(beginInfo);
+
+    // Writes of earlier submissions have to land before their results are copied
+    const auto preCopyBarrier = vk::MemoryBarrier2()
+        .setSrcStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+        .setSrcAccessMask(vk::AccessFlagBits2::eMemoryWrite)
+        .setDstStageMask(vk::PipelineStageFlagBits2::eCopy)
+        .setDstAccessMask(vk::AccessFlagBits2::eTransferRead);
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(preCopyBarrier));
+
+    uint64_t bytesMoved = 0;
+    uint32_t allocationsMoved = 0;
+
+    for (const VulkanAllocation* allocation : candidates)
+    {
+        const vk::DeviceSize size = allocation->getSize();
+
+        // Always allow the first move, so allocations larger than the budget still make progress
+        if (bytesMoved > 0 and bytesMoved + size > mBytesPerFrame)
+        {
+            continue;
+        }
+
+        auto retired = allocation->getOwner()->relocate(commandBuffer);
+        if (!retired.has_value())
+        {
+            continue;
+        }
+
+        // Earlier frames may still use the old handles, they complete before the fence of this frame signals
+        frame.retiredResources.push_back(retired.value());
+        bytesMoved += size;
+        allocationsMoved++;
+    }
+
+    const auto postCopyBarrier = vk::MemoryBarrier2()
+        .setSrcStageMask(vk::PipelineStageFlagBits2::eCopy)
+        .setSrcAccessMask(vk::AccessFlagBits2::eTransferWrite)
+        .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+        .setDstAccessMask(vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite);
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(postCopyBarrier));
+
+    commandBuffer.end();
+
+    // Nothing could be placed, the empty command buffer is not worth a submission
+    if (allocationsMoved == 0)
+    {
+        return;
+    }
+
+    const auto commandBufferSubmitInfo = vk::CommandBufferSubmitInfo()
+        .setCommandBuffer(commandBuffer);
+
+    const auto submitInfo = vk::SubmitInfo2()
+        .setCommandBufferInfos(commandBufferSubmitInfo);
+
+    if (const auto result = mQueue->submit2(submitInfo);
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to submit defragmentation copies");
+    }
+
+    mStatistics.bytesMoved       += bytesMoved;
+    mStatistics.allocationsMoved += allocationsMoved;
+
+    VK_VERBOSE(fmt::format("Defragmentation moved {} allocations ({} bytes)", allocationsMoved, bytesMoved));
+}
+
+void VulkanDefragmenter::releaseRetired(FrameData& frame)
+{
+    if (frame.retiredResources.empty())
+    {
+        return;
+    }
+
+    const uint32_t blockCount = mDevice->getMemoryAllocator()->getBlockCount();
+
+    for (const auto& retired : frame.retiredResources)
+    {
+        if (retired.imageView)
+        {
+            mDevice->handle().destroyImageView(retired.imageView);
+        }
+
+        if (std::holds_alternative<vk::Buffer>(retired.handle))
+        {
+            mDevice->handle().destroyBuffer(std::get<vk::Buffer>(retired.handle));
+        }
+        if (std::holds_alternative<vk::Image>(retired.handle))
+        {
+            mDevice->handle().destroyImage(std::get<vk::Image>(retired.handle));
+        }
+
+        mDevice->freeMemory(retired.allocation);
+    }
+    frame.retiredResources.clear();
+
+    if (const uint32_t remaining = mDevice->getMemoryAllocator()->getBlockCount(); remaining < blockCount)
+    {
+        mStatistics.blocksFreed += blockCount - remaining;
+    }
+}
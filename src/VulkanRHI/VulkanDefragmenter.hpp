@@ -0,0 +1,66 @@
+#pragma once
+
+#include "VulkanBase.hpp"
+#include "VulkanCommandQueue.hpp"
+#include "VulkanDevice.hpp"
+
+struct VulkanDefragmenterCreateInfo
+{
+    // Upper bound of bytes copied per frame, 0 disables defragmentation
+    uint64_t             bytesPerFrame        {8ull * 1024 * 1024};
+    // Blocks at or below this utilization are evacuated into denser blocks
+    float                maxSourceUtilization {0.5f};
+    uint32_t             framesInFlight       {2};
+    VulkanCommandQueue*  pQueue               {nullptr};
+    VulkanDevice*        pDevice              {nullptr};
+};
+
+struct VulkanDefragmentationStatistics
+{
+    uint64_t bytesMoved       {0};
+    uint32_t allocationsMoved {0};
+    uint32_t blocksFreed      {0};
+};
+
+/**
+ * Incrementally evacuates sparsely used memory blocks.
+ * At the start of every frame, buffers and textures that opted into relocation are moved out of the least utilized
+ * block of each pool with GPU copies, until the byte budget is used up. Their previous handles and memory are retired
+ * with the frame, and released once its fence has signaled, which lets the allocator drop the emptied blocks.
+ */
+class VulkanDefragmenter
+{
+public:
+    DISABLE_COPY_CTOR(VulkanDefragmenter);
+    explicit DEF_PRIMARY_CTOR(VulkanDefragmenter, const VulkanDefragmenterCreateInfo& createInfo);
+
+    ~VulkanDefragmenter();
+
+    // Releases resources retired by the frame that last used this slot, its fence must have signaled
+    void beginFrame(uint32_t frameIndex);
+
+    // Records and submits this frame's relocations, must be called before anything of the frame is recorded
+    void execute(uint32_t frameIndex);
+
+    const VulkanDefragmentationStatistics& getStatistics() const { return mStatistics; }
+
+private:
+    struct FrameData
+    {
+        vk::CommandBuffer                  commandBuffer;
+        std::vector<VulkanRetiredResource> retiredResources;
+    };
+
+    void releaseRetired(FrameData& frame);
+
+    std::vector<FrameData>          mFrames;
+    vk::CommandPool                 mCommandPool;
+
+    VulkanDefragmentationStatistics mStatistics;
+
+    const uint64_t                  mBytesPerFrame;
+    const float                     mMaxSourceUtilization;
+
+    VulkanCommandQueue*             mQueue;
+    VulkanDevice*                   mDevice;
+};
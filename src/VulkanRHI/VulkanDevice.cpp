@@ -1,5 +1,7 @@
 #include "VulkanDevice.hpp"
 
+#include <bit>
+
 fmt::color getVendorColor(const uint32_t vendorID)
 {
     if (vendorID == 0x1002) return fmt::color::crimson;
@@ -11,6 +13,8 @@ fmt::color getVendorColor(const uint32_t vendorID)
 
 VulkanDevice::VulkanDevice(const VulkanDeviceCreateInfo& createInfo)
 : mInstance(createInfo.instance)
+, mFramesInFlight(createInfo.framesInFlight)
+, mPipelineCachePath(createInfo.pipelineCachePath)
 {
     selectPhysicalDevice();
     VK_PRINTLN(fmt::format("Using PhysicalDevice: {}", styled(mDeviceName, fg(getVendorColor(mPhysicalDeviceProperties.vendorID)))));
@@ -43,25 +47,87 @@ VulkanAllocation* VulkanDevice::allocateMemory(const VulkanAllocationInfo& alloc
         memoryRequirements = mDevice.getImageMemoryRequirements(image);
     }
 
-    constexpr auto allocateFlags = vk::MemoryAllocateFlagsInfo().setFlags(vk::MemoryAllocateFlagBits::eDeviceAddress);
-    const auto allocateInfo = vk::MemoryAllocateInfo()
-        .setAllocationSize(memoryRequirements.size)
-        .setMemoryTypeIndex(findMemoryHeapIndex(memoryRequirements.memoryTypeBits, allocationInfo.propertyFlags))
-        .setPNext(&allocateFlags);
+    std::lock_guard lock(mAllocationMutex);
+
+    const auto candidates = rankMemoryTypes(memoryRequirements.memoryTypeBits, allocationInfo, memoryRequirements.size);
+    if (candidates.empty())
+    {
+        throw std::runtime_error("Failed to find suitable memory type");
+    }
+
+    const vk::DeviceSize atomSize = mPhysicalDeviceProperties.limits.nonCoherentAtomSize;
+
+    for (const uint32_t memoryTypeIndex : candidates)
+    {
+        // Relocated resources keep their memory type, the owner relies on its properties
+        if (allocationInfo.excludedBlock != nullptr and memoryTypeIndex != allocationInfo.excludedBlock->getMemoryTypeIndex())
+        {
+            continue;
+        }
+
+        const vk::MemoryPropertyFlags memoryFlags = mMemoryProperties.memoryTypes[memoryTypeIndex].propertyFlags;
+
+        // Keep non-coherent allocations on separate nonCoherentAtomSize ranges so flushes never touch neighbours
+        vk::MemoryRequirements requirements = memoryRequirements;
+        if ((memoryFlags & vk::MemoryPropertyFlagBits::eHostVisible) and !(memoryFlags & vk::MemoryPropertyFlagBits::eHostCoherent))
+        {
+            requirements.alignment = std::max(requirements.alignment, atomSize);
+            requirements.size      = (requirements.size + atomSize - 1) / atomSize * atomSize;
+        }
+
+        VulkanMemoryRange range;
+        try
+        {
+            range = mMemoryAllocator->allocate({
+                .requirements    = requirements,
+                .memoryTypeIndex = memoryTypeIndex,
+                .linear          = std::holds_alternative<vk::Buffer>(allocationInfo.target),
+                .excludedBlock   = allocationInfo.excludedBlock,
+                .allowNewBlock   = allocationInfo.allowNewBlock,
+            });
+        }
+        catch (const vk::SystemError& error)
+        {
+            if (error.code() != vk::Result::eErrorOutOfDeviceMemory and error.code() != vk::Result::eErrorOutOfHostMemory)
+            {
+                throw;
+            }
+            VK_DEBUG(fmt::format("{}", styled(fmt::format("Memory type {} exhausted, falling back to the next candidate", memoryTypeIndex), fg(fmt::color::light_yellow))));
+            continue;
+        }
+
+        if (range.block == nullptr)
+        {
+            continue;
+        }
 
-    vk::DeviceMemory memory;
-    VK_CHECK_DEBUG(
-        memory = mDevice.allocateMemory(allocateInfo);
-    );
+        return mAllocationRegistry->insert(VulkanAllocation::createVulkanAllocation({
+            .device              = mDevice,
+            .allocator           = mMemoryAllocator.get(),
+            .range               = range,
+            .heapIndex           = mMemoryProperties.memoryTypes[memoryTypeIndex].heapIndex,
+            .propertyFlags       = memoryFlags,
+            .nonCoherentAtomSize = atomSize,
+            .target              = allocationInfo.target,
+        }));
+    }
 
-    mMemoryAllocations.push_back(VulkanAllocation::createVulkanAllocation({
-        .device        = mDevice,
-        .memory        = memory,
-        .size          = memoryRequirements.size,
-        .target        = allocationInfo.target,
-    }));
+    if (!allocationInfo.allowNewBlock)
+    {
+        return nullptr;
+    }
+    throw std::runtime_error("Failed to allocate memory, every suitable memory type is exhausted");
+}
 
-    return mMemoryAllocations.back().get();
+void VulkanDevice::freeMemory(const VulkanAllocation* allocation)
+{
+    if (allocation == nullptr)
+    {
+        return;
+    }
+
+    std::lock_guard lock(mAllocationMutex);
+    mAllocationRegistry->release(allocation->getHandle());
 }
 
 void VulkanDevice::selectPhysicalDevice()
@@ -100,6 +166,7 @@ void VulkanDevice::selectPhysicalDevice()
 
     mPhysicalDevice = *candidate;
     mPhysicalDeviceProperties = mPhysicalDevice.getProperties();
+    mMemoryProperties = mPhysicalDevice.getMemoryProperties();
     mDeviceName = std::string(mPhysicalDeviceProperties.deviceName.data());
 }
 
@@ -132,6 +199,20 @@ void VulkanDevice::createDevice()
         uniqueQueueFamilies.insert(queueGraphics->queueFamilyIndex);
     }
 
+    // Transfer-only families are usually backed by dedicated DMA engines
+    const auto queueTransfer = findQueue(vk::QueueFlagBits::eTransfer, vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute);
+    if (queueTransfer.has_value())
+    {
+        uniqueQueueFamilies.insert(queueTransfer->queueFamilyIndex);
+    }
+
+    // Compute families without graphics support run alongside rasterization on most hardware
+    const auto queueCompute = findQueue(vk::QueueFlagBits::eCompute, vk::QueueFlagBits::eGraphics);
+    if (queueCompute.has_value())
+    {
+        uniqueQueueFamilies.insert(queueCompute->queueFamilyIndex);
+    }
+
     constexpr float queuePriority = 1.0f;
 
     std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos;
@@ -162,13 +243,53 @@ void VulkanDevice::createDevice()
 
     VK_CHECK(mDevice = mPhysicalDevice.createDevice(createInfo););
 
+    mMemoryAllocator = VulkanMemoryAllocator::createVulkanMemoryAllocator({
+        .device = mDevice,
+    });
+    mAllocationRegistry = VulkanAllocationRegistry::createVulkanAllocationRegistry(mMemoryProperties.memoryHeapCount);
+
     mGraphicsCommandQueue = VulkanCommandQueue::createVulkanCommandQueue({
         .device                = mDevice,
-        .commandBufferCount    = 2,
+        .framesInFlight        = mFramesInFlight,
         .queueFamilyProperties = queueGraphics->queueFamilyProperties,
         .queueFamilyIndex      = queueGraphics->queueFamilyIndex,
         .debugName             = "Graphics"
     });
+
+    if (queueTransfer.has_value())
+    {
+        mTransferCommandQueue = VulkanCommandQueue::createVulkanCommandQueue({
+            .device                = mDevice,
+            .framesInFlight        = mFramesInFlight,
+            .queueFamilyProperties = queueTransfer->queueFamilyProperties,
+            .queueFamilyIndex      = queueTransfer->queueFamilyIndex,
+            .debugName             = "Transfer",
+            .type                  = RHICommandQueueType::Transfer,
+        });
+    }
+
+    if (queueCompute.has_value())
+    {
+        mComputeCommandQueue = VulkanCommandQueue::createVulkanCommandQueue({
+            .device                = mDevice,
+            .framesInFlight        = mFramesInFlight,
+            .queueFamilyProperties = queueCompute->queueFamilyProperties,
+            .queueFamilyIndex      = queueCompute->queueFamilyIndex,
+            .debugName             = "Compute",
+            .type                  = RHICommandQueueType::AsyncCompute,
+        });
+    }
+
+    mPipelineCache = VulkanPipelineCache::createVulkanPipelineCache({
+        .device     = mDevice,
+        .properties = mPhysicalDeviceProperties,
+        .filePath   = mPipelineCachePath,
+    });
+    mShaderModuleCache = VulkanShaderModuleCache::createVulkanShaderModuleCache(this);
+    mLayoutCache       = VulkanLayoutCache::createVulkanLayoutCache(mDevice);
+
+    VK_VERBOSE(fmt::format("Transfer queue: {}", queueTransfer.has_value() ? "dedicated" : "shared with graphics"));
+    VK_VERBOSE(fmt::format("Compute queue: {}", queueCompute.has_value() ? "dedicated" : "shared with graphics"));
 }
 
 std::optional<VulkanQueueProperties> VulkanDevice::findQueue(vk::QueueFlags requiredFlags, vk::QueueFlags excludedFlags) const
@@ -190,17 +311,82 @@ std::optional<VulkanQueueProperties> VulkanDevice::findQueue(vk::QueueFlags requ
     return std::make_optional(queueProperties);
 }
 
-uint32_t VulkanDevice::findMemoryHeapIndex(uint32_t filter, vk::MemoryPropertyFlags propertyFlags) const
+std::vector<uint32_t> VulkanDevice::rankMemoryTypes(const uint32_t filter, const VulkanAllocationInfo& allocationInfo, const vk::DeviceSize size) const
+{
+    // Flag matches outweigh everything but the budget, heap size only breaks ties
+    constexpr int32_t flagWeight   = 10;
+    constexpr int32_t budgetWeight = 100;
+
+    // Never picked unless explicitly required
+    constexpr auto specialFlags = vk::MemoryPropertyFlagBits::eProtected | vk::MemoryPropertyFlagBits::eLazilyAllocated;
+
+    const auto countFlags = [](const vk::MemoryPropertyFlags flags) {
+        return static_cast<int32_t>(std::popcount(static_cast<VkMemoryPropertyFlags>(flags)));
+    };
+
+    struct Candidate
+    {
+        uint32_t       memoryTypeIndex;
+        int32_t        score;
+        vk::DeviceSize heapSize;
+    };
+
+    std::vector<Candidate> candidates;
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++)
+    {
+        const auto& memoryType = mMemoryProperties.memoryTypes[i];
+        const auto  flags      = memoryType.propertyFlags;
+
+        if (!(filter & (1u << i)) or (flags & allocationInfo.propertyFlags) != allocationInfo.propertyFlags)
+        {
+            continue;
+        }
+        if ((flags & specialFlags) & ~allocationInfo.propertyFlags)
+        {
+            continue;
+        }
+
+        int32_t score = flagWeight * (countFlags(flags & allocationInfo.preferredFlags) - countFlags(flags & allocationInfo.avoidedFlags));
+
+        // Over-budget heaps stay usable, but only as a last resort
+        if (getHeapUsage(memoryType.heapIndex) + size > getHeapBudget(memoryType.heapIndex))
+        {
+            score -= budgetWeight;
+        }
+
+        candidates.push_back({ i, score, mMemoryProperties.memoryHeaps[memoryType.heapIndex].size });
+    }
+
+    std::ranges::stable_sort(candidates, [](const Candidate& lhs, const Candidate& rhs) {
+        return (lhs.score != rhs.score) ? lhs.score > rhs.score : lhs.heapSize > rhs.heapSize;
+    });
+
+    std::vector<uint32_t> result;
+    result.reserve(candidates.size());
+    for (const auto& candidate : candidates)
+    {
+        result.push_back(candidate.memoryTypeIndex);
+    }
+    return result;
+}
+
+vk::DeviceSize VulkanDevice::getHeapUsage(const uint32_t heapIndex) const
 {
-    const auto memoryProperties = mPhysicalDevice.getMemoryProperties();
-    for (auto i = 0; i < memoryProperties.memoryTypeCount; i++)
+    vk::DeviceSize usage = 0;
+    for (uint32_t i = 0; i < mMemoryProperties.memoryTypeCount; i++)
     {
-        if ((filter & (1 << i)) and (memoryProperties.memoryTypes[i].propertyFlags & propertyFlags) == propertyFlags)
+        if (mMemoryProperties.memoryTypes[i].heapIndex == heapIndex)
         {
-            return i;
+            usage += mMemoryAllocator->getBlockBytes(i);
         }
     }
-    throw std::runtime_error("Failed to find suitable memory heap");
+    return usage;
+}
+
+vk::DeviceSize VulkanDevice::getHeapBudget(const uint32_t heapIndex) const
+{
+    // Leave headroom for other processes and driver-internal allocations
+    return mMemoryProperties.memoryHeaps[heapIndex].size / 10 * 8;
 }
 
 vk::PhysicalDeviceFeatures VulkanDevice::getBaseDeviceFeatures()
@@ -209,6 +395,7 @@ vk::PhysicalDeviceFeatures VulkanDevice::getBaseDeviceFeatures()
         .setGeometryShader(false)
         .setTessellationShader(false)
         .setFillModeNonSolid(true)
+        .setMultiDrawIndirect(true)
         .setSamplerAnisotropy(true)
         .setSampleRateShading(true)
         .setShaderInt64(true);
@@ -1,13 +1,21 @@
 #pragma once
 
+#include <mutex>
 #include "VulkanAllocator.hpp"
 #include "VulkanBase.hpp"
 #include "VulkanCommandQueue.hpp"
 #include "VulkanDeviceExtension.hpp"
+#include "VulkanLayoutCache.hpp"
+#include "VulkanPipelineCache.hpp"
+#include "VulkanShaderModuleCache.hpp"
 
 struct VulkanDeviceCreateInfo
 {
     vk::Instance instance;
+    // Command list pools of every queue are kept per frame in flight
+    uint32_t     framesInFlight {2};
+    // Pipeline cache file, reused by later runs on the same device and driver
+    const char*  pipelineCachePath {"pipeline_cache.bin"};
 };
 
 struct VulkanQueueProperties
@@ -18,8 +26,13 @@ struct VulkanQueueProperties
 
 struct VulkanAllocationInfo
 {
+    // Memory types lacking any of the required flags are never used, preferred and avoided flags rank the remaining ones
     vk::MemoryPropertyFlags             propertyFlags;
     std::variant<vk::Buffer, vk::Image> target;
+    vk::MemoryPropertyFlags             preferredFlags {};
+    vk::MemoryPropertyFlags             avoidedFlags   {};
+    const VulkanMemoryBlock*            excludedBlock  {nullptr};
+    bool                                allowNewBlock  {true};
 
     auto& setPropertyFlags(const vk::MemoryPropertyFlags value)
     {
@@ -27,12 +40,32 @@ struct VulkanAllocationInfo
         return *this;
     }
 
+    auto& setPreferredFlags(const vk::MemoryPropertyFlags value)
+    {
+        preferredFlags = value;
+        return *this;
+    }
+
+    auto& setAvoidedFlags(const vk::MemoryPropertyFlags value)
+    {
+        avoidedFlags = value;
+        return *this;
+    }
+
     template <class T>
     auto& setTarget(const T& handle)
     {
         target = handle;
         return *this;
     }
+
+    // Relocation: place the allocation in any existing block except the given one, or fail
+    auto& setRelocationSource(const VulkanMemoryBlock* block)
+    {
+        excludedBlock = block;
+        allowNewBlock = false;
+        return *this;
+    }
 };
 
 template <class T>
@@ -52,16 +85,41 @@ public:
 
     void waitIdle() const;
 
-    // Returns a non-owning pointer to the allocated memory
+    // Returns a non-owning pointer to the allocated memory, sub-allocated from a shared memory block.
+    // Returns nullptr only for relocation requests that cannot be placed. May be called from any thread, as may freeMemory.
     VulkanAllocation*                allocateMemory(const VulkanAllocationInfo& allocationInfo);
 
+    // Releases the allocation and recycles its registry slot, the pointer is invalid afterward
+    void                             freeMemory(const VulkanAllocation* allocation);
+
+    // Live allocation count and bytes, indexed by memory heap
+    const std::vector<VulkanHeapStatistics>& getHeapStatistics() const { return mAllocationRegistry->getHeapStatistics(); }
+    uint32_t                                 getLiveAllocationCount() const { return mAllocationRegistry->getLiveCount(); }
+
+    VulkanMemoryAllocator*                   getMemoryAllocator()     const { return mMemoryAllocator.get(); }
+    const VulkanAllocationRegistry*          getAllocationRegistry()  const { return mAllocationRegistry.get(); }
+
     template <class T>
     void                             nameObject(const VulkanNameObjectInfo<T>& nameObjectInfo) const;
 
     VulkanCommandQueue*              getGraphicsQueue()  const { return mGraphicsCommandQueue.get(); }
 
-    vk::Device         handle()            const { return mDevice; }
-    vk::PhysicalDevice getPhysicalDevice() const { return mPhysicalDevice; }
+    // Returns the graphics queue if the device has no transfer-only queue family
+    VulkanCommandQueue*              getTransferQueue()  const { return mTransferCommandQueue ? mTransferCommandQueue.get() : mGraphicsCommandQueue.get(); }
+    bool                             hasDedicatedTransferQueue() const { return mTransferCommandQueue != nullptr; }
+
+    // Returns the graphics queue if the device has no compute queue family without graphics support
+    VulkanCommandQueue*              getComputeQueue()   const { return mComputeCommandQueue ? mComputeCommandQueue.get() : mGraphicsCommandQueue.get(); }
+    bool                             hasDedicatedComputeQueue() const { return mComputeCommandQueue != nullptr; }
+
+    // Shared by every pipeline creation on the device
+    VulkanPipelineCache*             getPipelineCache()  const { return mPipelineCache.get(); }
+    VulkanShaderModuleCache*         getShaderModuleCache() const { return mShaderModuleCache.get(); }
+    VulkanLayoutCache*               getLayoutCache()    const { return mLayoutCache.get(); }
+
+    vk::Device                          handle()            const { return mDevice; }
+    vk::PhysicalDevice                  getPhysicalDevice() const { return mPhysicalDevice; }
+    const vk::PhysicalDeviceProperties& getProperties()     const { return mPhysicalDeviceProperties; }
 
 private:
     void selectPhysicalDevice();
@@ -70,15 +128,23 @@ private:
 
     std::optional<VulkanQueueProperties> findQueue(vk::QueueFlags requiredFlags, vk::QueueFlags excludedFlags = {}) const;
 
-    uint32_t findMemoryHeapIndex(uint32_t filter, vk::MemoryPropertyFlags propertyFlags) const;
+    // Memory types usable for the allocation, best candidate first
+    std::vector<uint32_t> rankMemoryTypes(uint32_t filter, const VulkanAllocationInfo& allocationInfo, vk::DeviceSize size) const;
+
+    // Bytes held in memory blocks of the heap, and the share of the heap the RHI aims to stay below
+    vk::DeviceSize getHeapUsage(uint32_t heapIndex) const;
+    vk::DeviceSize getHeapBudget(uint32_t heapIndex) const;
 
     static vk::PhysicalDeviceFeatures getBaseDeviceFeatures();
 
 private:
     vk::Instance                                        mInstance;
+    const uint32_t                                      mFramesInFlight;
+    const char*                                         mPipelineCachePath;
 
     vk::PhysicalDevice                                  mPhysicalDevice;
     vk::PhysicalDeviceProperties                        mPhysicalDeviceProperties;
+    vk::PhysicalDeviceMemoryProperties                  mMemoryProperties;
     std::string                                         mDeviceName;
 
     vk::Device                                          mDevice;
@@ -86,8 +152,17 @@ private:
     std::vector<const char*>                            mDeviceExtensionNames;
 
     std::unique_ptr<VulkanCommandQueue>                 mGraphicsCommandQueue;
+    std::unique_ptr<VulkanCommandQueue>                 mTransferCommandQueue;
+    std::unique_ptr<VulkanCommandQueue>                 mComputeCommandQueue;
+
+    std::unique_ptr<VulkanPipelineCache>                mPipelineCache;
+    std::unique_ptr<VulkanShaderModuleCache>            mShaderModuleCache;
+    std::unique_ptr<VulkanLayoutCache>                  mLayoutCache;
 
-    std::vector<std::unique_ptr<VulkanAllocation>>      mMemoryAllocations;
+    std::unique_ptr<VulkanMemoryAllocator>              mMemoryAllocator;
+    std::unique_ptr<VulkanAllocationRegistry>           mAllocationRegistry;
+    // Guards the allocator and registry against resources created or destroyed on recording threads
+    std::mutex                                          mAllocationMutex;
 };
 
 template<class T>
@@ -42,6 +42,7 @@ public:
             .setShaderInt8(true)
             .setTimelineSemaphore(true)
             .setHostQueryReset(true)
+            .setDrawIndirectCount(true)
             .setScalarBlockLayout(true);
     }
 
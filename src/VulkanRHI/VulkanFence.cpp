@@ -0,0 +1,72 @@
+#include "VulkanFence.hpp"
+
+#include "VulkanDevice.hpp"
+
+VulkanFence::VulkanFence(const VulkanFenceCreateInfo& createInfo)
+: mDebugName(createInfo.debugName)
+, mDevice(createInfo.pDevice)
+{
+    auto semaphoreTypeCreateInfo = vk::SemaphoreTypeCreateInfo()
+        .setSemaphoreType(vk::SemaphoreType::eTimeline)
+        .setInitialValue(createInfo.initialValue);
+
+    const auto semaphoreCreateInfo = vk::SemaphoreCreateInfo()
+        .setPNext(&semaphoreTypeCreateInfo);
+
+    VK_CHECK(mSemaphore = mDevice->handle().createSemaphore(semaphoreCreateInfo););
+
+    mDevice->nameObject<vk::Semaphore>({
+        .debugName = mDebugName.c_str(),
+        .handle    = mSemaphore,
+    });
+}
+
+std::unique_ptr<VulkanFence> VulkanFence::createVulkanFence(const VulkanFenceCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanFence>(createInfo);
+}
+
+VulkanFence::~VulkanFence()
+{
+    mDevice->handle().destroySemaphore(mSemaphore);
+}
+
+uint64_t VulkanFence::getCompletedValue()
+{
+    return mDevice->handle().getSemaphoreCounterValue(mSemaphore);
+}
+
+void VulkanFence::signal(const uint64_t value)
+{
+    const auto signalInfo = vk::SemaphoreSignalInfo()
+        .setSemaphore(mSemaphore)
+        .setValue(value);
+
+    VK_CHECK(mDevice->handle().signalSemaphore(signalInfo););
+}
+
+bool VulkanFence::wait(const uint64_t value, const uint64_t timeout)
+{
+    const auto waitInfo = vk::SemaphoreWaitInfo()
+        .setSemaphores(mSemaphore)
+        .setValues(value);
+
+    const vk::Result result = mDevice->handle().waitSemaphores(waitInfo, timeout);
+    if (result == vk::Result::eTimeout)
+    {
+        return false;
+    }
+    if (result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error(fmt::format("Failed to wait for fence {}", mDebugName));
+    }
+    return true;
+}
+
+vk::SemaphoreSubmitInfo VulkanFence::getSubmitInfo(const uint64_t value, const vk::PipelineStageFlags2 stageMask) const
+{
+    return vk::SemaphoreSubmitInfo()
+        .setSemaphore(mSemaphore)
+        .setValue(value)
+        .setStageMask(stageMask);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include "VulkanBase.hpp"
+#include "RHI/RHIFence.hpp"
+
+class VulkanDevice;
+
+struct VulkanFenceCreateInfo
+{
+    uint64_t      initialValue {0};
+    std::string   debugName;
+    VulkanDevice* pDevice;
+};
+
+/**
+ * RHIFence backed by a timeline semaphore.
+ */
+class VulkanFence final : public RHIFence
+{
+public:
+    DISABLE_COPY_CTOR(VulkanFence);
+    explicit DEF_PRIMARY_CTOR(VulkanFence, const VulkanFenceCreateInfo& createInfo);
+
+    ~VulkanFence() override;
+
+    uint64_t getCompletedValue() override;
+
+    void     signal(uint64_t value) override;
+
+    bool     wait(uint64_t value, uint64_t timeout = std::numeric_limits<uint64_t>::max()) override;
+
+    vk::Semaphore handle() const { return mSemaphore; }
+
+    // Semaphore info for a submission waiting on or signaling the value
+    vk::SemaphoreSubmitInfo getSubmitInfo(uint64_t value, vk::PipelineStageFlags2 stageMask = vk::PipelineStageFlagBits2::eAllCommands) const;
+
+private:
+    vk::Semaphore  mSemaphore;
+    std::string    mDebugName;
+
+    VulkanDevice*  mDevice;
+};
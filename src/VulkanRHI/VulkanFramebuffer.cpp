@@ -1,10 +1,32 @@
 #include "VulkanFramebuffer.hpp"
 
-VulkanFramebufferHandle::VulkanFramebufferHandle(const vk::Framebuffer framebuffer)
-: RHIFramebufferHandle(), mFramebuffer(framebuffer)
+VulkanFramebufferHandle::VulkanFramebufferHandle(const vk::Framebuffer framebuffer, const std::vector<const VulkanTexture*>& transientAttachments)
+: RHIFramebufferHandle(), mFramebuffer(framebuffer), mTransientAttachments(transientAttachments)
 {
 }
 
+std::optional<vk::MemoryBarrier2> VulkanFramebufferHandle::getAliasingBarrier() const
+{
+    std::optional<vk::MemoryBarrier2> result;
+    for (const VulkanTexture* attachment : mTransientAttachments)
+    {
+        if (!attachment->isAliased())
+        {
+            continue;
+        }
+
+        const auto barrier = attachment->getAliasingBarrier();
+        if (!result.has_value())
+        {
+            result = barrier;
+            continue;
+        }
+        result->dstStageMask  |= barrier.dstStageMask;
+        result->dstAccessMask |= barrier.dstAccessMask;
+    }
+    return result;
+}
+
 #pragma region "VulkanFramebufferInfo"
 
 VulkanFramebufferInfo& VulkanFramebufferInfo::addAttachment(const vk::ImageView &imageView,
@@ -121,7 +143,7 @@ VulkanFramebuffer::VulkanFramebuffer(VulkanFramebufferInfo& framebuffersInfo)
             .handle = framebuffers[i],
         });
 
-        mFramebuffers[i] = std::make_unique<VulkanFramebufferHandle>(framebuffers[i]);
+        mFramebuffers[i] = std::make_unique<VulkanFramebufferHandle>(framebuffers[i], framebuffersInfo.transientAttachments);
     }
 }
 
@@ -2,19 +2,24 @@
 
 #include "VulkanBase.hpp"
 #include "VulkanDevice.hpp"
+#include "VulkanTexture.hpp"
 #include "RHI/RHIFramebuffer.hpp"
 
 class VulkanFramebufferHandle final : public RHIFramebufferHandle
 {
 public:
-    explicit VulkanFramebufferHandle(vk::Framebuffer framebuffer);
+    explicit VulkanFramebufferHandle(vk::Framebuffer framebuffer, const std::vector<const VulkanTexture*>& transientAttachments = {});
 
     ~VulkanFramebufferHandle() override = default;
 
     vk::Framebuffer handle() const { return mFramebuffer; }
 
+    // Barrier covering the attachments that share memory with other textures, std::nullopt if there are none
+    std::optional<vk::MemoryBarrier2> getAliasingBarrier() const;
+
 private:
-    vk::Framebuffer mFramebuffer;
+    vk::Framebuffer                   mFramebuffer;
+    std::vector<const VulkanTexture*> mTransientAttachments;
 };
 
 struct VulkanFramebufferInfo
@@ -35,6 +40,8 @@ struct VulkanFramebufferInfo
 
     std::map<uint32_t, std::vector<vk::ImageView>> attachments {};
     int32_t lastAttachmentIndex {-1};
+
+    std::vector<const VulkanTexture*> transientAttachments {};
 };
 
 class VulkanFramebuffer final : public RHIFramebuffer
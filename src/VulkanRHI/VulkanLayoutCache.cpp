@@ -0,0 +1,96 @@
+#include "VulkanLayoutCache.hpp"
+
+VulkanLayoutCache::VulkanLayoutCache(const vk::Device device)
+: mDevice(device)
+{
+}
+
+std::unique_ptr<VulkanLayoutCache> VulkanLayoutCache::createVulkanLayoutCache(const vk::Device device)
+{
+    return std::make_unique<VulkanLayoutCache>(device);
+}
+
+VulkanLayoutCache::~VulkanLayoutCache()
+{
+    for (const auto& pipelineLayout : mPipelineLayouts | std::views::values)
+    {
+        mDevice.destroyPipelineLayout(pipelineLayout);
+    }
+    for (const auto& setLayout : mDescriptorSetLayouts | std::views::values)
+    {
+        mDevice.destroyDescriptorSetLayout(setLayout);
+    }
+}
+
+vk::DescriptorSetLayout VulkanLayoutCache::getDescriptorSetLayout(const std::span<const vk::DescriptorSetLayoutBinding> bindings)
+{
+    VulkanStateKey key;
+    for (const auto& binding : bindings)
+    {
+        key.add(binding.binding).add(binding.descriptorType).add(binding.descriptorCount).add(binding.stageFlags);
+    }
+
+    std::lock_guard lock(mMutex);
+
+    if (const auto it = mDescriptorSetLayouts.find(key.get()); it != std::end(mDescriptorSetLayouts))
+    {
+        mHitCount++;
+        return it->second;
+    }
+
+    const auto createInfo = vk::DescriptorSetLayoutCreateInfo()
+        .setBindingCount(static_cast<uint32_t>(bindings.size()))
+        .setPBindings(bindings.data());
+
+    vk::DescriptorSetLayout setLayout;
+    VK_CHECK(setLayout = mDevice.createDescriptorSetLayout(createInfo););
+
+    mDescriptorSetLayouts.emplace(key.get(), setLayout);
+    return setLayout;
+}
+
+vk::PipelineLayout VulkanLayoutCache::getPipelineLayout(const std::span<const vk::DescriptorSetLayout> setLayouts,
+                                                        const std::span<const vk::PushConstantRange> pushConstantRanges)
+{
+    // Set layouts are deduplicated already, their handles identify them
+    VulkanStateKey key;
+    key.add(setLayouts.size());
+    for (const auto& setLayout : setLayouts)
+    {
+        key.add(static_cast<VkDescriptorSetLayout>(setLayout));
+    }
+    for (const auto& range : pushConstantRanges)
+    {
+        key.add(range.stageFlags).add(range.offset).add(range.size);
+    }
+
+    std::lock_guard lock(mMutex);
+
+    if (const auto it = mPipelineLayouts.find(key.get()); it != std::end(mPipelineLayouts))
+    {
+        mHitCount++;
+        return it->second;
+    }
+
+    const auto createInfo = vk::PipelineLayoutCreateInfo()
+        .setSetLayoutCount(static_cast<uint32_t>(setLayouts.size()))
+        .setPSetLayouts(setLayouts.data())
+        .setPushConstantRangeCount(static_cast<uint32_t>(pushConstantRanges.size()))
+        .setPPushConstantRanges(pushConstantRanges.data());
+
+    vk::PipelineLayout pipelineLayout;
+    VK_CHECK(pipelineLayout = mDevice.createPipelineLayout(createInfo););
+
+    mPipelineLayouts.emplace(key.get(), pipelineLayout);
+    return pipelineLayout;
+}
+
+VulkanLayoutCacheStatistics VulkanLayoutCache::getStatistics()
+{
+    std::lock_guard lock(mMutex);
+    return {
+        .descriptorSetLayoutCount = static_cast<uint32_t>(mDescriptorSetLayouts.size()),
+        .pipelineLayoutCount      = static_cast<uint32_t>(mPipelineLayouts.size()),
+        .hitCount                 = mHitCount,
+    };
+}
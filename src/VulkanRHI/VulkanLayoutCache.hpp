@@ -0,0 +1,43 @@
+#pragma once
+
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include "VulkanBase.hpp"
+
+struct VulkanLayoutCacheStatistics
+{
+    uint32_t descriptorSetLayoutCount {0};
+    uint32_t pipelineLayoutCount      {0};
+    // Requests served by an existing layout
+    uint32_t hitCount                 {0};
+};
+
+/**
+ * Descriptor set layouts and pipeline layouts deduplicated by content.
+ * Layouts are few and small, so they are kept until the device is destroyed and shared handles never dangle.
+ */
+class VulkanLayoutCache
+{
+public:
+    DISABLE_COPY_CTOR(VulkanLayoutCache);
+    explicit DEF_PRIMARY_CTOR(VulkanLayoutCache, vk::Device device);
+
+    ~VulkanLayoutCache();
+
+    // Bindings must be sorted by binding index. Thread safe.
+    vk::DescriptorSetLayout getDescriptorSetLayout(std::span<const vk::DescriptorSetLayoutBinding> bindings);
+
+    // Thread safe
+    vk::PipelineLayout      getPipelineLayout(std::span<const vk::DescriptorSetLayout> setLayouts, std::span<const vk::PushConstantRange> pushConstantRanges);
+
+    VulkanLayoutCacheStatistics getStatistics();
+
+private:
+    std::unordered_map<std::string, vk::DescriptorSetLayout> mDescriptorSetLayouts;
+    std::unordered_map<std::string, vk::PipelineLayout>      mPipelineLayouts;
+    std::mutex                                               mMutex;
+    uint32_t                                                 mHitCount {0};
+
+    vk::Device                                               mDevice;
+};
@@ -0,0 +1,112 @@
+#include "VulkanParallelRecorder.hpp"
+
+#include <chrono>
+
+VulkanParallelRecorder::VulkanParallelRecorder(const VulkanParallelRecorderCreateInfo& createInfo)
+: mTaskPool(createInfo.pTaskPool)
+, mDevice(createInfo.pDevice)
+{
+    const auto poolCreateInfo = vk::CommandPoolCreateInfo()
+        .setQueueFamilyIndex(createInfo.pQueue->getQueueFamilyIndex())
+        .setFlags(vk::CommandPoolCreateFlagBits::eTransient);
+
+    mFramePools.resize(createInfo.framesInFlight);
+    for (auto& threadPools : mFramePools)
+    {
+        threadPools.resize(mTaskPool->getSlotCount());
+        for (auto& threadPool : threadPools)
+        {
+            VK_CHECK(threadPool.commandPool = mDevice->handle().createCommandPool(poolCreateInfo););
+        }
+    }
+
+    mStatistics.threadCount = mTaskPool->getSlotCount();
+}
+
+std::unique_ptr<VulkanParallelRecorder> VulkanParallelRecorder::createVulkanParallelRecorder(const VulkanParallelRecorderCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanParallelRecorder>(createInfo);
+}
+
+VulkanParallelRecorder::~VulkanParallelRecorder()
+{
+    for (const auto& threadPools : mFramePools)
+    {
+        for (const auto& threadPool : threadPools)
+        {
+            mDevice->handle().destroyCommandPool(threadPool.commandPool);
+        }
+    }
+}
+
+void VulkanParallelRecorder::beginFrame(const uint32_t frameIndex)
+{
+    std::lock_guard lock(mRecordMutex);
+    mCurrentFrame = frameIndex;
+
+    for (auto& threadPool : mFramePools[frameIndex])
+    {
+        if (threadPool.usedCount == 0)
+        {
+            continue;
+        }
+
+        mDevice->handle().resetCommandPool(threadPool.commandPool);
+        threadPool.usedCount = 0;
+    }
+}
+
+std::vector<vk::CommandBuffer> VulkanParallelRecorder::record(const vk::CommandBufferInheritanceInfo& inheritanceInfo, const uint32_t taskCount,
+                                                              const std::function<void(RHICommandList*, uint32_t)>& lambda)
+{
+    std::lock_guard lock(mRecordMutex);
+
+    const auto recordBegin = std::chrono::steady_clock::now();
+
+    std::vector<vk::CommandBuffer> commandBuffers(taskCount);
+    auto& threadPools = mFramePools[mCurrentFrame];
+
+    const auto beginInfo = vk::CommandBufferBeginInfo()
+        .setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue)
+        .setPInheritanceInfo(&inheritanceInfo);
+
+    mTaskPool->parallelFor(taskCount, [&](const uint32_t taskIndex, const uint32_t slotIndex) {
+        const vk::CommandBuffer commandBuffer = acquireCommandBuffer(threadPools[slotIndex]);
+
+        VK_CHECK(commandBuffer.begin(beginInfo););
+
+        VulkanCommandList commandList({
+            .commandBuffer = commandBuffer,
+            .id            = taskIndex,
+        });
+        lambda(&commandList, taskIndex);
+
+        commandBuffer.end();
+        commandBuffers[taskIndex] = commandBuffer;
+    });
+
+    const double recordTime = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recordBegin).count();
+    mStatistics.passCount++;
+    mStatistics.commandBufferCount += taskCount;
+    mStatistics.lastRecordTime      = recordTime;
+    mStatistics.totalRecordTime    += recordTime;
+
+    return commandBuffers;
+}
+
+vk::CommandBuffer VulkanParallelRecorder::acquireCommandBuffer(ThreadCommandPool& threadPool) const
+{
+    if (threadPool.usedCount == threadPool.commandBuffers.size())
+    {
+        const auto allocateInfo = vk::CommandBufferAllocateInfo()
+            .setCommandPool(threadPool.commandPool)
+            .setCommandBufferCount(1)
+            .setLevel(vk::CommandBufferLevel::eSecondary);
+
+        std::vector<vk::CommandBuffer> commandBuffers;
+        VK_CHECK(commandBuffers = mDevice->handle().allocateCommandBuffers(allocateInfo););
+        threadPool.commandBuffers.push_back(commandBuffers[0]);
+    }
+
+    return threadPool.commandBuffers[threadPool.usedCount++];
+}
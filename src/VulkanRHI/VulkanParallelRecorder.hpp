@@ -0,0 +1,71 @@
+#pragma once
+
+#include "VulkanBase.hpp"
+#include "VulkanCommandQueue.hpp"
+#include "VulkanDevice.hpp"
+#include "RHI/TaskPool.hpp"
+
+struct VulkanParallelRecorderCreateInfo
+{
+    uint32_t             framesInFlight {2};
+    TaskPool*            pTaskPool      {nullptr};
+    VulkanCommandQueue*  pQueue         {nullptr};
+    VulkanDevice*        pDevice        {nullptr};
+};
+
+struct VulkanParallelRecordingStatistics
+{
+    uint32_t threadCount        {1};
+    uint64_t passCount          {0};
+    uint64_t commandBufferCount {0};
+    // Milliseconds of wall-clock time spent recording secondary command buffers
+    double   lastRecordTime     {0.0};
+    double   totalRecordTime    {0.0};
+};
+
+/**
+ * Records secondary command buffers on the threads of a TaskPool.
+ * Every thread slot owns one command pool per frame in flight, so recording never synchronizes between threads
+ * and a frame's pools are reset as a whole once its fence has signaled.
+ * Threads outside the TaskPool share one slot, so calls to record() are serialized. Tasks must not record
+ * another parallel pass themselves.
+ */
+class VulkanParallelRecorder
+{
+public:
+    DISABLE_COPY_CTOR(VulkanParallelRecorder);
+    explicit DEF_PRIMARY_CTOR(VulkanParallelRecorder, const VulkanParallelRecorderCreateInfo& createInfo);
+
+    ~VulkanParallelRecorder();
+
+    // Recycles the command buffers recorded for the frame slot, its fence must have signaled
+    void beginFrame(uint32_t frameIndex);
+
+    // Records one secondary command buffer per task within the inherited render pass, returned in task order
+    std::vector<vk::CommandBuffer> record(const vk::CommandBufferInheritanceInfo& inheritanceInfo, uint32_t taskCount,
+                                          const std::function<void(RHICommandList*, uint32_t)>& lambda);
+
+    const VulkanParallelRecordingStatistics& getStatistics() const { return mStatistics; }
+
+private:
+    struct ThreadCommandPool
+    {
+        vk::CommandPool                commandPool;
+        std::vector<vk::CommandBuffer> commandBuffers;
+        // Command buffers handed out since the last reset, the rest are reused before allocating more
+        uint32_t                       usedCount {0};
+    };
+
+    vk::CommandBuffer acquireCommandBuffer(ThreadCommandPool& threadPool) const;
+
+    // Indexed by frame in flight, then by TaskPool slot
+    std::vector<std::vector<ThreadCommandPool>> mFramePools;
+    uint32_t                                    mCurrentFrame {0};
+    // Serializes record() calls from different threads, which would share the outside slot and the statistics
+    std::mutex                                  mRecordMutex;
+
+    VulkanParallelRecordingStatistics           mStatistics;
+
+    TaskPool*                                   mTaskPool;
+    VulkanDevice*                               mDevice;
+};
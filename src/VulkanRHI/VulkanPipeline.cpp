@@ -1,7 +1,5 @@
 #include "VulkanPipeline.hpp"
 
-#include <fstream>
-
 VulkanPipeline::VulkanPipeline(VulkanPipelineCreateInfo& createInfo)
 : mBindPoint(toBindPoint(createInfo.pipelineType)), mPipelineType(createInfo.pipelineType)
 , mDevice(createInfo.pDevice), mName(createInfo.debugName)
@@ -11,69 +9,46 @@ VulkanPipeline::VulkanPipeline(VulkanPipelineCreateInfo& createInfo)
         throw std::runtime_error(fmt::format("Can't create Pipeline with no shaders specified"));
     }
 
-    auto& graphicsPipelineState = createInfo.graphicsPipelineState;
-    graphicsPipelineState.update();
-
-    const auto layoutCreateInfo = vk::PipelineLayoutCreateInfo()
-        .setSetLayoutCount(createInfo.descriptorSetLayouts.size())
-        .setPSetLayouts(createInfo.descriptorSetLayouts.data())
-        .setPushConstantRangeCount(createInfo.pushConstantRanges.size())
-        .setPPushConstantRanges(createInfo.pushConstantRanges.data());
+    if (mPipelineType == PipelineType::Compute
+        and (createInfo.shaderCreateInfos.size() != 1 or createInfo.shaderCreateInfos[0].shaderStage != vk::ShaderStageFlagBits::eCompute))
+    {
+        throw std::runtime_error(fmt::format("Compute Pipeline {} must be created from a single compute shader", mName ? mName : "Unknown"));
+    }
 
-    std::vector<vk::ShaderModule> shaders(createInfo.shaderCreateInfos.size());
+    mShaderModules.resize(createInfo.shaderCreateInfos.size());
     std::vector<vk::PipelineShaderStageCreateInfo> shaderStageInfos(createInfo.shaderCreateInfos.size());
 
     try
     {
-        mPipelineLayout = mDevice->handle().createPipelineLayout(layoutCreateInfo);
-        mDevice->nameObject<vk::PipelineLayout>({
-            .debugName = createInfo.debugName,
-            .handle = mPipelineLayout,
-        });
-
         for (size_t index = 0; index < createInfo.shaderCreateInfos.size(); index++)
         {
             const auto& shaderInfo = createInfo.shaderCreateInfos[index];
 
-            const auto shaderSrc = readShaderFile(shaderInfo.filePath);
-            auto shaderModuleCreateInfo = vk::ShaderModuleCreateInfo()
-                .setCodeSize(sizeof(char) * shaderSrc.size())
-                .setPCode(reinterpret_cast<const uint32_t*>(shaderSrc.data()));
-
-            shaders[index] = mDevice->handle().createShaderModule(shaderModuleCreateInfo);
-            mDevice->nameObject<vk::ShaderModule>({
-                .debugName = shaderInfo.filePath,
-                .handle = shaders[index],
-            });
+            mShaderModules[index] = mDevice->getShaderModuleCache()->getOrCreate(shaderInfo.filePath);
 
             shaderStageInfos[index] = vk::PipelineShaderStageCreateInfo()
                 .setStage(shaderInfo.shaderStage)
-                .setModule(shaders[index])
+                .setModule(mShaderModules[index]->handle())
                 .setPName(shaderInfo.entryPoint);
         }
+
+        // Whatever the create info leaves out is derived from the shaders
+        mDescriptorSetLayouts = createInfo.descriptorSetLayouts.empty() ? reflectDescriptorSetLayouts() : createInfo.descriptorSetLayouts;
+        mPushConstantRanges   = createInfo.pushConstantRanges.empty()   ? reflectPushConstantRanges()   : createInfo.pushConstantRanges;
+        mPipelineLayout       = mDevice->getLayoutCache()->getPipelineLayout(mDescriptorSetLayouts, mPushConstantRanges);
     } catch (const vk::SystemError& error) {
         fmt::println("Failed to create PipelineLayout: {}", error.what());
         throw;
     }
 
-    const auto graphicsPipelineCreateInfo = vk::GraphicsPipelineCreateInfo()
-            .setPInputAssemblyState(&graphicsPipelineState.inputAssemblyState)
-            .setPRasterizationState(&graphicsPipelineState.rasterizationState)
-            .setPMultisampleState(&graphicsPipelineState.multisampleState)
-            .setPDepthStencilState(&graphicsPipelineState.depthStencilState)
-            .setPViewportState(&graphicsPipelineState.viewportState)
-            .setPDynamicState(&graphicsPipelineState.dynamicState)
-            .setPColorBlendState(&graphicsPipelineState.colorBlendState)
-            .setPVertexInputState(&graphicsPipelineState.vertexInputState)
-            .setStageCount(shaderStageInfos.size())
-            .setPStages(shaderStageInfos.data())
-            .setLayout(mPipelineLayout)
-            .setRenderPass(createInfo.renderPass)
-            .setPNext(nullptr);
+    vk::PipelineCreationFeedback creationFeedback;
 
     try
     {
-        mPipeline = mDevice->handle().createGraphicsPipeline(nullptr, graphicsPipelineCreateInfo).value;
+        mPipeline = (mPipelineType == PipelineType::Compute)
+            ? createComputePipeline(shaderStageInfos[0], creationFeedback)
+            : createGraphicsPipeline(createInfo, shaderStageInfos, creationFeedback);
+        mDevice->getPipelineCache()->recordFeedback(creationFeedback);
         mDevice->nameObject<vk::Pipeline>({
             .debugName = createInfo.debugName,
             .handle = mPipeline,
@@ -92,37 +67,161 @@ std::unique_ptr<VulkanPipeline> VulkanPipeline::createVulkanPipeline(VulkanPipel
 VulkanPipeline::~VulkanPipeline()
 {
     mDevice->handle().destroyPipeline(mPipeline);
-    mDevice->handle().destroyPipelineLayout(mPipelineLayout);
 }
 
-vk::PipelineBindPoint VulkanPipeline::toBindPoint(const PipelineType type)
+vk::Pipeline VulkanPipeline::createGraphicsPipeline(VulkanPipelineCreateInfo& createInfo,
+                                                    const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos,
+                                                    vk::PipelineCreationFeedback& creationFeedback) const
 {
-    using enum PipelineType;
-    switch (type)
+    auto& graphicsPipelineState = createInfo.graphicsPipelineState;
+    if (graphicsPipelineState.attributeDescriptions.empty() and graphicsPipelineState.bindingDescriptions.empty())
     {
-        case Compute:    return vk::PipelineBindPoint::eCompute;
-        case Graphics:   return vk::PipelineBindPoint::eGraphics;
-        case RayTracing: return vk::PipelineBindPoint::eRayTracingKHR;
+        reflectVertexInput(graphicsPipelineState, shaderStageInfos);
     }
-    throw std::runtime_error("");
+    graphicsPipelineState.update();
+
+    auto graphicsPipelineCreateInfo = vk::GraphicsPipelineCreateInfo()
+            .setPInputAssemblyState(&graphicsPipelineState.inputAssemblyState)
+            .setPRasterizationState(&graphicsPipelineState.rasterizationState)
+            .setPMultisampleState(&graphicsPipelineState.multisampleState)
+            .setPDepthStencilState(&graphicsPipelineState.depthStencilState)
+            .setPViewportState(&graphicsPipelineState.viewportState)
+            .setPDynamicState(&graphicsPipelineState.dynamicState)
+            .setPColorBlendState(&graphicsPipelineState.colorBlendState)
+            .setPVertexInputState(&graphicsPipelineState.vertexInputState)
+            .setStageCount(shaderStageInfos.size())
+            .setPStages(shaderStageInfos.data())
+            .setLayout(mPipelineLayout)
+            .setRenderPass(createInfo.renderPass)
+            .setPNext(nullptr);
+
+    // Creation feedback is core since Vulkan 1.3, it tells whether the pipeline cache served the pipeline
+    #ifndef __APPLE__
+    auto creationFeedbackInfo = vk::PipelineCreationFeedbackCreateInfo()
+        .setPPipelineCreationFeedback(&creationFeedback);
+    addToPNext(graphicsPipelineCreateInfo, creationFeedbackInfo);
+    #endif
+
+    return mDevice->handle().createGraphicsPipeline(mDevice->getPipelineCache()->handle(), graphicsPipelineCreateInfo).value;
 }
 
-std::vector<char> VulkanPipeline::readShaderFile(const char* filePath)
+vk::Pipeline VulkanPipeline::createComputePipeline(const vk::PipelineShaderStageCreateInfo& shaderStageInfo,
+                                                   vk::PipelineCreationFeedback& creationFeedback) const
 {
-    std::ifstream file(filePath, std::ios::ate | std::ios::binary);
+    auto computePipelineCreateInfo = vk::ComputePipelineCreateInfo()
+        .setStage(shaderStageInfo)
+        .setLayout(mPipelineLayout)
+        .setPNext(nullptr);
+
+    #ifndef __APPLE__
+    auto creationFeedbackInfo = vk::PipelineCreationFeedbackCreateInfo()
+        .setPPipelineCreationFeedback(&creationFeedback);
+    addToPNext(computePipelineCreateInfo, creationFeedbackInfo);
+    #endif
+
+    return mDevice->handle().createComputePipeline(mDevice->getPipelineCache()->handle(), computePipelineCreateInfo).value;
+}
 
-    if (!file.is_open())
+std::vector<vk::DescriptorSetLayout> VulkanPipeline::reflectDescriptorSetLayouts() const
+{
+    // Indexed by set, bindings used by several stages are merged
+    std::vector<std::vector<vk::DescriptorSetLayoutBinding>> sets;
+    for (const auto& module : mShaderModules)
     {
-        throw std::runtime_error(fmt::format("Failed to open file: {}!", filePath));
+        for (const auto& [set, binding] : module->getReflection().descriptorBindings)
+        {
+            if (binding.descriptorCount == 0)
+            {
+                throw std::runtime_error(fmt::format("Pipeline {} uses a runtime sized descriptor array, its layouts must be given explicitly", mName ? mName : "Unknown"));
+            }
+
+            if (set >= sets.size())
+            {
+                sets.resize(set + 1);
+            }
+
+            auto& bindings = sets[set];
+            const auto existing = std::ranges::find(bindings, binding.binding, &vk::DescriptorSetLayoutBinding::binding);
+            if (existing == std::end(bindings))
+            {
+                bindings.push_back(binding);
+                continue;
+            }
+            if (existing->descriptorType != binding.descriptorType)
+            {
+                throw std::runtime_error(fmt::format("Shaders of pipeline {} disagree on the type of set {} binding {}", mName ? mName : "Unknown", set, binding.binding));
+            }
+            existing->stageFlags     |= binding.stageFlags;
+            existing->descriptorCount = std::max(existing->descriptorCount, binding.descriptorCount);
+        }
     }
 
-    const size_t fileSize = file.tellg();
-    std::vector<char> buffer(fileSize);
+    // Unused set indices below the highest one get empty layouts
+    std::vector<vk::DescriptorSetLayout> setLayouts;
+    for (auto& bindings : sets)
+    {
+        std::ranges::sort(bindings, {}, &vk::DescriptorSetLayoutBinding::binding);
+        setLayouts.push_back(mDevice->getLayoutCache()->getDescriptorSetLayout(bindings));
+    }
+    return setLayouts;
+}
 
-    file.seekg(0);
-    file.read(buffer.data(), fileSize);
+std::vector<vk::PushConstantRange> VulkanPipeline::reflectPushConstantRanges() const
+{
+    // One range per stage, ranges of different stages may overlap
+    std::vector<vk::PushConstantRange> ranges;
+    for (const auto& module : mShaderModules)
+    {
+        if (const auto& range = module->getReflection().pushConstantRange; range.has_value())
+        {
+            ranges.push_back(range.value());
+        }
+    }
+    return ranges;
+}
 
-    file.close();
-    return buffer;
+void VulkanPipeline::reflectVertexInput(VulkanGraphicsPipelineStateInfo& graphicsPipelineState,
+                                        const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos) const
+{
+    // Looked up by the declared stage, so only the vertex shader has to be reflectable
+    const auto vertexStage = std::ranges::find(shaderStageInfos, vk::ShaderStageFlagBits::eVertex, &vk::PipelineShaderStageCreateInfo::stage);
+    if (vertexStage == std::end(shaderStageInfos))
+    {
+        return;
+    }
+
+    const auto& vertexInputs = mShaderModules[std::distance(std::begin(shaderStageInfos), vertexStage)]->getReflection().vertexInputs;
+    if (vertexInputs.empty())
+    {
+        return;
+    }
+
+    // Attributes are packed into a single per-vertex binding in location order
+    uint32_t offset = 0;
+    for (const auto& input : vertexInputs)
+    {
+        graphicsPipelineState.attributeDescriptions.push_back(vk::VertexInputAttributeDescription()
+            .setBinding(0)
+            .setLocation(input.location)
+            .setFormat(input.format)
+            .setOffset(offset));
+        offset += input.size;
+    }
+
+    graphicsPipelineState.bindingDescriptions.push_back(vk::VertexInputBindingDescription()
+        .setBinding(0)
+        .setStride(offset)
+        .setInputRate(vk::VertexInputRate::eVertex));
 }
 
+vk::PipelineBindPoint VulkanPipeline::toBindPoint(const PipelineType type)
+{
+    using enum PipelineType;
+    switch (type)
+    {
+        case Compute:    return vk::PipelineBindPoint::eCompute;
+        case Graphics:   return vk::PipelineBindPoint::eGraphics;
+        case RayTracing: return vk::PipelineBindPoint::eRayTracingKHR;
+    }
+    throw std::runtime_error("");
+}
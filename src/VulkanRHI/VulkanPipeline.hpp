@@ -1,5 +1,6 @@
 #pragma once
 
+#include "RHI/RHICommandStream.hpp"
 #include "RHI/RHIPipeline.hpp"
 #include "VulkanBase.hpp"
 #include "VulkanDevice.hpp"
@@ -177,6 +178,18 @@ struct VulkanGraphicsPipelineStateInfo
         return *this;
     }
 
+    VulkanGraphicsPipelineStateInfo& setPolygonMode(const vk::PolygonMode polygonMode)
+    {
+        rasterizationState.setPolygonMode(polygonMode);
+        return *this;
+    }
+
+    VulkanGraphicsPipelineStateInfo& setDepthTest(const bool value = true)
+    {
+        depthStencilState.setDepthTestEnable(value).setDepthWriteEnable(value);
+        return *this;
+    }
+
     VulkanGraphicsPipelineStateInfo& setWireframeMode(bool value = true)
     {
         rasterizationState.setPolygonMode(value ? vk::PolygonMode::eFill : vk::PolygonMode::eLine);
@@ -184,6 +197,7 @@ struct VulkanGraphicsPipelineStateInfo
     }
 };
 
+// Empty layouts, push constant ranges and vertex inputs are derived from SPIR-V reflection of the shaders
 struct VulkanPipelineCreateInfo
 {
     std::vector<vk::PushConstantRange>   pushConstantRanges;
@@ -191,6 +205,7 @@ struct VulkanPipelineCreateInfo
     std::vector<VulkanShaderCreateInfo>  shaderCreateInfos;
 
     PipelineType                         pipelineType {PipelineType::Graphics};
+    // Graphics pipelines only, compute pipelines take a single compute shader and ignore the graphics state
     vk::RenderPass                       renderPass;
     VulkanGraphicsPipelineStateInfo      graphicsPipelineState;
 
@@ -208,11 +223,20 @@ public:
 
     void bind(RHICommandList* commandList) override
     {
-        commandList->as<VulkanCommandList>()->handle().bindPipeline(mBindPoint, mPipeline);
+        if (commandList->as<RHICommandStream>())
+        {
+            commandList->bindPipeline(this);
+            return;
+        }
+        VulkanCommandList::fromRHI(commandList, "VulkanPipeline::bind()")->bindPipeline(this);
     }
 
-    const vk::Pipeline&       handle() const { return mPipeline; }
-    const vk::PipelineLayout& layout() const { return mPipelineLayout; }
+    const vk::Pipeline&       handle()    const { return mPipeline; }
+    const vk::PipelineLayout& layout()    const { return mPipelineLayout; }
+    vk::PipelineBindPoint     bindPoint() const { return mBindPoint; }
+
+    const std::vector<vk::PushConstantRange>&   getPushConstantRanges()   const { return mPushConstantRanges; }
+    const std::vector<vk::DescriptorSetLayout>& getDescriptorSetLayouts() const { return mDescriptorSetLayouts; }
 
     static std::unique_ptr<VulkanPipeline> createTestPipeline(VulkanDevice* pDevice, RHIRenderPass* renderPass)
     {
@@ -245,12 +269,27 @@ public:
 private:
     static vk::PipelineBindPoint toBindPoint(PipelineType type);
 
-    static std::vector<char> readShaderFile(const char* filePath);
+    vk::Pipeline createGraphicsPipeline(VulkanPipelineCreateInfo& createInfo, const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos,
+                                        vk::PipelineCreationFeedback& creationFeedback) const;
+    vk::Pipeline createComputePipeline(const vk::PipelineShaderStageCreateInfo& shaderStageInfo, vk::PipelineCreationFeedback& creationFeedback) const;
+
+    // Derive the layout and vertex input from the reflection of the shader modules
+    std::vector<vk::DescriptorSetLayout> reflectDescriptorSetLayouts() const;
+    std::vector<vk::PushConstantRange>   reflectPushConstantRanges() const;
+    void                                 reflectVertexInput(VulkanGraphicsPipelineStateInfo& graphicsPipelineState,
+                                                            const std::vector<vk::PipelineShaderStageCreateInfo>& shaderStageInfos) const;
 
     vk::Pipeline          mPipeline;
+    // Owned by the device's layout cache
     vk::PipelineLayout    mPipelineLayout;
     vk::PipelineBindPoint mBindPoint;
 
+    std::vector<vk::PushConstantRange>   mPushConstantRanges;
+    std::vector<vk::DescriptorSetLayout> mDescriptorSetLayouts;
+
+    // Kept alive for pipelines created later from the same files
+    std::vector<std::shared_ptr<VulkanShaderModule>> mShaderModules;
+
     PipelineType          mPipelineType;
 
     VulkanDevice*         mDevice;
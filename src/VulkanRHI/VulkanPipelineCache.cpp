@@ -0,0 +1,212 @@
+#include "VulkanPipelineCache.hpp"
+
+#include <cstring>
+#include <fstream>
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    // Flushes the file's contents to the storage device, so a rename never exposes a file whose data is still in flight
+    bool syncFile(const std::filesystem::path& path)
+    {
+        #ifdef _WIN32
+            const HANDLE file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+            const bool flushed = FlushFileBuffers(file) != 0;
+            CloseHandle(file);
+            return flushed;
+        #else
+            const int fd = open(path.c_str(), O_WRONLY);
+            if (fd < 0)
+            {
+                return false;
+            }
+            const bool flushed = fsync(fd) == 0;
+            close(fd);
+            return flushed;
+        #endif
+    }
+}
+
+VulkanPipelineCache::VulkanPipelineCache(const VulkanPipelineCacheCreateInfo& createInfo)
+: mProperties(createInfo.properties)
+, mFilePath(createInfo.filePath)
+, mDevice(createInfo.device)
+{
+    const std::vector<std::byte> initialData = loadFile();
+    mLoadedBytes = initialData.size();
+
+    const auto cacheCreateInfo = vk::PipelineCacheCreateInfo()
+        .setInitialDataSize(initialData.size())
+        .setPInitialData(initialData.data());
+
+    VK_CHECK(mPipelineCache = mDevice.createPipelineCache(cacheCreateInfo););
+
+    VK_VERBOSE(mLoadedBytes > 0
+        ? fmt::format("Loaded {} bytes of pipeline cache from {}", mLoadedBytes, mFilePath.string())
+        : fmt::format("No usable pipeline cache at {}, starting cold", mFilePath.string()));
+}
+
+std::unique_ptr<VulkanPipelineCache> VulkanPipelineCache::createVulkanPipelineCache(const VulkanPipelineCacheCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanPipelineCache>(createInfo);
+}
+
+VulkanPipelineCache::~VulkanPipelineCache()
+{
+    const auto statistics = getStatistics();
+    if (statistics.hitCount + statistics.missCount > 0)
+    {
+        VK_PRINTLN(fmt::format("Pipeline cache: {} hit(s), {} miss(es), {:.1f}% hit rate",
+            statistics.hitCount, statistics.missCount, statistics.getHitRate() * 100.0));
+    }
+
+    // A failed save only costs a cold start next time, it must not escape the destructor
+    try
+    {
+        save();
+    }
+    catch (const std::exception& exception)
+    {
+        VK_DEBUG(fmt::format("Failed to save pipeline cache to {}: {}", mFilePath.string(), exception.what()));
+    }
+    mDevice.destroyPipelineCache(mPipelineCache);
+}
+
+bool VulkanPipelineCache::save() const
+{
+    std::vector<uint8_t> data;
+    VK_CHECK(data = mDevice.getPipelineCacheData(mPipelineCache););
+
+    const FileHeader fileHeader = {
+        .magic         = sMagic,
+        .driverVersion = mProperties.driverVersion,
+        .dataSize      = data.size(),
+    };
+
+    auto tempPath = mFilePath;
+    tempPath += ".tmp";
+
+    std::ofstream file(tempPath, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char*>(&fileHeader), sizeof(FileHeader));
+    file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    // Buffered bytes are only written by flush and close, either may still fail
+    file.close();
+    if (file.fail() or !syncFile(tempPath))
+    {
+        VK_DEBUG(fmt::format("Failed to write pipeline cache to {}", tempPath.string()));
+        std::error_code error;
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    // Replaces the previous cache in one step, readers see either the old or the new file
+    std::error_code error;
+    std::filesystem::rename(tempPath, mFilePath, error);
+    if (error)
+    {
+        VK_DEBUG(fmt::format("Failed to replace pipeline cache {}: {}", mFilePath.string(), error.message()));
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+
+    VK_VERBOSE(fmt::format("Saved {} bytes of pipeline cache to {}", data.size(), mFilePath.string()));
+    return true;
+}
+
+void VulkanPipelineCache::recordFeedback(const vk::PipelineCreationFeedback& feedback)
+{
+    if (!(feedback.flags & vk::PipelineCreationFeedbackFlagBits::eValid))
+    {
+        return;
+    }
+
+    if (feedback.flags & vk::PipelineCreationFeedbackFlagBits::eApplicationPipelineCacheHit)
+    {
+        mHitCount++;
+    }
+    else
+    {
+        mMissCount++;
+    }
+}
+
+VulkanPipelineCacheStatistics VulkanPipelineCache::getStatistics() const
+{
+    return {
+        .loadedBytes = mLoadedBytes,
+        .hitCount    = mHitCount.load(),
+        .missCount   = mMissCount.load(),
+    };
+}
+
+std::vector<std::byte> VulkanPipelineCache::loadFile() const
+{
+    std::ifstream file(mFilePath, std::ios::ate | std::ios::binary);
+    if (!file.is_open())
+    {
+        return {};
+    }
+
+    const auto fileSize = static_cast<size_t>(file.tellg());
+    if (fileSize < sizeof(FileHeader))
+    {
+        return {};
+    }
+
+    FileHeader fileHeader;
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(&fileHeader), sizeof(FileHeader));
+
+    if (fileHeader.dataSize != fileSize - sizeof(FileHeader))
+    {
+        VK_DEBUG(fmt::format("Discarding truncated pipeline cache {}", mFilePath.string()));
+        return {};
+    }
+
+    std::vector<std::byte> data(fileHeader.dataSize);
+    file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+
+    if (!file.good() or !isCompatible(fileHeader, data))
+    {
+        VK_DEBUG(fmt::format("Discarding pipeline cache {} written for another device or driver", mFilePath.string()));
+        return {};
+    }
+
+    return data;
+}
+
+bool VulkanPipelineCache::isCompatible(const FileHeader& fileHeader, const std::span<const std::byte> data) const
+{
+    if (fileHeader.magic != sMagic or fileHeader.driverVersion != mProperties.driverVersion)
+    {
+        return false;
+    }
+
+    // Drivers are required to reject foreign data, but not all of them do so gracefully
+    VkPipelineCacheHeaderVersionOne cacheHeader;
+    if (data.size() < sizeof(cacheHeader))
+    {
+        return false;
+    }
+    std::memcpy(&cacheHeader, data.data(), sizeof(cacheHeader));
+
+    return cacheHeader.headerSize >= sizeof(cacheHeader)
+       and cacheHeader.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+       and cacheHeader.vendorID == mProperties.vendorID
+       and cacheHeader.deviceID == mProperties.deviceID
+       and std::memcmp(cacheHeader.pipelineCacheUUID, mProperties.pipelineCacheUUID.data(), VK_UUID_SIZE) == 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <span>
+#include "VulkanBase.hpp"
+
+struct VulkanPipelineCacheCreateInfo
+{
+    vk::Device                   device;
+    vk::PhysicalDeviceProperties properties;
+    // Loaded if present and written by save()
+    std::filesystem::path        filePath;
+};
+
+struct VulkanPipelineCacheStatistics
+{
+    // Bytes of cache data accepted from disk, zero on a cold start
+    uint64_t loadedBytes {0};
+    // Pipeline creations served from the cache and those compiled from scratch, as reported by creation feedback
+    uint32_t hitCount    {0};
+    uint32_t missCount   {0};
+
+    double getHitRate() const
+    {
+        const uint32_t total = hitCount + missCount;
+        return (total > 0) ? static_cast<double>(hitCount) / total : 0.0;
+    }
+};
+
+/**
+ * VkPipelineCache persisted across runs.
+ * Cache files are only handed to the driver if they were written by the same driver version for the same device,
+ * anything else is discarded and the cache starts out empty. The file is rewritten on destruction, through a temporary
+ * file and a rename so an interrupted write never leaves a truncated cache behind.
+ */
+class VulkanPipelineCache
+{
+public:
+    DISABLE_COPY_CTOR(VulkanPipelineCache);
+    explicit DEF_PRIMARY_CTOR(VulkanPipelineCache, const VulkanPipelineCacheCreateInfo& createInfo);
+
+    ~VulkanPipelineCache();
+
+    // Writes the current cache contents to disk, returns false if the file couldn't be written
+    bool save() const;
+
+    // Counts a pipeline creation as a hit or a miss, may be called from any thread
+    void recordFeedback(const vk::PipelineCreationFeedback& feedback);
+
+    VulkanPipelineCacheStatistics getStatistics() const;
+
+    vk::PipelineCache handle() const { return mPipelineCache; }
+
+private:
+    // Prefixed to the driver's data, the driver's own header lacks the driver version
+    struct FileHeader
+    {
+        uint32_t magic;
+        uint32_t driverVersion;
+        uint64_t dataSize;
+    };
+
+    static constexpr uint32_t sMagic = 0x48435052; // "RPCH"
+
+    // Returns the driver data of the file if it was written for this device and driver, empty otherwise
+    std::vector<std::byte> loadFile() const;
+
+    bool isCompatible(const FileHeader& fileHeader, std::span<const std::byte> data) const;
+
+    vk::PipelineCache            mPipelineCache;
+    vk::PhysicalDeviceProperties mProperties;
+    std::filesystem::path        mFilePath;
+
+    uint64_t                     mLoadedBytes {0};
+    std::atomic<uint32_t>        mHitCount    {0};
+    std::atomic<uint32_t>        mMissCount   {0};
+
+    vk::Device                   mDevice;
+};
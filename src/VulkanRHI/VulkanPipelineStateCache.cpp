@@ -0,0 +1,128 @@
+#include "VulkanPipelineStateCache.hpp"
+
+VulkanPipelineStateCache::VulkanPipelineStateCache(VulkanShaderModuleCache* pShaderModuleCache)
+: mShaderModuleCache(pShaderModuleCache)
+{
+}
+
+std::unique_ptr<VulkanPipelineStateCache> VulkanPipelineStateCache::createVulkanPipelineStateCache(VulkanShaderModuleCache* pShaderModuleCache)
+{
+    return std::make_unique<VulkanPipelineStateCache>(pShaderModuleCache);
+}
+
+std::shared_ptr<VulkanPipeline> VulkanPipelineStateCache::getOrCreate(const RHIPipelineCreateInfo& createInfo,
+                                                                      const std::function<std::unique_ptr<VulkanPipeline>()>& create)
+{
+    std::vector<std::shared_ptr<VulkanShaderModule>> shaderModules;
+    for (const auto& shaderInfo : createInfo.shaderCreateInfos)
+    {
+        shaderModules.push_back(mShaderModuleCache->getOrCreate(shaderInfo.filePath));
+    }
+
+    const std::string key = makeKey(createInfo, shaderModules);
+
+    {
+        std::lock_guard lock(mMutex);
+        if (const auto it = mPipelines.find(key); it != std::end(mPipelines))
+        {
+            if (auto pipeline = it->second.lock())
+            {
+                mHitCount++;
+                return pipeline;
+            }
+        }
+        mMissCount++;
+    }
+
+    std::shared_ptr<VulkanPipeline> pipeline = create();
+
+    std::lock_guard lock(mMutex);
+
+    // Another thread may have created the same pipeline meanwhile, its pipeline wins and ours is dropped
+    auto& entry = mPipelines[key];
+    if (auto existing = entry.lock())
+    {
+        return existing;
+    }
+    entry = pipeline;
+
+    std::erase_if(mPipelines, [](const auto& cached) { return cached.second.expired(); });
+    return pipeline;
+}
+
+VulkanPipelineStateCacheStatistics VulkanPipelineStateCache::getStatistics()
+{
+    std::lock_guard lock(mMutex);
+
+    const auto livePipelines = std::ranges::count_if(mPipelines, [](const auto& cached) { return !cached.second.expired(); });
+    return {
+        .hitCount          = mHitCount,
+        .missCount         = mMissCount,
+        .livePipelineCount = static_cast<uint32_t>(livePipelines),
+    };
+}
+
+std::string VulkanPipelineStateCache::makeKey(const RHIPipelineCreateInfo& createInfo,
+                                              const std::span<const std::shared_ptr<VulkanShaderModule>> shaderModules)
+{
+    VulkanStateKey key;
+    key.add(createInfo.pipelineType);
+
+    // Every stage is compiled from the "main" entry point
+    key.add(createInfo.shaderCreateInfos.size());
+    for (const auto& [shaderInfo, shaderModule] : std::views::zip(createInfo.shaderCreateInfos, shaderModules))
+    {
+        key.add(shaderModule->getContentHash()).add(shaderInfo.shaderStage);
+    }
+
+    key.add(createInfo.pushConstantRanges.size());
+    for (const auto& range : createInfo.pushConstantRanges)
+    {
+        key.add(range.stages.size());
+        for (const auto stage : range.stages)
+        {
+            key.add(stage);
+        }
+        key.add(range.offset).add(range.size);
+    }
+
+    const auto& state = createInfo.graphicsPipelineState;
+    key.add(state.cullMode).add(state.polygonMode).add(state.depthTest);
+
+    // D3D12-only members never affect a Vulkan pipeline
+    key.add(state.vertexInputAttributes.size());
+    for (const auto& attribute : state.vertexInputAttributes)
+    {
+        key.add(attribute.location).add(attribute.binding).add(attribute.format).add(attribute.offset);
+    }
+
+    key.add(state.vertexInputBindings.size());
+    for (const auto& binding : state.vertexInputBindings)
+    {
+        key.add(binding.binding).add(binding.stride).add(binding.inputRate);
+    }
+
+    // No attachment states means a single default one, see VulkanRHI::compilePipeline
+    const auto attachmentStates = state.attachmentStates.empty() ? std::vector<AttachmentState>(1) : state.attachmentStates;
+    key.add(attachmentStates.size());
+    for (const auto& attachment : attachmentStates)
+    {
+        key.add(attachment.colorWriteMask.size());
+        for (const auto component : attachment.colorWriteMask)
+        {
+            key.add(component);
+        }
+        key.add(attachment.blendEnable);
+        for (const auto& rule : { attachment.blendColor, attachment.blendAlpha })
+        {
+            key.add(rule.srcBlendFactor).add(rule.dstBlendFactor).add(rule.blendOp);
+        }
+    }
+
+    if (createInfo.renderPass)
+    {
+        key.add(createInfo.renderPass->as<VulkanRenderPass>()->getCompatibilityKey());
+    }
+
+    return key.get();
+}
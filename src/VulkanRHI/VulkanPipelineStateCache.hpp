@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include "VulkanBase.hpp"
+#include "VulkanPipeline.hpp"
+
+struct VulkanPipelineStateCacheStatistics
+{
+    // Requests served by a live pipeline, and those that had to create one
+    uint32_t hitCount          {0};
+    uint32_t missCount         {0};
+    uint32_t livePipelineCount {0};
+
+    double getHitRate() const
+    {
+        const uint32_t total = hitCount + missCount;
+        return (total > 0) ? static_cast<double>(hitCount) / total : 0.0;
+    }
+};
+
+/**
+ * RHIPipeline handed out by VulkanRHI::createPipeline, sharing its pipeline with every identical request.
+ */
+class VulkanSharedPipeline final : public RHIPipeline
+{
+public:
+    explicit VulkanSharedPipeline(std::shared_ptr<VulkanPipeline> pipeline) : mPipeline(std::move(pipeline)) {}
+
+    void bind(RHICommandList* commandList) override { mPipeline->bind(commandList); }
+
+    VulkanPipeline* getPipeline() const { return mPipeline.get(); }
+
+private:
+    std::shared_ptr<VulkanPipeline> mPipeline;
+};
+
+/**
+ * Compilation shared between a TaskPool job and the threads binding the pipeline, whichever comes first runs it.
+ * A thread that needs the pipeline before the job has started compiles it inline instead of waiting on the queue,
+ * so binding from a TaskPool worker cannot deadlock on a job queued behind it.
+ */
+class VulkanPipelineCompilation
+{
+public:
+    explicit VulkanPipelineCompilation(std::function<std::shared_ptr<VulkanPipeline>()> compile) : mCompile(std::move(compile)) {}
+
+    // Compiles the pipeline unless another thread has already started, then waits for it. Rethrows compilation errors.
+    const std::shared_ptr<VulkanPipeline>& get()
+    {
+        std::call_once(mOnce, [this] {
+            try
+            {
+                mPipeline = mCompile();
+            }
+            catch (...)
+            {
+                mError = std::current_exception();
+            }
+            mCompile = nullptr;
+            mReady.store(true, std::memory_order_release);
+        });
+
+        if (mError)
+        {
+            std::rethrow_exception(mError);
+        }
+        return mPipeline;
+    }
+
+    bool isReady() const { return mReady.load(std::memory_order_acquire); }
+
+private:
+    std::function<std::shared_ptr<VulkanPipeline>()> mCompile;
+    std::once_flag                                   mOnce;
+    std::shared_ptr<VulkanPipeline>                  mPipeline;
+    std::exception_ptr                               mError;
+    std::atomic<bool>                                mReady {false};
+};
+
+/**
+ * RHIPipeline handed out by VulkanRHI::createPipelineAsync while its pipeline compiles on the TaskPool.
+ * Binding it before compilation has finished binds the fallback. Without one, the pipeline is compiled on the binding thread
+ * if the TaskPool has not started on it yet, otherwise binding waits for the running compilation.
+ */
+class VulkanAsyncPipeline final : public RHIPipeline
+{
+public:
+    VulkanAsyncPipeline(std::shared_ptr<VulkanPipelineCompilation> compilation, RHIPipeline* fallback)
+    : mCompilation(std::move(compilation)), mFallback(fallback) {}
+
+    void bind(RHICommandList* commandList) override
+    {
+        // Streams record the pipeline itself, so readiness is checked when the stream is executed
+        if (commandList->as<RHICommandStream>())
+        {
+            commandList->bindPipeline(this);
+            return;
+        }
+        if (mFallback and !isReady())
+        {
+            mFallback->bind(commandList);
+            return;
+        }
+        mCompilation->get()->bind(commandList);
+    }
+
+    bool isReady() const override { return mCompilation->isReady(); }
+
+private:
+    std::shared_ptr<VulkanPipelineCompilation> mCompilation;
+    RHIPipeline*                               mFallback;
+};
+
+/**
+ * Deduplicates pipelines by the content of their create info.
+ * Keys cover the shaders' SPIR-V content, push constant ranges, graphics state and the render pass' compatibility,
+ * but not the debug name, so the first request names a shared pipeline. A rewritten shader file yields a new key.
+ * Pipelines are reference counted and destroyed with their last user.
+ */
+class VulkanPipelineStateCache
+{
+public:
+    DISABLE_COPY_CTOR(VulkanPipelineStateCache);
+    explicit DEF_PRIMARY_CTOR(VulkanPipelineStateCache, VulkanShaderModuleCache* pShaderModuleCache);
+
+    // Returns the live pipeline matching the create info, or one made by create. Thread safe, create runs without the lock held.
+    std::shared_ptr<VulkanPipeline> getOrCreate(const RHIPipelineCreateInfo& createInfo,
+                                                const std::function<std::unique_ptr<VulkanPipeline>()>& create);
+
+    VulkanPipelineStateCacheStatistics getStatistics();
+
+private:
+    // Shader modules are resolved by the caller and kept alive until the pipeline was created, so it reuses them
+    static std::string makeKey(const RHIPipelineCreateInfo& createInfo, std::span<const std::shared_ptr<VulkanShaderModule>> shaderModules);
+
+    std::unordered_map<std::string, std::weak_ptr<VulkanPipeline>> mPipelines;
+    std::mutex                                                     mMutex;
+
+    uint32_t                                                       mHitCount  {0};
+    uint32_t                                                       mMissCount {0};
+
+    VulkanShaderModuleCache*                                       mShaderModuleCache;
+};
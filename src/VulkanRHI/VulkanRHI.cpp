@@ -10,7 +10,13 @@ VULKAN_HPP_DEFAULT_DISPATCH_LOADER_DYNAMIC_STORAGE;
 VulkanRHI::VulkanRHI(const VulkanRHICreateInfo& createInfo)
 : DynamicRHI()
 , mWindow(createInfo.pWindow)
+, mFramesInFlight(createInfo.framesInFlight)
 {
+    if (mFramesInFlight == 0)
+    {
+        throw std::runtime_error("At least one frame in flight is required");
+    }
+
     const vk::detail::DynamicLoader dynamicLoader;
     const auto vkGetInstanceProcAddr = dynamicLoader.getProcAddress<PFN_vkGetInstanceProcAddr>("vkGetInstanceProcAddr");
     VULKAN_HPP_DEFAULT_DISPATCHER.init(vkGetInstanceProcAddr);
@@ -30,24 +36,82 @@ VulkanRHI::VulkanRHI(const VulkanRHICreateInfo& createInfo)
         .imageCount = createInfo.backBufferCount,
     });
 
-    vk::Result result;
-    mImageReady.resize(mFramesInFlight);
-    mRenderingFinished.resize(mFramesInFlight);
-    mFrameInFlight.resize(mFramesInFlight);
+    mTransientAllocator = VulkanTransientAllocator::createVulkanTransientAllocator({
+        .bufferSize     = createInfo.transientBufferSize,
+        .framesInFlight = mFramesInFlight,
+        .pDevice        = mDevice.get(),
+    });
+
+    mUploadManager = VulkanUploadManager::createVulkanUploadManager({
+        .stagingSize    = createInfo.uploadStagingSize,
+        .pTransferQueue = mDevice->getTransferQueue(),
+        .pGraphicsQueue = mDevice->getGraphicsQueue(),
+        .pDevice        = mDevice.get(),
+    });
 
+    mAliasingAllocator = VulkanAliasingAllocator::createVulkanAliasingAllocator({
+        .pDevice = mDevice.get(),
+    });
+
+    mPipelineStateCache = VulkanPipelineStateCache::createVulkanPipelineStateCache(mDevice->getShaderModuleCache());
+
+    mDefragmenter = VulkanDefragmenter::createVulkanDefragmenter({
+        .bytesPerFrame  = createInfo.defragmentationBudget,
+        .framesInFlight = mFramesInFlight,
+        .pQueue         = mDevice->getGraphicsQueue(),
+        .pDevice        = mDevice.get(),
+    });
+
+    const uint32_t hardwareThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    mTaskPool = TaskPool::createTaskPool(createInfo.workerThreadCount.value_or(hardwareThreads - 1));
+
+    mParallelRecorder = VulkanParallelRecorder::createVulkanParallelRecorder({
+        .framesInFlight = mFramesInFlight,
+        .pTaskPool      = mTaskPool.get(),
+        .pQueue         = mDevice->getGraphicsQueue(),
+        .pDevice        = mDevice.get(),
+    });
+
+    mFrameFence = VulkanFence::createVulkanFence({
+        .debugName = "Frame Fence",
+        .pDevice   = mDevice.get(),
+    });
+
+    constexpr auto semaphoreCreateInfo = vk::SemaphoreCreateInfo();
+
+    mImageReady.resize(mFramesInFlight);
+    mFrameSlotValues.resize(mFramesInFlight, 0);
     for (uint32_t i = 0; i < mFramesInFlight; i++)
     {
-        auto semaphoreCreateInfo = vk::SemaphoreCreateInfo();
-        auto fenceCreateInfo = vk::FenceCreateInfo().setFlags(vk::FenceCreateFlagBits::eSignaled);
-
         mImageReady[i] = mDevice->handle().createSemaphore(semaphoreCreateInfo);
+    }
+
+    const uint32_t imageCount = mSwapchain->getFrameCount();
+    mRenderingFinished.resize(imageCount);
+    mImageFrameValues.resize(imageCount, 0);
+    for (uint32_t i = 0; i < imageCount; i++)
+    {
         mRenderingFinished[i] = mDevice->handle().createSemaphore(semaphoreCreateInfo);
-        mFrameInFlight[i] = mDevice->handle().createFence(fenceCreateInfo);
     }
 
     VK_PRINTLN(fmt::format("{} RHI initialized", VK_STYLED_PREFIX));
 }
 
+VulkanRHI::~VulkanRHI()
+{
+    // Frames are no longer waited on in submitFrame, the GPU has to be done with them before anything is destroyed
+    mDevice->waitIdle();
+
+    for (const auto& semaphore : mImageReady)
+    {
+        mDevice->handle().destroySemaphore(semaphore);
+    }
+    for (const auto& semaphore : mRenderingFinished)
+    {
+        mDevice->handle().destroySemaphore(semaphore);
+    }
+}
+
 std::unique_ptr<VulkanRHI> VulkanRHI::createVulkanRHI(const VulkanRHICreateInfo& createInfo)
 {
     return std::make_unique<VulkanRHI>(createInfo);
@@ -55,15 +119,52 @@ std::unique_ptr<VulkanRHI> VulkanRHI::createVulkanRHI(const VulkanRHICreateInfo&
 
 Frame VulkanRHI::beginFrame(const RHIFrameBeginInfo& frameBeginInfo)
 {
-    const vk::Fence fence = mFrameInFlight[mCurrentFrame];
+    const auto frameBegin = std::chrono::steady_clock::now();
+
+    const uint64_t slotValue = mFrameSlotValues[mCurrentFrame];
+    double fenceWait = waitForFrame(slotValue);
+
+    // The GPU is done with this frame slot's command list, transient data and the resources it retired
+    mDevice->getGraphicsQueue()->beginFrame(mCurrentFrame);
+    if (mDevice->hasDedicatedTransferQueue())
+    {
+        mDevice->getTransferQueue()->beginFrame(mCurrentFrame);
+    }
+    if (mDevice->hasDedicatedComputeQueue())
+    {
+        mDevice->getComputeQueue()->beginFrame(mCurrentFrame);
+    }
+    mTransientAllocator->reset(mCurrentFrame);
+    mDefragmenter->beginFrame(mCurrentFrame);
+    mParallelRecorder->beginFrame(mCurrentFrame);
 
-    vk::Result result = mDevice->handle().waitForFences(1, &fence, true, std::numeric_limits<uint64_t>::max());
-    result = mDevice->handle().resetFences(1, &fence);
+    // Resources are relocated before anything of this frame is recorded, so the frame only references their new
+    // handles. Work recorded in between frames still uses the old handles, it is submitted ahead of the copies.
+    flushPendingSubmissions();
+    mDefragmenter->execute(mCurrentFrame);
 
     const auto nextImage = mDevice->handle().acquireNextImageKHR(
         mSwapchain->handle(),std::numeric_limits<uint64_t>::max(),
         mImageReady[mCurrentFrame], nullptr).value;
 
+    // With more frames in flight than swapchain images, an older frame may still be rendering to the acquired image
+    if (const uint64_t imageValue = mImageFrameValues[nextImage];
+        imageValue > slotValue)
+    {
+        fenceWait += waitForFrame(imageValue);
+    }
+
+    if (mLastFrameBegin.has_value())
+    {
+        const double frameTime = std::chrono::duration<double, std::milli>(frameBegin - mLastFrameBegin.value()).count();
+        mFrameStatistics.frameCount++;
+        mFrameStatistics.lastFrameTime   = frameTime;
+        mFrameStatistics.totalFrameTime += frameTime;
+        mFrameStatistics.lastFenceWait   = fenceWait;
+        mFrameStatistics.totalFenceWait += fenceWait;
+    }
+    mLastFrameBegin = frameBegin;
+
     return {
         .mCurrentFrame = mCurrentFrame,
         .mAcquiredFrameIndex = nextImage,
@@ -74,6 +175,10 @@ void VulkanRHI::submitFrame(const Frame& frame)
 {
     const auto frameIndex = frame.getCurrentFrame();
 
+    mTransientAllocator->flush(frameIndex);
+
+    flushPendingSubmissions();
+
     std::vector<vk::CommandBufferSubmitInfo> commandBufferSubmitInfos;
     for (const auto commandBuffer : frame.mCommandLists)
     {
@@ -82,15 +187,27 @@ void VulkanRHI::submitFrame(const Frame& frame)
         commandBufferSubmitInfos.push_back(info);
     }
 
+    const uint64_t frameValue = ++mFrameFenceValue;
+    mFrameSlotValues[frameIndex] = frameValue;
+    mImageFrameValues[frame.getAcquiredFrameIndex()] = frameValue;
+
     const auto waitSemaphoreInfo = vk::SemaphoreSubmitInfo()
         .setSemaphore(mImageReady[frameIndex])
         .setStageMask(vk::PipelineStageFlagBits2::eColorAttachmentOutput);
     std::vector waitSemaphoreInfos = { waitSemaphoreInfo };
+    for (const auto& [fence, value] : frame.mWaitFences)
+    {
+        waitSemaphoreInfos.push_back(fence->as<VulkanFence>()->getSubmitInfo(value));
+    }
 
     const auto signalSemaphoreInfo = vk::SemaphoreSubmitInfo()
-        .setSemaphore(mRenderingFinished[frameIndex])
+        .setSemaphore(mRenderingFinished[frame.getAcquiredFrameIndex()])
         .setStageMask(vk::PipelineStageFlagBits2::eColorAttachmentOutput);
-    std::vector signalSemaphoreInfos = { signalSemaphoreInfo };
+    std::vector signalSemaphoreInfos = { signalSemaphoreInfo, mFrameFence->getSubmitInfo(frameValue) };
+    for (const auto& [fence, value] : frame.mSignalFences)
+    {
+        signalSemaphoreInfos.push_back(fence->as<VulkanFence>()->getSubmitInfo(value));
+    }
 
     const auto submitInfo = vk::SubmitInfo2()
         .setCommandBufferInfos(commandBufferSubmitInfos)
@@ -100,18 +217,34 @@ void VulkanRHI::submitFrame(const Frame& frame)
         .setSignalSemaphoreInfos(signalSemaphoreInfos)
         .setSignalSemaphoreInfoCount(signalSemaphoreInfos.size());
 
-    if (auto result = mDevice->getGraphicsQueue()->getQueue().submit2(1, &submitInfo, mFrameInFlight[frameIndex]);
+    if (auto result = mDevice->getGraphicsQueue()->submit2(submitInfo);
         result != vk::Result::eSuccess)
     {
         throw std::runtime_error("Failed to submit CommandList");
     }
 
-    mSwapchain->present(mRenderingFinished[frameIndex], frame.getAcquiredFrameIndex());
+    mSwapchain->present(mRenderingFinished[frame.getAcquiredFrameIndex()], frame.getAcquiredFrameIndex());
 
-    mDevice->waitIdle();
     mCurrentFrame = (mCurrentFrame + 1) % mFramesInFlight;
 }
 
+void VulkanRHI::flushPendingSubmissions()
+{
+    // Single-time commands recorded since the last flush go out in one submission per queue
+    mDevice->getGraphicsQueue()->flushSingleTimeCommands();
+    if (mDevice->hasDedicatedTransferQueue())
+    {
+        mDevice->getTransferQueue()->flushSingleTimeCommands();
+    }
+    if (mDevice->hasDedicatedComputeQueue())
+    {
+        mDevice->getComputeQueue()->flushSingleTimeCommands();
+    }
+
+    // Uploads are submitted ahead of, and made visible to, everything submitted to the graphics queue afterwards
+    mUploadManager->submit();
+}
+
 std::unique_ptr<RHIBuffer> VulkanRHI::createBuffer(const RHIBufferCreateInfo& createInfo)
 {
     return VulkanBuffer::createVulkanBuffer({
@@ -119,9 +252,36 @@ std::unique_ptr<RHIBuffer> VulkanRHI::createBuffer(const RHIBufferCreateInfo& cr
         .bufferType = createInfo.bufferType,
         .pDevice    = mDevice.get(),
         .debugName  = createInfo.debugName,
+        .relocatable = createInfo.relocatable,
+        .sharedWithAsyncCompute = createInfo.sharedWithAsyncCompute,
     });
 }
 
+RHITransientAllocation VulkanRHI::allocateTransient(const uint64_t size, const uint64_t alignment, const RHIBufferType usage)
+{
+    return mTransientAllocator->allocate(mCurrentFrame, size, alignment, usage);
+}
+
+RHIUploadToken VulkanRHI::uploadBuffer(RHIBuffer* dstBuffer, const void* pData, const uint64_t dataSize, const uint64_t dstOffset)
+{
+    return mUploadManager->upload(dstBuffer->as<VulkanBuffer>(), pData, dataSize, dstOffset);
+}
+
+RHIUploadToken VulkanRHI::uploadTexture(RHITexture* dstTexture, const void* pData, const uint64_t dataSize)
+{
+    return mUploadManager->upload(dstTexture->as<VulkanTexture>(), pData, dataSize);
+}
+
+bool VulkanRHI::isUploadComplete(const RHIUploadToken token)
+{
+    return mUploadManager->isComplete(token);
+}
+
+void VulkanRHI::waitForUpload(const RHIUploadToken token)
+{
+    mUploadManager->wait(token);
+}
+
 std::unique_ptr<RHITexture> VulkanRHI::createTexture(const RHITextureCreateInfo& createInfo)
 {
     return VulkanTexture::createVulkanTexture({
@@ -130,6 +290,9 @@ std::unique_ptr<RHITexture> VulkanRHI::createTexture(const RHITextureCreateInfo&
         .sampled = createInfo.sampled,
         .debugName = createInfo.debugName,
         .pDevice = mDevice.get(),
+        .pAliasingAllocator = createInfo.transient ? mAliasingAllocator.get() : nullptr,
+        .lifetime = createInfo.lifetime,
+        .relocatable = createInfo.relocatable,
     });
 }
 
@@ -153,8 +316,15 @@ std::unique_ptr<RHIFramebuffer> VulkanRHI::createFramebuffer(const RHIFramebuffe
         }
         if (std::holds_alternative<RHITexture*>(attachment.imageView))
         {
-            imageView = std::get<RHITexture*>(attachment.imageView)->as<VulkanTexture>()->getImageView();
+            auto* texture = std::get<RHITexture*>(attachment.imageView)->as<VulkanTexture>();
+            texture->pin();
+            imageView = texture->getImageView();
             framebuffersInfo.addAttachment(imageView, attachment.attachmentIndex);
+
+            if (texture->isTransient())
+            {
+                framebuffersInfo.transientAttachments.push_back(texture);
+            }
         }
     }
 
@@ -167,6 +337,7 @@ std::unique_ptr<RHIRenderPass> VulkanRHI::createRenderPass(const RHIRenderPassCr
         .renderArea = toVulkan(createInfo.renderArea),
         .device     = mDevice.get(),
         .debugName  =  createInfo.debugName,
+        .parallelRecorder = mParallelRecorder.get(),
     });
 
     for (const auto& colorAttachment : createInfo.colorAttachments)
@@ -209,6 +380,32 @@ std::unique_ptr<RHIRenderPass> VulkanRHI::createRenderPass(const RHIRenderPassCr
 }
 
 std::unique_ptr<RHIPipeline> VulkanRHI::createPipeline(const RHIPipelineCreateInfo& createInfo)
+{
+    auto pipeline = mPipelineStateCache->getOrCreate(createInfo, [&] { return compilePipeline(createInfo); });
+    return std::make_unique<VulkanSharedPipeline>(std::move(pipeline));
+}
+
+std::unique_ptr<RHIPipeline> VulkanRHI::createPipelineAsync(const RHIPipelineCreateInfo& createInfo, RHIPipeline* fallback)
+{
+    auto compilation = std::make_shared<VulkanPipelineCompilation>([this, createInfo] {
+        return mPipelineStateCache->getOrCreate(createInfo, [&] { return compilePipeline(createInfo); });
+    });
+
+    // Errors are kept by the compilation and rethrown on bind, the job's future is not needed
+    mTaskPool->submit([compilation] { compilation->get(); });
+    return std::make_unique<VulkanAsyncPipeline>(compilation, fallback);
+}
+
+std::vector<std::unique_ptr<RHIPipeline>> VulkanRHI::createPipelines(const std::span<const RHIPipelineCreateInfo> createInfos)
+{
+    std::vector<std::unique_ptr<RHIPipeline>> pipelines(createInfos.size());
+    mTaskPool->parallelFor(static_cast<uint32_t>(createInfos.size()), [&](const uint32_t taskIndex, uint32_t) {
+        pipelines[taskIndex] = createPipeline(createInfos[taskIndex]);
+    });
+    return pipelines;
+}
+
+std::unique_ptr<VulkanPipeline> VulkanRHI::compilePipeline(const RHIPipelineCreateInfo& createInfo)
 {
     std::vector<vk::VertexInputAttributeDescription> attributes;
     std::vector<vk::VertexInputBindingDescription> bindings;
@@ -240,16 +437,53 @@ std::unique_ptr<RHIPipeline> VulkanRHI::createPipeline(const RHIPipelineCreateIn
         });
     }
 
+    std::vector<vk::PushConstantRange> pushConstantRanges;
+    for (const auto& range : createInfo.pushConstantRanges)
+    {
+        vk::ShaderStageFlags stageFlags;
+        for (const auto stage : range.stages)
+        {
+            stageFlags |= toVulkan(stage);
+        }
+
+        pushConstantRanges.push_back(vk::PushConstantRange()
+            .setStageFlags(stageFlags)
+            .setOffset(range.offset)
+            .setSize(range.size));
+    }
+
+    std::vector<vk::PipelineColorBlendAttachmentState> attachmentStates;
+    for (const auto& attachment : createInfo.graphicsPipelineState.attachmentStates)
+    {
+        vk::ColorComponentFlags colorWriteMask;
+        for (const auto component : attachment.colorWriteMask)
+        {
+            colorWriteMask |= toVulkan(component);
+        }
+
+        attachmentStates.push_back(VulkanPipelineUtils::makeColorBlendAttachmentState(colorWriteMask, attachment.blendEnable,
+            toVulkan(attachment.blendColor.srcBlendFactor), toVulkan(attachment.blendColor.dstBlendFactor), toVulkan(attachment.blendColor.blendOp),
+            toVulkan(attachment.blendAlpha.srcBlendFactor), toVulkan(attachment.blendAlpha.dstBlendFactor), toVulkan(attachment.blendAlpha.blendOp)));
+    }
+    if (attachmentStates.empty())
+    {
+        attachmentStates.push_back(VulkanPipelineUtils::makeColorBlendAttachmentState());
+    }
+
     VulkanPipelineCreateInfo pipelineCreateInfo = {
-        .pushConstantRanges = {},
+        .pushConstantRanges = pushConstantRanges,
         .descriptorSetLayouts = {},
         .shaderCreateInfos = vulkanShaderInfos,
-        .renderPass = createInfo.renderPass->as<VulkanRenderPass>()->handle(),
+        .pipelineType = createInfo.pipelineType,
+        .renderPass = createInfo.renderPass ? createInfo.renderPass->as<VulkanRenderPass>()->handle() : nullptr,
         .graphicsPipelineState = VulkanGraphicsPipelineStateInfo({
             .attributeDescriptions = attributes,
             .bindingDescriptions = bindings,
-            .attachmentStates = { VulkanPipelineUtils::makeColorBlendAttachmentState() }
-        }).setCullMode(toVulkan(createInfo.graphicsPipelineState.cullMode)),
+            .attachmentStates = attachmentStates,
+        })
+            .setCullMode(toVulkan(createInfo.graphicsPipelineState.cullMode))
+            .setPolygonMode(toVulkan(createInfo.graphicsPipelineState.polygonMode))
+            .setDepthTest(createInfo.graphicsPipelineState.depthTest),
         .pDevice = mDevice.get(),
         .debugName = createInfo.debugName,
     };
@@ -257,6 +491,15 @@ std::unique_ptr<RHIPipeline> VulkanRHI::createPipeline(const RHIPipelineCreateIn
     return VulkanPipeline::createVulkanPipeline(pipelineCreateInfo);
 }
 
+std::unique_ptr<RHIFence> VulkanRHI::createFence(const RHIFenceCreateInfo& createInfo)
+{
+    return VulkanFence::createVulkanFence({
+        .initialValue = createInfo.initialValue,
+        .debugName    = createInfo.debugName,
+        .pDevice      = mDevice.get(),
+    });
+}
+
 void VulkanRHI::createInstance()
 {
     constexpr auto apiFeatureLevel = VulkanPlatform::getPlatformVulkanFeatureLevel();
@@ -337,6 +580,16 @@ void VulkanRHI::createDebugContext()
 void VulkanRHI::createDevice()
 {
     mDevice = VulkanDevice::createVulkanDevice({
-        .instance = mInstance,
+        .instance       = mInstance,
+        .framesInFlight = mFramesInFlight,
     });
 }
+
+double VulkanRHI::waitForFrame(const uint64_t frameValue) const
+{
+    const auto waitBegin = std::chrono::steady_clock::now();
+
+    mFrameFence->wait(frameValue);
+
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - waitBegin).count();
+}
@@ -1,17 +1,46 @@
 #pragma once
 
+#include <chrono>
+#include "VulkanAliasingAllocator.hpp"
 #include "VulkanBase.hpp"
 #include "VulkanBuffer.hpp"
 #include "VulkanDebugContext.hpp"
+#include "VulkanDefragmenter.hpp"
 #include "VulkanDevice.hpp"
+#include "VulkanFence.hpp"
+#include "VulkanParallelRecorder.hpp"
 #include "VulkanPipeline.hpp"
+#include "VulkanPipelineStateCache.hpp"
 #include "VulkanSwapchain.hpp"
+#include "VulkanTransientAllocator.hpp"
+#include "VulkanUploadManager.hpp"
 #include "RHI/DynamicRHI.hpp"
 
 struct VulkanRHICreateInfo
 {
     RHIWindow* pWindow         = nullptr;
     uint32_t   backBufferCount = 2;
+    uint32_t   framesInFlight  = 2;
+    // Worker threads for parallel recording, defaults to one per hardware thread besides the calling one
+    std::optional<uint32_t> workerThreadCount = std::nullopt;
+    uint64_t   transientBufferSize = 16ull * 1024 * 1024;
+    uint64_t   uploadStagingSize   = 32ull * 1024 * 1024;
+    // Bytes of device memory the defragmenter may move per frame, 0 disables it
+    uint64_t   defragmentationBudget = 8ull * 1024 * 1024;
+};
+
+struct VulkanFrameStatistics
+{
+    uint64_t frameCount     {0};
+    // Milliseconds, measured from one beginFrame to the next
+    double   lastFrameTime  {0.0};
+    double   totalFrameTime {0.0};
+    // Milliseconds the CPU spent blocked on frame fences
+    double   lastFenceWait  {0.0};
+    double   totalFenceWait {0.0};
+
+    // Share of the frame time spent waiting for the GPU, close to 1 when GPU bound
+    double   getFenceWaitRatio() const { return (totalFrameTime > 0.0) ? totalFenceWait / totalFrameTime : 0.0; }
 };
 
 class VulkanRHI final : public DynamicRHI
@@ -20,7 +49,7 @@ public:
     DISABLE_COPY_CTOR(VulkanRHI);
     explicit DEF_PRIMARY_CTOR(VulkanRHI, const VulkanRHICreateInfo& createInfo);
 
-    ~VulkanRHI() override = default;
+    ~VulkanRHI() override;
 
     #pragma region "DynamicRHI"
 
@@ -33,21 +62,47 @@ public:
 
     std::unique_ptr<RHITexture> createTexture(const RHITextureCreateInfo& createInfo) override;
 
+    RHITransientAllocation allocateTransient(uint64_t size, uint64_t alignment, RHIBufferType usage) override;
+
+    RHIUploadToken uploadBuffer(RHIBuffer* dstBuffer, const void* pData, uint64_t dataSize, uint64_t dstOffset = 0) override;
+
+    RHIUploadToken uploadTexture(RHITexture* dstTexture, const void* pData, uint64_t dataSize) override;
+
+    bool isUploadComplete(RHIUploadToken token) override;
+
+    void waitForUpload(RHIUploadToken token) override;
+
     std::unique_ptr<RHIRenderPass> createRenderPass(const RHIRenderPassCreateInfo& createInfo) override;
 
     std::unique_ptr<RHIFramebuffer> createFramebuffer(const RHIFramebufferCreateInfo& createInfo) override;
 
     std::unique_ptr<RHIPipeline> createPipeline(const RHIPipelineCreateInfo& createInfo) override;
 
+    std::unique_ptr<RHIPipeline> createPipelineAsync(const RHIPipelineCreateInfo& createInfo, RHIPipeline* fallback = nullptr) override;
+
+    std::vector<std::unique_ptr<RHIPipeline>> createPipelines(std::span<const RHIPipelineCreateInfo> createInfos) override;
+
+    std::unique_ptr<RHIFence> createFence(const RHIFenceCreateInfo& createInfo) override;
+
 
     void              waitIdle()               override { mDevice->waitIdle(); }
 
     RHICommandQueue*  getGraphicsQueue()       override { return mDevice->getGraphicsQueue(); }
+    RHICommandQueue*  getTransferQueue()       override { return mDevice->getTransferQueue(); }
+    RHICommandQueue*  getComputeQueue()        override { return mDevice->getComputeQueue(); }
     RHIInterfaceType  getType()          const override { return RHIInterfaceType::Vulkan; }
     RHISwapchain*     getSwapchain()     const override { return mSwapchain.get(); }
 
     #pragma endregion
 
+    const VulkanDefragmentationStatistics& getDefragmentationStatistics() const { return mDefragmenter->getStatistics(); }
+
+    const VulkanFrameStatistics&           getFrameStatistics()           const { return mFrameStatistics; }
+
+    const VulkanParallelRecordingStatistics& getParallelRecordingStatistics() const { return mParallelRecorder->getStatistics(); }
+
+    VulkanPipelineStateCacheStatistics       getPipelineStateCacheStatistics()      { return mPipelineStateCache->getStatistics(); }
+
 private:
     void createInstance();
 
@@ -58,6 +113,15 @@ private:
 
     void createDevice();
 
+    // Builds a new pipeline, bypassing the pipeline state cache
+    std::unique_ptr<VulkanPipeline> compilePipeline(const RHIPipelineCreateInfo& createInfo);
+
+    // Submits pending single-time commands and uploads
+    void flushPendingSubmissions();
+
+    // Blocks until the frame fence has reached the value, returns the time spent waiting in milliseconds
+    double waitForFrame(uint64_t frameValue) const;
+
 private:
     vk::Instance                        mInstance;
     std::vector<const char*>            mInstanceLayers;
@@ -69,12 +133,33 @@ private:
 
     std::unique_ptr<VulkanSwapchain>    mSwapchain;
 
+    std::unique_ptr<VulkanTransientAllocator> mTransientAllocator;
+    std::unique_ptr<VulkanUploadManager>      mUploadManager;
+    std::unique_ptr<VulkanAliasingAllocator>  mAliasingAllocator;
+    std::unique_ptr<VulkanDefragmenter>       mDefragmenter;
+
+    // Declared ahead of the TaskPool, pending compilations still use it while the pool shuts down
+    std::unique_ptr<VulkanPipelineStateCache> mPipelineStateCache;
+
+    std::unique_ptr<TaskPool>                 mTaskPool;
+    std::unique_ptr<VulkanParallelRecorder>   mParallelRecorder;
+
     RHIWindow*                          mWindow;
 
     uint32_t                            mFramesInFlight {2};
     uint32_t                            mCurrentFrame {0};
 
-    std::vector<vk::Fence>              mFrameInFlight;
+    // Signaled with the number of every frame once the GPU has completed it
+    std::unique_ptr<VulkanFence>        mFrameFence;
+    uint64_t                            mFrameFenceValue {0};
+
+    // Indexed by frame in flight, the swapchain requires binary semaphores
+    std::vector<uint64_t>               mFrameSlotValues;
     std::vector<vk::Semaphore>          mImageReady;
+    // Indexed by swapchain image, a semaphore stays in use by the presentation engine until its image is acquired again
     std::vector<vk::Semaphore>          mRenderingFinished;
+    std::vector<uint64_t>               mImageFrameValues;
+
+    VulkanFrameStatistics               mFrameStatistics;
+    std::optional<std::chrono::steady_clock::time_point> mLastFrameBegin;
 };
\ No newline at end of file
@@ -30,6 +30,7 @@ VulkanRenderPass::VulkanRenderPass(const VulkanRenderPassInfo& renderPassInfo)
 : RHIRenderPass()
 , mRenderArea(renderPassInfo.renderArea)
 , mClearValues(renderPassInfo.clearValues)
+, mParallelRecorder(renderPassInfo.parallelRecorder)
 , mDevice(renderPassInfo.device)
 {
     const auto subpass = vk::SubpassDescription()
@@ -44,9 +45,10 @@ VulkanRenderPass::VulkanRenderPass(const VulkanRenderPassInfo& renderPassInfo)
     const auto subpass_dependency = vk::SubpassDependency()
         .setSrcSubpass(VK_SUBPASS_EXTERNAL)
         .setDstSubpass(0)
-        .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests)
-        .setSrcAccessMask({})
-        .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests)
+        // Attachments such as the depth buffer are shared by frames in flight, the previous frame's writes must complete first
+        .setSrcStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests)
+        .setSrcAccessMask(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite)
+        .setDstStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput | vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests)
         .setDstAccessMask(vk::AccessFlagBits::eColorAttachmentWrite | vk::AccessFlagBits::eDepthStencilAttachmentWrite);
 
     const auto rp_renderPassInfo = vk::RenderPassCreateInfo()
@@ -73,6 +75,20 @@ VulkanRenderPass::VulkanRenderPass(const VulkanRenderPassInfo& renderPassInfo)
         .setRenderPass(mRenderPass)
         .setClearValueCount(mClearValues.size())
         .setPClearValues(mClearValues.data());
+
+    // Compatibility ignores load/store operations and layouts, only formats, sample counts and references matter
+    VulkanStateKey compatibilityKey;
+    for (const auto& attachment : renderPassInfo.attachments)
+    {
+        compatibilityKey.add(attachment.format).add(attachment.samples);
+    }
+    for (const auto& colorRef : renderPassInfo.colorRefs)
+    {
+        compatibilityKey.add(colorRef.attachment);
+    }
+    compatibilityKey.add(renderPassInfo.hasDepthAttachment ? renderPassInfo.depthRef.attachment : VK_ATTACHMENT_UNUSED);
+    compatibilityKey.add(renderPassInfo.hasResolveAttachment ? renderPassInfo.resolveRef.attachment : VK_ATTACHMENT_UNUSED);
+    mCompatibilityKey = compatibilityKey.get();
 }
 
 std::unique_ptr<VulkanRenderPass> VulkanRenderPass::createVulkanRenderPass(const VulkanRenderPassInfo& renderPassInfo)
@@ -88,12 +104,57 @@ VulkanRenderPass::~VulkanRenderPass()
 void VulkanRenderPass::execute(RHICommandList* commandList, RHIFramebufferHandle* framebuffer,
                                const std::function<void(RHICommandList*)> lambda)
 {
-    const auto commandBuffer = commandList->as< VulkanCommandList>()->handle();
+    const auto commandBuffer = VulkanCommandList::fromRHI(commandList, "VulkanRenderPass::execute()")->handle();
 
-    mRenderPassBeginInfo.setFramebuffer(framebuffer->as<VulkanFramebufferHandle>()->handle());
-    commandBuffer.beginRenderPass(&mRenderPassBeginInfo, vk::SubpassContents::eInline);
+    beginRenderPass(commandBuffer, framebuffer->as<VulkanFramebufferHandle>(), vk::SubpassContents::eInline);
 
     lambda(commandList);
 
     commandBuffer.endRenderPass();
 }
+
+void VulkanRenderPass::executeParallel(RHICommandList* commandList, RHIFramebufferHandle* framebuffer, const uint32_t taskCount,
+                                       const std::function<void(RHICommandList*, uint32_t)>& lambda)
+{
+    if (mParallelRecorder == nullptr)
+    {
+        RHIRenderPass::executeParallel(commandList, framebuffer, taskCount, lambda);
+        return;
+    }
+
+    auto* vulkanCommandList = VulkanCommandList::fromRHI(commandList, "VulkanRenderPass::executeParallel()");
+    const auto commandBuffer = vulkanCommandList->handle();
+    const auto* vulkanFramebuffer = framebuffer->as<VulkanFramebufferHandle>();
+
+    const auto inheritanceInfo = vk::CommandBufferInheritanceInfo()
+        .setRenderPass(mRenderPass)
+        .setSubpass(0)
+        .setFramebuffer(vulkanFramebuffer->handle());
+
+    const auto secondaryCommandBuffers = mParallelRecorder->record(inheritanceInfo, taskCount, lambda);
+
+    beginRenderPass(commandBuffer, vulkanFramebuffer, vk::SubpassContents::eSecondaryCommandBuffers);
+
+    if (!secondaryCommandBuffers.empty())
+    {
+        commandBuffer.executeCommands(secondaryCommandBuffers);
+        vulkanCommandList->invalidateState();
+    }
+
+    commandBuffer.endRenderPass();
+}
+
+void VulkanRenderPass::beginRenderPass(const vk::CommandBuffer commandBuffer, const VulkanFramebufferHandle* framebuffer, const vk::SubpassContents contents) const
+{
+    // Aliased attachments start their lifetime in memory that earlier passes may still access through other images.
+    // Their contents are discarded by the Undefined initial layout, only those accesses have to complete first.
+    if (const auto aliasingBarrier = framebuffer->getAliasingBarrier(); aliasingBarrier.has_value())
+    {
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(aliasingBarrier.value()));
+    }
+
+    // Render passes may be begun on several threads at once, the shared begin info is only read
+    const auto renderPassBeginInfo = vk::RenderPassBeginInfo(mRenderPassBeginInfo)
+        .setFramebuffer(framebuffer->handle());
+    commandBuffer.beginRenderPass(&renderPassBeginInfo, contents);
+}
@@ -3,6 +3,7 @@
 #include "VulkanBase.hpp"
 #include "VulkanDevice.hpp"
 #include "VulkanFramebuffer.hpp"
+#include "VulkanParallelRecorder.hpp"
 #include "RHI/RHIRenderPass.hpp"
 
 struct VulkanRenderPassInfo
@@ -17,6 +18,7 @@ struct VulkanRenderPassInfo
     vk::Rect2D                             renderArea;
     VulkanDevice*                          device;
     const char*                            debugName;
+    VulkanParallelRecorder*                parallelRecorder {nullptr};
 
     VulkanRenderPassInfo& addColorAttachment(
         vk::Format              format,
@@ -36,12 +38,22 @@ public:
 
     void execute(RHICommandList* commandList, RHIFramebufferHandle* framebuffer, std::function<void(RHICommandList*)> lambda) override;
 
+    void executeParallel(RHICommandList* commandList, RHIFramebufferHandle* framebuffer, uint32_t taskCount,
+                         const std::function<void(RHICommandList*, uint32_t)>& lambda) override;
+
     vk::RenderPass handle() const { return mRenderPass; }
 
+    // Equal for render passes that are compatible in the Vulkan sense, so pipelines may be shared between them
+    const std::string& getCompatibilityKey() const { return mCompatibilityKey; }
+
 private:
+    void beginRenderPass(vk::CommandBuffer commandBuffer, const VulkanFramebufferHandle* framebuffer, vk::SubpassContents contents) const;
+
     vk::Rect2D                  mRenderArea;
     vk::RenderPass              mRenderPass;
     vk::RenderPassBeginInfo     mRenderPassBeginInfo;
     std::vector<vk::ClearValue> mClearValues;
+    std::string                 mCompatibilityKey;
+    VulkanParallelRecorder*     mParallelRecorder;
     VulkanDevice*               mDevice;
 };
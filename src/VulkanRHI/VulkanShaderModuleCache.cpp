@@ -0,0 +1,253 @@
+#include "VulkanShaderModuleCache.hpp"
+
+#include <cstring>
+#include "VulkanDevice.hpp"
+
+#ifdef _WIN32
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace
+{
+    // Read-only view of a whole file, unmapped on destruction
+    class MappedFile
+    {
+    public:
+        DISABLE_COPY_CTOR(MappedFile);
+
+        explicit MappedFile(const std::filesystem::path& filePath)
+        {
+            #ifdef _WIN32
+            mFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            LARGE_INTEGER fileSize {};
+            if (mFile == INVALID_HANDLE_VALUE or !GetFileSizeEx(mFile, &fileSize))
+            {
+                throw std::runtime_error(fmt::format("Failed to open file: {}!", filePath.string()));
+            }
+            mSize = static_cast<size_t>(fileSize.QuadPart);
+
+            if (mSize > 0)
+            {
+                mMapping = CreateFileMappingW(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                mData    = mMapping ? MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+            }
+            #else
+            mFile = open(filePath.c_str(), O_RDONLY);
+            struct stat fileStat {};
+            if (mFile < 0 or fstat(mFile, &fileStat) != 0)
+            {
+                throw std::runtime_error(fmt::format("Failed to open file: {}!", filePath.string()));
+            }
+            mSize = static_cast<size_t>(fileStat.st_size);
+
+            if (mSize > 0)
+            {
+                mData = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+                if (mData == MAP_FAILED)
+                {
+                    mData = nullptr;
+                }
+            }
+            #endif
+
+            if (mSize > 0 and mData == nullptr)
+            {
+                throw std::runtime_error(fmt::format("Failed to map file: {}!", filePath.string()));
+            }
+        }
+
+        ~MappedFile()
+        {
+            #ifdef _WIN32
+            if (mData)                        UnmapViewOfFile(mData);
+            if (mMapping)                     CloseHandle(mMapping);
+            if (mFile != INVALID_HANDLE_VALUE) CloseHandle(mFile);
+            #else
+            if (mData)      munmap(mData, mSize);
+            if (mFile >= 0) close(mFile);
+            #endif
+        }
+
+        std::span<const std::byte> data() const { return { static_cast<const std::byte*>(mData), mSize }; }
+
+    private:
+        #ifdef _WIN32
+        HANDLE mFile    {INVALID_HANDLE_VALUE};
+        HANDLE mMapping {nullptr};
+        #else
+        int    mFile    {-1};
+        #endif
+        void*  mData    {nullptr};
+        size_t mSize    {0};
+    };
+
+    uint64_t hashFnv1a(const std::span<const std::byte> data)
+    {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (const std::byte value : data)
+        {
+            hash = (hash ^ static_cast<uint64_t>(value)) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    bool isSpirv(const std::span<const std::byte> code)
+    {
+        constexpr uint32_t spirvMagic = 0x07230203;
+
+        uint32_t magic = 0;
+        if (code.size() < sizeof(magic) or code.size() % sizeof(uint32_t) != 0)
+        {
+            return false;
+        }
+        std::memcpy(&magic, code.data(), sizeof(magic));
+        return magic == spirvMagic;
+    }
+}
+
+#pragma region "VulkanShaderModule"
+
+VulkanShaderModule::VulkanShaderModule(const VulkanShaderModuleCreateInfo& createInfo)
+: mContentHash(createInfo.contentHash)
+, mDebugName(createInfo.debugName ? createInfo.debugName : "Unknown")
+, mDevice(createInfo.pDevice)
+{
+    // The code is only valid during construction, so reflection can't be deferred until a pipeline asks for it
+    try
+    {
+        mReflection = VulkanShaderReflection::reflect({ reinterpret_cast<const uint32_t*>(createInfo.code.data()), createInfo.code.size() / sizeof(uint32_t) });
+    }
+    catch (const std::exception& exception)
+    {
+        mReflectionError = exception.what();
+        VK_DEBUG(fmt::format("Reflection unavailable for shader {}: {}", mDebugName, mReflectionError));
+    }
+
+    const auto shaderModuleCreateInfo = vk::ShaderModuleCreateInfo()
+        .setCodeSize(createInfo.code.size())
+        .setPCode(reinterpret_cast<const uint32_t*>(createInfo.code.data()));
+
+    VK_CHECK(mShaderModule = mDevice->handle().createShaderModule(shaderModuleCreateInfo););
+
+    mDevice->nameObject<vk::ShaderModule>({
+        .debugName = createInfo.debugName,
+        .handle    = mShaderModule,
+    });
+}
+
+std::unique_ptr<VulkanShaderModule> VulkanShaderModule::createVulkanShaderModule(const VulkanShaderModuleCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanShaderModule>(createInfo);
+}
+
+VulkanShaderModule::~VulkanShaderModule()
+{
+    mDevice->handle().destroyShaderModule(mShaderModule);
+}
+
+const VulkanShaderReflection& VulkanShaderModule::getReflection() const
+{
+    if (!mReflection.has_value())
+    {
+        throw std::runtime_error(fmt::format("Shader {} could not be reflected ({}), pass its layouts and vertex input explicitly",
+            mDebugName, mReflectionError));
+    }
+    return mReflection.value();
+}
+
+#pragma endregion
+
+#pragma region "VulkanShaderModuleCache"
+
+VulkanShaderModuleCache::VulkanShaderModuleCache(VulkanDevice* pDevice)
+: mDevice(pDevice)
+{
+}
+
+std::unique_ptr<VulkanShaderModuleCache> VulkanShaderModuleCache::createVulkanShaderModuleCache(VulkanDevice* pDevice)
+{
+    return std::make_unique<VulkanShaderModuleCache>(pDevice);
+}
+
+std::shared_ptr<VulkanShaderModule> VulkanShaderModuleCache::getOrCreate(const std::filesystem::path& filePath)
+{
+    // Each call resets the error code on success, so both have to be checked on their own
+    std::error_code error;
+    const auto lastWriteTime = std::filesystem::last_write_time(filePath, error);
+    if (error)
+    {
+        throw std::runtime_error(fmt::format("Failed to open file: {}! ({})", filePath.string(), error.message()));
+    }
+    const auto fileSize = std::filesystem::file_size(filePath, error);
+    if (error)
+    {
+        throw std::runtime_error(fmt::format("Failed to open file: {}! ({})", filePath.string(), error.message()));
+    }
+
+    // Held while mapping and creating, concurrent pipeline compilations mostly ask for the same few shaders
+    std::lock_guard lock(mMutex);
+
+    // Modules whose last user is gone would otherwise keep their entries forever
+    std::erase_if(mEntries, [](const auto& item) { return item.second.module.expired(); });
+
+    Entry& entry = mEntries[filePath.string()];
+    std::shared_ptr<VulkanShaderModule> module = entry.module.lock();
+
+    if (module and entry.lastWriteTime == lastWriteTime and entry.fileSize == fileSize)
+    {
+        mStatistics.hitCount++;
+        return module;
+    }
+
+    const MappedFile file(filePath);
+    const auto code = file.data();
+    mStatistics.mappedBytes += code.size();
+
+    if (!isSpirv(code))
+    {
+        throw std::runtime_error(fmt::format("File is not SPIR-V: {}!", filePath.string()));
+    }
+
+    const uint64_t contentHash = hashFnv1a(code);
+
+    // Rewritten with identical content, e.g. by a shader build step
+    if (module and module->getContentHash() == contentHash)
+    {
+        entry.lastWriteTime = lastWriteTime;
+        entry.fileSize      = fileSize;
+        mStatistics.hitCount++;
+        return module;
+    }
+
+    const std::string debugName = filePath.string();
+    module = VulkanShaderModule::createVulkanShaderModule({
+        .code        = code,
+        .contentHash = contentHash,
+        .debugName   = debugName.c_str(),
+        .pDevice     = mDevice,
+    });
+
+    // Only recorded once a module exists for them, a failed creation is retried on the next request
+    entry.lastWriteTime = lastWriteTime;
+    entry.fileSize      = fileSize;
+    entry.module        = module;
+    mStatistics.missCount++;
+
+    return module;
+}
+
+VulkanShaderModuleCacheStatistics VulkanShaderModuleCache::getStatistics()
+{
+    std::lock_guard lock(mMutex);
+    return mStatistics;
+}
+
+#pragma endregion
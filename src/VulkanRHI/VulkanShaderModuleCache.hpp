@@ -0,0 +1,88 @@
+#pragma once
+
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include "VulkanBase.hpp"
+#include "VulkanShaderReflection.hpp"
+
+class VulkanDevice;
+
+struct VulkanShaderModuleCreateInfo
+{
+    // SPIR-V words, only read during construction
+    std::span<const std::byte> code;
+    uint64_t                   contentHash {0};
+    const char*                debugName   {nullptr};
+    VulkanDevice*              pDevice     {nullptr};
+};
+
+class VulkanShaderModule
+{
+public:
+    DISABLE_COPY_CTOR(VulkanShaderModule);
+    explicit DEF_PRIMARY_CTOR(VulkanShaderModule, const VulkanShaderModuleCreateInfo& createInfo);
+
+    ~VulkanShaderModule();
+
+    vk::ShaderModule handle()         const { return mShaderModule; }
+    uint64_t         getContentHash() const { return mContentHash; }
+
+    // Parsed once when the module is created. SPIR-V the reflection can't parse still makes a usable module,
+    // getReflection() then throws, so only pipelines deriving their layout or vertex input from the shader fail.
+    const VulkanShaderReflection& getReflection() const;
+    bool                          hasReflection() const { return mReflection.has_value(); }
+
+private:
+    vk::ShaderModule                      mShaderModule;
+    uint64_t                              mContentHash;
+    std::optional<VulkanShaderReflection> mReflection;
+    std::string                           mReflectionError;
+    std::string                           mDebugName;
+
+    VulkanDevice*    mDevice;
+};
+
+struct VulkanShaderModuleCacheStatistics
+{
+    // Requests served by a live module, and those that created one
+    uint32_t hitCount    {0};
+    uint32_t missCount   {0};
+    // Bytes of SPIR-V mapped from disk
+    uint64_t mappedBytes {0};
+};
+
+/**
+ * Shader modules shared by every pipeline using the same SPIR-V file.
+ * Files are memory mapped and handed to the driver without a copy. A module is reused without touching the file
+ * as long as its size and modification time are unchanged, a rewritten file is only turned into a new module
+ * if its content hash differs. Modules are reference counted and destroyed with their last pipeline.
+ */
+class VulkanShaderModuleCache
+{
+public:
+    DISABLE_COPY_CTOR(VulkanShaderModuleCache);
+    explicit DEF_PRIMARY_CTOR(VulkanShaderModuleCache, VulkanDevice* pDevice);
+
+    // Thread safe, throws if the file can't be read or doesn't contain SPIR-V
+    std::shared_ptr<VulkanShaderModule> getOrCreate(const std::filesystem::path& filePath);
+
+    VulkanShaderModuleCacheStatistics getStatistics();
+
+private:
+    struct Entry
+    {
+        std::filesystem::file_time_type   lastWriteTime;
+        uintmax_t                         fileSize {0};
+        std::weak_ptr<VulkanShaderModule> module;
+    };
+
+    // Keyed by path as given
+    std::unordered_map<std::string, Entry> mEntries;
+    std::mutex                             mMutex;
+
+    VulkanShaderModuleCacheStatistics      mStatistics;
+
+    VulkanDevice*                          mDevice;
+};
@@ -0,0 +1,447 @@
+#include "VulkanShaderReflection.hpp"
+
+#include <unordered_map>
+
+namespace
+{
+    // The subset of the SPIR-V specification the reflection reads
+    namespace spv
+    {
+        constexpr uint32_t MagicNumber = 0x07230203;
+        constexpr uint32_t HeaderWords = 5;
+
+        constexpr uint32_t OpEntryPoint                  = 15;
+        constexpr uint32_t OpTypeBool                    = 20;
+        constexpr uint32_t OpTypeInt                     = 21;
+        constexpr uint32_t OpTypeFloat                   = 22;
+        constexpr uint32_t OpTypeVector                  = 23;
+        constexpr uint32_t OpTypeMatrix                  = 24;
+        constexpr uint32_t OpTypeImage                   = 25;
+        constexpr uint32_t OpTypeSampler                 = 26;
+        constexpr uint32_t OpTypeSampledImage            = 27;
+        constexpr uint32_t OpTypeArray                   = 28;
+        constexpr uint32_t OpTypeRuntimeArray            = 29;
+        constexpr uint32_t OpTypeStruct                  = 30;
+        constexpr uint32_t OpTypePointer                 = 32;
+        constexpr uint32_t OpConstant                    = 43;
+        constexpr uint32_t OpVariable                    = 59;
+        constexpr uint32_t OpDecorate                    = 71;
+        constexpr uint32_t OpMemberDecorate              = 72;
+        constexpr uint32_t OpTypeAccelerationStructure   = 5341;
+
+        constexpr uint32_t DecorationBlock               = 2;
+        constexpr uint32_t DecorationBufferBlock         = 3;
+        constexpr uint32_t DecorationArrayStride         = 6;
+        constexpr uint32_t DecorationMatrixStride        = 7;
+        constexpr uint32_t DecorationBuiltIn             = 11;
+        constexpr uint32_t DecorationLocation            = 30;
+        constexpr uint32_t DecorationBinding             = 33;
+        constexpr uint32_t DecorationDescriptorSet       = 34;
+        constexpr uint32_t DecorationOffset              = 35;
+
+        constexpr uint32_t StorageClassUniformConstant   = 0;
+        constexpr uint32_t StorageClassInput             = 1;
+        constexpr uint32_t StorageClassUniform           = 2;
+        constexpr uint32_t StorageClassPushConstant      = 9;
+        constexpr uint32_t StorageClassStorageBuffer     = 12;
+
+        constexpr uint32_t DimBuffer                     = 5;
+        constexpr uint32_t DimSubpassData                = 6;
+    }
+
+    struct Decorations
+    {
+        std::optional<uint32_t> set;
+        std::optional<uint32_t> binding;
+        std::optional<uint32_t> location;
+        std::optional<uint32_t> arrayStride;
+        bool                    builtIn     {false};
+        bool                    block       {false};
+        bool                    bufferBlock {false};
+    };
+
+    struct MemberDecorations
+    {
+        uint32_t                offset {0};
+        std::optional<uint32_t> matrixStride;
+    };
+
+    struct Type
+    {
+        uint32_t              opcode;
+        // Words following the result id
+        std::vector<uint32_t> operands;
+    };
+
+    struct Variable
+    {
+        uint32_t id;
+        uint32_t pointerType;
+        uint32_t storageClass;
+    };
+
+    class SpirvModule
+    {
+    public:
+        explicit SpirvModule(const std::span<const uint32_t> code)
+        {
+            if (code.size() < spv::HeaderWords or code[0] != spv::MagicNumber)
+            {
+                throw std::runtime_error("Invalid SPIR-V module");
+            }
+
+            for (size_t offset = spv::HeaderWords; offset < code.size();)
+            {
+                const uint32_t wordCount = code[offset] >> 16;
+                const uint32_t opcode    = code[offset] & 0xFFFF;
+                if (wordCount == 0 or offset + wordCount > code.size())
+                {
+                    throw std::runtime_error("Malformed SPIR-V instruction");
+                }
+
+                parseInstruction(opcode, code.subspan(offset + 1, wordCount - 1));
+                offset += wordCount;
+            }
+        }
+
+        const Type& getType(const uint32_t id) const
+        {
+            const auto it = mTypes.find(id);
+            if (it == std::end(mTypes))
+            {
+                throw std::runtime_error(fmt::format("SPIR-V type %{} not found", id));
+            }
+            return it->second;
+        }
+
+        const Decorations& getDecorations(const uint32_t id) const
+        {
+            static const Decorations none;
+            const auto it = mDecorations.find(id);
+            return (it != std::end(mDecorations)) ? it->second : none;
+        }
+
+        MemberDecorations getMemberDecorations(const uint32_t structId, const uint32_t member) const
+        {
+            const auto it = mMemberDecorations.find(memberKey(structId, member));
+            return (it != std::end(mMemberDecorations)) ? it->second : MemberDecorations {};
+        }
+
+        uint32_t getConstant(const uint32_t id) const
+        {
+            const auto it = mConstants.find(id);
+            if (it == std::end(mConstants))
+            {
+                throw std::runtime_error("SPIR-V array length is not a literal constant");
+            }
+            return it->second;
+        }
+
+        // Pointee of a pointer type
+        uint32_t getPointee(const uint32_t pointerType) const { return getType(pointerType).operands[1]; }
+
+        // Bytes occupied by a type in a block with explicit layout
+        uint32_t getSize(const uint32_t typeId, const std::optional<uint32_t> matrixStride = std::nullopt) const
+        {
+            const Type& type = getType(typeId);
+            switch (type.opcode)
+            {
+                case spv::OpTypeBool:
+                    return 4;
+                case spv::OpTypeInt:
+                case spv::OpTypeFloat:
+                    return type.operands[0] / 8;
+                case spv::OpTypeVector:
+                    return type.operands[1] * getSize(type.operands[0]);
+                case spv::OpTypeMatrix:
+                    return type.operands[1] * matrixStride.value_or(getSize(type.operands[0]));
+                case spv::OpTypeArray:
+                {
+                    const uint32_t stride = getDecorations(typeId).arrayStride.value_or(getSize(type.operands[0], matrixStride));
+                    return getConstant(type.operands[1]) * stride;
+                }
+                case spv::OpTypeStruct:
+                {
+                    uint32_t size = 0;
+                    for (uint32_t member = 0; member < type.operands.size(); member++)
+                    {
+                        const auto decorations = getMemberDecorations(typeId, member);
+                        size = std::max(size, decorations.offset + getSize(type.operands[member], decorations.matrixStride));
+                    }
+                    return size;
+                }
+                default:
+                    throw std::runtime_error(fmt::format("Can't determine the size of SPIR-V type with opcode {}", type.opcode));
+            }
+        }
+
+        uint32_t                     getExecutionModel() const { return mExecutionModel; }
+        const std::string&           getEntryPoint()     const { return mEntryPoint; }
+        const std::vector<Variable>& getVariables()      const { return mVariables; }
+
+    private:
+        static uint64_t memberKey(const uint32_t structId, const uint32_t member)
+        {
+            return (static_cast<uint64_t>(structId) << 32) | member;
+        }
+
+        void parseInstruction(const uint32_t opcode, const std::span<const uint32_t> operands)
+        {
+            switch (opcode)
+            {
+                case spv::OpEntryPoint:
+                    if (mEntryPoint.empty() and operands.size() >= 3)
+                    {
+                        mExecutionModel = operands[0];
+                        mEntryPoint     = reinterpret_cast<const char*>(operands.data() + 2);
+                    }
+                    break;
+                case spv::OpTypeBool:
+                case spv::OpTypeInt:
+                case spv::OpTypeFloat:
+                case spv::OpTypeVector:
+                case spv::OpTypeMatrix:
+                case spv::OpTypeImage:
+                case spv::OpTypeSampler:
+                case spv::OpTypeSampledImage:
+                case spv::OpTypeArray:
+                case spv::OpTypeRuntimeArray:
+                case spv::OpTypeStruct:
+                case spv::OpTypePointer:
+                case spv::OpTypeAccelerationStructure:
+                    mTypes[operands[0]] = { opcode, { std::begin(operands) + 1, std::end(operands) } };
+                    break;
+                case spv::OpConstant:
+                    mConstants[operands[1]] = operands[2];
+                    break;
+                case spv::OpVariable:
+                    mVariables.push_back({ operands[1], operands[0], operands[2] });
+                    break;
+                case spv::OpDecorate:
+                    decorate(mDecorations[operands[0]], operands[1], operands.subspan(2));
+                    break;
+                case spv::OpMemberDecorate:
+                {
+                    auto& decorations = mMemberDecorations[memberKey(operands[0], operands[1])];
+                    if (operands[2] == spv::DecorationOffset)       decorations.offset       = operands[3];
+                    if (operands[2] == spv::DecorationMatrixStride) decorations.matrixStride = operands[3];
+                    break;
+                }
+                default:
+                    break;
+            }
+        }
+
+        static void decorate(Decorations& decorations, const uint32_t decoration, const std::span<const uint32_t> literals)
+        {
+            switch (decoration)
+            {
+                case spv::DecorationDescriptorSet: decorations.set         = literals[0]; break;
+                case spv::DecorationBinding:       decorations.binding     = literals[0]; break;
+                case spv::DecorationLocation:      decorations.location    = literals[0]; break;
+                case spv::DecorationArrayStride:   decorations.arrayStride = literals[0]; break;
+                case spv::DecorationBuiltIn:       decorations.builtIn     = true;        break;
+                case spv::DecorationBlock:         decorations.block       = true;        break;
+                case spv::DecorationBufferBlock:   decorations.bufferBlock = true;        break;
+                default: break;
+            }
+        }
+
+        uint32_t                                        mExecutionModel {0};
+        std::string                                     mEntryPoint;
+        std::unordered_map<uint32_t, Type>              mTypes;
+        std::unordered_map<uint32_t, uint32_t>          mConstants;
+        std::unordered_map<uint32_t, Decorations>       mDecorations;
+        std::unordered_map<uint64_t, MemberDecorations> mMemberDecorations;
+        std::vector<Variable>                           mVariables;
+    };
+
+    vk::ShaderStageFlagBits toShaderStage(const uint32_t executionModel)
+    {
+        switch (executionModel)
+        {
+            case 0:    return vk::ShaderStageFlagBits::eVertex;
+            case 1:    return vk::ShaderStageFlagBits::eTessellationControl;
+            case 2:    return vk::ShaderStageFlagBits::eTessellationEvaluation;
+            case 3:    return vk::ShaderStageFlagBits::eGeometry;
+            case 4:    return vk::ShaderStageFlagBits::eFragment;
+            case 5:    return vk::ShaderStageFlagBits::eCompute;
+            case 5313: return vk::ShaderStageFlagBits::eRaygenKHR;
+            case 5314: return vk::ShaderStageFlagBits::eIntersectionKHR;
+            case 5315: return vk::ShaderStageFlagBits::eAnyHitKHR;
+            case 5316: return vk::ShaderStageFlagBits::eClosestHitKHR;
+            case 5317: return vk::ShaderStageFlagBits::eMissKHR;
+            case 5318: return vk::ShaderStageFlagBits::eCallableKHR;
+            case 5364: return vk::ShaderStageFlagBits::eTaskEXT;
+            case 5365: return vk::ShaderStageFlagBits::eMeshEXT;
+            default:
+                throw std::runtime_error(fmt::format("Unsupported SPIR-V execution model {}", executionModel));
+        }
+    }
+
+    vk::DescriptorType toDescriptorType(const SpirvModule& module, const uint32_t typeId, const uint32_t storageClass)
+    {
+        const Type& type = module.getType(typeId);
+
+        if (storageClass == spv::StorageClassStorageBuffer)
+        {
+            return vk::DescriptorType::eStorageBuffer;
+        }
+        if (storageClass == spv::StorageClassUniform)
+        {
+            return module.getDecorations(typeId).bufferBlock ? vk::DescriptorType::eStorageBuffer : vk::DescriptorType::eUniformBuffer;
+        }
+
+        switch (type.opcode)
+        {
+            case spv::OpTypeSampler:                return vk::DescriptorType::eSampler;
+            case spv::OpTypeSampledImage:           return vk::DescriptorType::eCombinedImageSampler;
+            case spv::OpTypeAccelerationStructure:  return vk::DescriptorType::eAccelerationStructureKHR;
+            case spv::OpTypeImage:
+            {
+                // Operands: sampled type, dim, depth, arrayed, multisampled, sampled (1 = with sampler, 2 = storage)
+                const uint32_t dim     = type.operands[1];
+                const bool     storage = type.operands[5] == 2;
+                if (dim == spv::DimSubpassData) return vk::DescriptorType::eInputAttachment;
+                if (dim == spv::DimBuffer)      return storage ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+                return storage ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+            }
+            default:
+                throw std::runtime_error(fmt::format("Unsupported SPIR-V descriptor type with opcode {}", type.opcode));
+        }
+    }
+
+    vk::Format toVertexFormat(const Type& scalarType, const uint32_t componentCount)
+    {
+        static constexpr std::array floatFormats = { vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat };
+        static constexpr std::array sintFormats  = { vk::Format::eR32Sint,   vk::Format::eR32G32Sint,   vk::Format::eR32G32B32Sint,   vk::Format::eR32G32B32A32Sint };
+        static constexpr std::array uintFormats  = { vk::Format::eR32Uint,   vk::Format::eR32G32Uint,   vk::Format::eR32G32B32Uint,   vk::Format::eR32G32B32A32Uint };
+
+        if (scalarType.operands[0] != 32 or componentCount < 1 or componentCount > 4)
+        {
+            throw std::runtime_error("Only 32-bit scalar and vector vertex inputs are supported");
+        }
+
+        if (scalarType.opcode == spv::OpTypeFloat)
+        {
+            return floatFormats[componentCount - 1];
+        }
+        return (scalarType.operands[1] != 0) ? sintFormats[componentCount - 1] : uintFormats[componentCount - 1];
+    }
+
+    void reflectVertexInput(const SpirvModule& module, const uint32_t location, const uint32_t typeId, std::vector<VulkanReflectedVertexInput>& inputs)
+    {
+        const Type& type = module.getType(typeId);
+        switch (type.opcode)
+        {
+            case spv::OpTypeInt:
+            case spv::OpTypeFloat:
+                inputs.push_back({ location, toVertexFormat(type, 1), 4 });
+                break;
+            case spv::OpTypeVector:
+                inputs.push_back({ location, toVertexFormat(module.getType(type.operands[0]), type.operands[1]), 4 * type.operands[1] });
+                break;
+            case spv::OpTypeMatrix:
+                // Every column takes a location of its own
+                for (uint32_t column = 0; column < type.operands[1]; column++)
+                {
+                    reflectVertexInput(module, location + column, type.operands[0], inputs);
+                }
+                break;
+            default:
+                throw std::runtime_error(fmt::format("Unsupported SPIR-V vertex input type with opcode {}", type.opcode));
+        }
+    }
+}
+
+VulkanShaderReflection VulkanShaderReflection::reflect(const std::span<const uint32_t> code)
+{
+    const SpirvModule module(code);
+
+    VulkanShaderReflection reflection;
+    reflection.stage      = toShaderStage(module.getExecutionModel());
+    reflection.entryPoint = module.getEntryPoint();
+
+    for (const Variable& variable : module.getVariables())
+    {
+        const Decorations& decorations = module.getDecorations(variable.id);
+        uint32_t typeId = module.getPointee(variable.pointerType);
+
+        switch (variable.storageClass)
+        {
+            case spv::StorageClassUniformConstant:
+            case spv::StorageClassUniform:
+            case spv::StorageClassStorageBuffer:
+            {
+                if (!decorations.binding.has_value())
+                {
+                    continue;
+                }
+
+                uint32_t descriptorCount = 1;
+                while (true)
+                {
+                    const Type& type = module.getType(typeId);
+                    if (type.opcode == spv::OpTypeArray)
+                    {
+                        descriptorCount *= module.getConstant(type.operands[1]);
+                    }
+                    else if (type.opcode == spv::OpTypeRuntimeArray)
+                    {
+                        descriptorCount = 0;
+                    }
+                    else
+                    {
+                        break;
+                    }
+                    typeId = type.operands[0];
+                }
+
+                const auto binding = vk::DescriptorSetLayoutBinding()
+                    .setBinding(decorations.binding.value())
+                    .setDescriptorType(toDescriptorType(module, typeId, variable.storageClass))
+                    .setDescriptorCount(descriptorCount)
+                    .setStageFlags(reflection.stage);
+                reflection.descriptorBindings.push_back({ decorations.set.value_or(0), binding });
+                break;
+            }
+            case spv::StorageClassPushConstant:
+            {
+                const Type& type = module.getType(typeId);
+                uint32_t offset = std::numeric_limits<uint32_t>::max();
+                for (uint32_t member = 0; member < type.operands.size(); member++)
+                {
+                    offset = std::min(offset, module.getMemberDecorations(typeId, member).offset);
+                }
+                if (type.operands.empty())
+                {
+                    continue;
+                }
+
+                reflection.pushConstantRange = vk::PushConstantRange()
+                    .setStageFlags(reflection.stage)
+                    .setOffset(offset)
+                    .setSize(module.getSize(typeId) - offset);
+                break;
+            }
+            case spv::StorageClassInput:
+            {
+                if (reflection.stage != vk::ShaderStageFlagBits::eVertex or decorations.builtIn or !decorations.location.has_value())
+                {
+                    continue;
+                }
+                reflectVertexInput(module, decorations.location.value(), typeId, reflection.vertexInputs);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+
+    std::ranges::sort(reflection.descriptorBindings, [](const VulkanReflectedBinding& lhs, const VulkanReflectedBinding& rhs) {
+        return std::tie(lhs.set, lhs.binding.binding) < std::tie(rhs.set, rhs.binding.binding);
+    });
+    std::ranges::sort(reflection.vertexInputs, {}, &VulkanReflectedVertexInput::location);
+
+    return reflection;
+}
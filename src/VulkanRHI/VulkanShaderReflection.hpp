@@ -0,0 +1,36 @@
+#pragma once
+
+#include <span>
+#include "VulkanBase.hpp"
+
+struct VulkanReflectedBinding
+{
+    uint32_t                       set;
+    vk::DescriptorSetLayoutBinding binding;
+};
+
+struct VulkanReflectedVertexInput
+{
+    uint32_t   location;
+    vk::Format format;
+    // Bytes the attribute occupies in a tightly packed vertex
+    uint32_t   size;
+};
+
+/**
+ * Resource interface of a SPIR-V module: descriptor bindings, the push constant block and, for vertex shaders, the vertex inputs.
+ * Only the first entry point is reflected. Runtime sized descriptor arrays are reported with a descriptor count of 0.
+ */
+struct VulkanShaderReflection
+{
+    vk::ShaderStageFlagBits                     stage {};
+    std::string                                 entryPoint;
+    // Sorted by set, then by binding
+    std::vector<VulkanReflectedBinding>         descriptorBindings;
+    std::optional<vk::PushConstantRange>        pushConstantRange;
+    // Sorted by location, empty for stages other than vertex
+    std::vector<VulkanReflectedVertexInput>     vertexInputs;
+
+    // Throws if the code isn't valid SPIR-V or uses types the reflection doesn't understand
+    static VulkanShaderReflection reflect(std::span<const uint32_t> code);
+};
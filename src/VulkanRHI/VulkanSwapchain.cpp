@@ -51,7 +51,7 @@ void VulkanSwapchain::present(const vk::Semaphore signalSemaphore, const uint32_
         .setImageIndices(imageIndex)
         .setPResults(nullptr);
 
-    if (const auto result = mDevice->getGraphicsQueue()->getQueue().presentKHR(&presentInfo);
+    if (const auto result = mDevice->getGraphicsQueue()->present(presentInfo);
         result != vk::Result::eSuccess)
     {
         throw std::runtime_error("Failed to present to swapchain");
@@ -60,9 +60,9 @@ void VulkanSwapchain::present(const vk::Semaphore signalSemaphore, const uint32_
 
 void VulkanSwapchain::setScissorViewport(RHICommandList* commandList) const
 {
-    const auto commandBuffer = commandList->as<VulkanCommandList>()->handle();
-    commandBuffer.setScissor(0, 1, &mCachedScissor);
-    commandBuffer.setViewport(0, 1, &mCachedViewport);
+    // Through the RHI interface, so deferred streams record the state as well
+    commandList->setScissor(toRHI(mCachedScissor));
+    commandList->setViewport(toRHI(mCachedViewport));
 }
 
 vk::ImageView VulkanSwapchain::getImageView(const size_t i) const
@@ -177,8 +177,8 @@ void VulkanSwapchain::acquireImages()
         .setSubresourceRange({ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 })
         .setViewType(vk::ImageViewType::e2D);
 
-    mImageViews.resize(mImageCount);
-    for (uint32_t i = 0; i < mImageCount; i++)
+    mImageViews.resize(mImages.size());
+    for (uint32_t i = 0; i < mImageViews.size(); i++)
     {
         create_info.setImage(mImages[i]);
         if (const vk::Result result = mDevice->handle().createImageView(&create_info, nullptr, &mImageViews[i]);
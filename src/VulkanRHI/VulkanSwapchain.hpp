@@ -34,7 +34,8 @@ public:
     Size2D   getSize()        const override { return toRHI(mExtent); }
     float    getAspectRatio() const override { return mAspectRatio; }
     Format   getFormat()      const override { return toRHI(mFormat); }
-    uint32_t getFrameCount()        override { return mImageCount; }
+    // The driver may create more images than requested
+    uint32_t getFrameCount()        override { return static_cast<uint32_t>(mImages.size()); }
 
 
     vk::Extent2D getExtent()   const { return mExtent; }
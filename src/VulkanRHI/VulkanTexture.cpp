@@ -1,5 +1,6 @@
 #include "VulkanTexture.hpp"
 
+#include "VulkanAliasingAllocator.hpp"
 #include "VulkanDevice.hpp"
 #include "VulkanAllocator.hpp"
 
@@ -7,38 +8,32 @@ VulkanTexture::VulkanTexture(const VulkanTextureCreateInfo& createInfo)
 : RHITexture()
 , mSize(toVulkan(createInfo.size))
 , mFormat(toVulkan(createInfo.format))
+, mSampled(createInfo.sampled)
+, mRelocatable(createInfo.relocatable)
+, mAliasingAllocator(createInfo.pAliasingAllocator)
 , mDevice(createInfo.pDevice)
 , mDebugName(createInfo.debugName)
 {
     using enum vk::ImageUsageFlagBits;
-    auto usageFlags = eTransferSrc | eTransferDst | eStorage;
+    mUsageFlags = eTransferSrc | eTransferDst | eStorage;
 
     if (isDepthFormat(createInfo.format))
     {
-        usageFlags |= eDepthStencilAttachment;
+        mUsageFlags |= eDepthStencilAttachment;
+        mAspectFlags = vk::ImageAspectFlagBits::eDepth;
     }
     else
     {
-        usageFlags |= eColorAttachment;
+        mUsageFlags |= eColorAttachment;
+        mAspectFlags = vk::ImageAspectFlagBits::eColor;
     }
 
     if (createInfo.sampled)
     {
-        usageFlags |= eSampled;
+        mUsageFlags |= eSampled;
     }
 
-    const auto imageCreateInfo = vk::ImageCreateInfo()
-        .setFormat(mFormat)
-        .setExtent({ mSize.width, mSize.height, 1 })
-        .setSamples(vk::SampleCountFlagBits::e1)
-        .setUsage(usageFlags)
-        .setTiling(vk::ImageTiling::eOptimal)
-        .setArrayLayers(1)
-        .setMipLevels(1)
-        .setImageType(vk::ImageType::e2D)
-        .setSharingMode(vk::SharingMode::eExclusive)
-        .setInitialLayout(vk::ImageLayout::eUndefined);
-
+    const auto imageCreateInfo = getImageCreateInfo();
     if (const vk::Result result = mDevice->handle().createImage(&imageCreateInfo, nullptr, &mImage);
         result != vk::Result::eSuccess)
     {
@@ -52,39 +47,22 @@ VulkanTexture::VulkanTexture(const VulkanTextureCreateInfo& createInfo)
         .handle = mImage,
     });
 
-    mAllocation = mDevice->allocateMemory({
-        .propertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal,
-        .target = mImage
-    });
-    mAllocation->bind();
-
-    auto viewCreateInfo = vk::ImageViewCreateInfo()
-        .setFormat(mFormat)
-        .setImage(mImage)
-        .setViewType(vk::ImageViewType::e2D);
-
-    if (isDepthFormat(createInfo.format))
+    if (isTransient())
     {
-        viewCreateInfo.setSubresourceRange({ vk::ImageAspectFlagBits::eDepth, 0, 1, 0, 1 });
+        mAliasingAllocator->bind(mImage, createInfo.lifetime);
     }
     else
     {
-        viewCreateInfo.setSubresourceRange({ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 });
+        mAllocation = mDevice->allocateMemory({
+            .propertyFlags = vk::MemoryPropertyFlagBits::eDeviceLocal,
+            .target = mImage,
+            .avoidedFlags = vk::MemoryPropertyFlagBits::eHostVisible,
+        });
+        mAllocation->bind();
+        mAllocation->setOwner(this);
     }
 
-    if (const vk::Result result = mDevice->handle().createImageView(&viewCreateInfo, nullptr, &mImageView);
-        result != vk::Result::eSuccess)
-    {
-        const auto msg = fmt::format("Failed to create ImageView \"{}\" ({})", mDebugName, to_string(result));
-        VK_PRINTLN(msg);
-        throw std::runtime_error(msg);
-    }
-
-    const auto viewName = fmt::format("{} [ImageView]", mDebugName);
-    mDevice->nameObject<vk::ImageView>({
-        .debugName = viewName.c_str(),
-        .handle = mImageView,
-    });
+    mImageView = createImageView(mImage);
 
     if (createInfo.sampled)
     {
@@ -129,8 +107,180 @@ std::unique_ptr<VulkanTexture> VulkanTexture::createVulkanTexture(const VulkanTe
 
 VulkanTexture::~VulkanTexture()
 {
+    // The aliasing allocator looks the image up by handle, so it has to be released while the handle is still valid
+    if (isTransient())
+    {
+        mAliasingAllocator->release(mImage);
+    }
+
     mDevice->handle().destroy(mSampler);
     mDevice->handle().destroy(mImageView);
     mDevice->handle().destroy(mImage);
-    mAllocation->free();
+
+    mDevice->freeMemory(mAllocation);
+}
+
+bool VulkanTexture::isAliased() const
+{
+    return isTransient() and mAliasingAllocator->isAliased(mImage);
+}
+
+vk::MemoryBarrier2 VulkanTexture::getAliasingBarrier() const
+{
+    using enum vk::PipelineStageFlagBits2;
+    using enum vk::AccessFlagBits2;
+
+    vk::PipelineStageFlags2 dstStages;
+    vk::AccessFlags2        dstAccess;
+
+    if (mUsageFlags & vk::ImageUsageFlagBits::eColorAttachment)
+    {
+        dstStages |= eColorAttachmentOutput;
+        dstAccess |= eColorAttachmentRead | eColorAttachmentWrite;
+    }
+    if (mUsageFlags & vk::ImageUsageFlagBits::eDepthStencilAttachment)
+    {
+        dstStages |= eEarlyFragmentTests | eLateFragmentTests;
+        dstAccess |= eDepthStencilAttachmentRead | eDepthStencilAttachmentWrite;
+    }
+    if (mUsageFlags & vk::ImageUsageFlagBits::eSampled)
+    {
+        dstStages |= eVertexShader | eFragmentShader | eComputeShader;
+        dstAccess |= eShaderSampledRead;
+    }
+    if (mUsageFlags & vk::ImageUsageFlagBits::eStorage)
+    {
+        dstStages |= eVertexShader | eFragmentShader | eComputeShader;
+        dstAccess |= eShaderStorageRead | eShaderStorageWrite;
+    }
+    if (mUsageFlags & (vk::ImageUsageFlagBits::eTransferSrc | vk::ImageUsageFlagBits::eTransferDst))
+    {
+        dstStages |= eAllTransfer;
+        dstAccess |= eTransferRead | eTransferWrite;
+    }
+
+    // Contents are discarded, only accesses of earlier occupants of the memory have to complete first
+    return vk::MemoryBarrier2()
+        .setSrcStageMask(eAllCommands)
+        .setSrcAccessMask(eMemoryWrite)
+        .setDstStageMask(dstStages)
+        .setDstAccessMask(dstAccess);
+}
+
+std::optional<VulkanRetiredResource> VulkanTexture::relocate(const vk::CommandBuffer commandBuffer)
+{
+    const auto imageCreateInfo = getImageCreateInfo();
+
+    vk::Image image;
+    VK_CHECK(image = mDevice->handle().createImage(imageCreateInfo););
+
+    const auto allocationInfo = VulkanAllocationInfo()
+        .setTarget(image)
+        .setPropertyFlags(vk::MemoryPropertyFlagBits::eDeviceLocal)
+        .setAvoidedFlags(vk::MemoryPropertyFlagBits::eHostVisible)
+        .setRelocationSource(mAllocation->getBlock());
+
+    VulkanAllocation* allocation = mDevice->allocateMemory(allocationInfo);
+    if (allocation == nullptr)
+    {
+        mDevice->handle().destroy(image);
+        return std::nullopt;
+    }
+    allocation->bind();
+
+    const auto subresourceRange = vk::ImageSubresourceRange(mAspectFlags, 0, 1, 0, 1);
+
+    const auto barrier = [&](const vk::Image target, const vk::ImageLayout oldLayout, const vk::ImageLayout newLayout) {
+        const bool toTransfer = (newLayout != vk::ImageLayout::eShaderReadOnlyOptimal);
+        return vk::ImageMemoryBarrier2()
+            .setSrcStageMask(toTransfer ? vk::PipelineStageFlagBits2::eAllCommands : vk::PipelineStageFlagBits2::eCopy)
+            .setSrcAccessMask(toTransfer ? vk::AccessFlagBits2::eNone : vk::AccessFlagBits2::eTransferWrite)
+            .setDstStageMask(toTransfer ? vk::PipelineStageFlagBits2::eCopy : vk::PipelineStageFlagBits2::eAllCommands)
+            .setDstAccessMask(toTransfer ? vk::AccessFlagBits2::eTransferRead | vk::AccessFlagBits2::eTransferWrite : vk::AccessFlagBits2::eShaderSampledRead)
+            .setOldLayout(oldLayout)
+            .setNewLayout(newLayout)
+            .setImage(target)
+            .setSubresourceRange(subresourceRange);
+    };
+
+    const std::array toTransfer = {
+        barrier(mImage, vk::ImageLayout::eShaderReadOnlyOptimal, vk::ImageLayout::eTransferSrcOptimal),
+        barrier(image, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal),
+    };
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(toTransfer));
+
+    const auto imageCopy = vk::ImageCopy()
+        .setSrcSubresource({ mAspectFlags, 0, 0, 1 })
+        .setDstSubresource({ mAspectFlags, 0, 0, 1 })
+        .setExtent({ mSize.width, mSize.height, 1 });
+    commandBuffer.copyImage(mImage, vk::ImageLayout::eTransferSrcOptimal, image, vk::ImageLayout::eTransferDstOptimal, 1, &imageCopy);
+
+    // The old image goes back to its previous layout, as frames still in flight may sample it
+    const std::array toShaderRead = {
+        barrier(mImage, vk::ImageLayout::eTransferSrcOptimal, vk::ImageLayout::eShaderReadOnlyOptimal),
+        barrier(image, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal),
+    };
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(toShaderRead));
+
+    const VulkanRetiredResource retired = {
+        .handle     = mImage,
+        .imageView  = mImageView,
+        .allocation = mAllocation,
+    };
+
+    mAllocation->setOwner(nullptr);
+    allocation->setOwner(this);
+
+    mImage      = image;
+    mImageView  = createImageView(mImage);
+    mAllocation = allocation;
+    mRelocationGeneration++;
+
+    mDevice->nameObject<vk::Image>({
+        .debugName = mDebugName.c_str(),
+        .handle = mImage,
+    });
+
+    return retired;
+}
+
+vk::ImageCreateInfo VulkanTexture::getImageCreateInfo() const
+{
+    return vk::ImageCreateInfo()
+        .setFormat(mFormat)
+        .setExtent({ mSize.width, mSize.height, 1 })
+        .setSamples(vk::SampleCountFlagBits::e1)
+        .setUsage(mUsageFlags)
+        .setTiling(vk::ImageTiling::eOptimal)
+        .setArrayLayers(1)
+        .setMipLevels(1)
+        .setImageType(vk::ImageType::e2D)
+        .setSharingMode(vk::SharingMode::eExclusive)
+        .setInitialLayout(vk::ImageLayout::eUndefined);
+}
+
+vk::ImageView VulkanTexture::createImageView(const vk::Image image) const
+{
+    const auto viewCreateInfo = vk::ImageViewCreateInfo()
+        .setFormat(mFormat)
+        .setImage(image)
+        .setViewType(vk::ImageViewType::e2D)
+        .setSubresourceRange({ mAspectFlags, 0, 1, 0, 1 });
+
+    vk::ImageView imageView;
+    if (const vk::Result result = mDevice->handle().createImageView(&viewCreateInfo, nullptr, &imageView);
+        result != vk::Result::eSuccess)
+    {
+        const auto msg = fmt::format("Failed to create ImageView \"{}\" ({})", mDebugName, to_string(result));
+        VK_PRINTLN(msg);
+        throw std::runtime_error(msg);
+    }
+
+    const auto viewName = fmt::format("{} [ImageView]", mDebugName);
+    mDevice->nameObject<vk::ImageView>({
+        .debugName = viewName.c_str(),
+        .handle = imageView,
+    });
+
+    return imageView;
 }
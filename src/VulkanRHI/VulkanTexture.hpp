@@ -1,21 +1,27 @@
 #pragma once
 
+#include "VulkanAllocator.hpp"
 #include "VulkanBase.hpp"
 #include <RHI/RHITexture.hpp>
 
+class VulkanAliasingAllocator;
 class VulkanDevice;
-class VulkanAllocation;
 
 struct VulkanTextureCreateInfo
 {
-    Size2D          size;
-    Format          format  {Format::R32G32B32A32Sfloat};
-    bool            sampled {true};
-    std::string     debugName;
-    VulkanDevice*   pDevice;
+    Size2D                      size;
+    Format                      format  {Format::R32G32B32A32Sfloat};
+    bool                        sampled {true};
+    std::string                 debugName;
+    VulkanDevice*               pDevice;
+    // Set for transient textures, memory is then shared with transients of non-overlapping lifetimes
+    VulkanAliasingAllocator*    pAliasingAllocator {nullptr};
+    RHITextureLifetime          lifetime {};
+    // Opts into defragmentation, the owner must rebuild what it derived from the image or view on a new generation
+    bool                        relocatable {false};
 };
 
-class VulkanTexture : public RHITexture
+class VulkanTexture : public RHITexture, public VulkanRelocatable
 {
 public:
     DISABLE_COPY_CTOR(VulkanTexture);
@@ -26,16 +32,54 @@ public:
     const vk::Image&        getImage()      const { return mImage; }
     const vk::ImageView&    getImageView()  const { return mImageView; }
     const vk::Sampler&      getSampler()    const { return mSampler; }
+    vk::Extent2D            getExtent()     const { return mSize; }
+    vk::Format              getFormat()     const { return mFormat; }
+
+    // Layout the image is left in between frames, eUndefined until it was first written
+    vk::ImageLayout         getLayout()     const { return mLayout; }
+    void                    setLayout(const vk::ImageLayout layout) { mLayout = layout; }
+
+    // Textures referenced by framebuffers keep their image and view, and are never relocated
+    void                    pin() { mPinned = true; }
+
+    bool                    isTransient()   const { return mAliasingAllocator != nullptr; }
+
+    // Whether the memory of this texture is currently shared with other transient textures
+    bool                    isAliased()     const;
+
+    // Orders the first use of an aliased texture after other textures' accesses to the shared memory,
+    // covering every stage the texture's usage flags allow it to be accessed in
+    vk::MemoryBarrier2      getAliasingBarrier() const;
+
+    uint32_t                getGeneration() const override { return getRelocationGeneration(); }
+
+    bool isRelocatable() const override
+    {
+        return mRelocatable and mSampled and !mPinned and !isTransient() and mLayout == vk::ImageLayout::eShaderReadOnlyOptimal;
+    }
+
+    std::optional<VulkanRetiredResource> relocate(vk::CommandBuffer commandBuffer) override;
 
 private:
-    vk::Image           mImage;
-    vk::ImageView       mImageView;
-    vk::Sampler         mSampler;
+    vk::ImageCreateInfo     getImageCreateInfo() const;
+
+    vk::ImageView           createImageView(vk::Image image) const;
+
+    vk::Image               mImage;
+    vk::ImageView           mImageView;
+    vk::Sampler             mSampler;
 
-    vk::Extent2D        mSize;
-    vk::Format          mFormat;
+    vk::Extent2D            mSize;
+    vk::Format              mFormat;
+    vk::ImageUsageFlags     mUsageFlags;
+    vk::ImageAspectFlags    mAspectFlags;
+    vk::ImageLayout         mLayout {vk::ImageLayout::eUndefined};
+    bool                    mSampled;
+    bool                    mPinned {false};
+    bool                    mRelocatable;
 
-    VulkanAllocation*   mAllocation;
-    VulkanDevice*       mDevice;
-    std::string         mDebugName;
+    VulkanAllocation*       mAllocation {nullptr};
+    VulkanAliasingAllocator* mAliasingAllocator;
+    VulkanDevice*           mDevice;
+    std::string             mDebugName;
 };
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "VulkanTransientAllocator.hpp"
+
+// Transient data may be consumed through any of these bindings
+static constexpr vk::BufferUsageFlags sTransientUsage = vk::BufferUsageFlagBits::eVertexBuffer
+                                                      | vk::BufferUsageFlagBits::eIndexBuffer
+                                                      | vk::BufferUsageFlagBits::eUniformBuffer
+                                                      | vk::BufferUsageFlagBits::eStorageBuffer
+                                                      | vk::BufferUsageFlagBits::eIndirectBuffer;
+
+VulkanTransientAllocator::VulkanTransientAllocator(const VulkanTransientAllocatorCreateInfo& createInfo)
+: mDevice(createInfo.pDevice)
+{
+    const uint64_t regionAlignment = getUsageAlignment(Uniform);
+    mRegionSize = createInfo.bufferSize / createInfo.framesInFlight / regionAlignment * regionAlignment;
+
+    mBuffer = VulkanBuffer::createVulkanBuffer({
+        .bufferSize      = mRegionSize * createInfo.framesInFlight,
+        .bufferType      = Uniform,
+        .pDevice         = mDevice,
+        .debugName       = "Transient Ring Buffer",
+        .additionalUsage = sTransientUsage,
+    });
+
+    mFrameRegions.resize(createInfo.framesInFlight);
+    for (uint32_t i = 0; i < createInfo.framesInFlight; i++)
+    {
+        mFrameRegions[i].begin = i * mRegionSize;
+        mFrameRegions[i].head  = mFrameRegions[i].begin;
+    }
+}
+
+std::unique_ptr<VulkanTransientAllocator> VulkanTransientAllocator::createVulkanTransientAllocator(const VulkanTransientAllocatorCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanTransientAllocator>(createInfo);
+}
+
+RHITransientAllocation VulkanTransientAllocator::allocate(const uint32_t frameIndex, const uint64_t size, const uint64_t alignment, const RHIBufferType usage)
+{
+    const uint64_t effectiveAlignment = std::max<uint64_t>({ alignment, getUsageAlignment(usage), 1 });
+
+    std::lock_guard lock(mMutex);
+    auto& region = mFrameRegions[frameIndex];
+
+    const uint64_t offset = (region.head + effectiveAlignment - 1) / effectiveAlignment * effectiveAlignment;
+
+    if (offset + size <= region.begin + mRegionSize)
+    {
+        region.head = offset + size;
+        return {
+            .buffer = mBuffer.get(),
+            .offset = offset,
+            .size   = size,
+            .pData  = static_cast<char*>(mBuffer->getMappedData()) + offset,
+        };
+    }
+
+    // The region is exhausted, fall back to a buffer that lives until the frame is reclaimed
+    VK_DEBUG(fmt::format("{}", styled(fmt::format("Transient region of frame {} exhausted, allocating {} byte overflow buffer", frameIndex, size), fg(fmt::color::light_yellow))));
+
+    region.overflowBuffers.push_back(VulkanBuffer::createVulkanBuffer({
+        .bufferSize      = size,
+        .bufferType      = Uniform,
+        .pDevice         = mDevice,
+        .debugName       = "Transient Overflow Buffer",
+        .additionalUsage = sTransientUsage,
+    }));
+
+    auto* overflowBuffer = region.overflowBuffers.back().get();
+    return {
+        .buffer = overflowBuffer,
+        .offset = 0,
+        .size   = size,
+        .pData  = overflowBuffer->getMappedData(),
+    };
+}
+
+void VulkanTransientAllocator::reset(const uint32_t frameIndex)
+{
+    std::lock_guard lock(mMutex);
+    auto& region = mFrameRegions[frameIndex];
+    region.head = region.begin;
+    region.overflowBuffers.clear();
+}
+
+void VulkanTransientAllocator::flush(const uint32_t frameIndex) const
+{
+    std::lock_guard lock(mMutex);
+    const auto& region = mFrameRegions[frameIndex];
+    if (region.head > region.begin)
+    {
+        mBuffer->flush(region.begin, region.head - region.begin);
+    }
+
+    for (const auto& overflowBuffer : region.overflowBuffers)
+    {
+        overflowBuffer->flush();
+    }
+}
+
+uint64_t VulkanTransientAllocator::getUsageAlignment(const RHIBufferType usage) const
+{
+    const auto& limits = mDevice->getProperties().limits;
+    switch (usage)
+    {
+        case Uniform:   return limits.minUniformBufferOffsetAlignment;
+        case Storage:   return limits.minStorageBufferOffsetAlignment;
+        case Index:
+        case Indirect:
+        case Vertex:    return sizeof(uint32_t);
+        default:        return 1;
+    }
+}
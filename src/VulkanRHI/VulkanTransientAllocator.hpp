@@ -0,0 +1,54 @@
+#pragma once
+
+#include <mutex>
+#include "VulkanBase.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanDevice.hpp"
+
+struct VulkanTransientAllocatorCreateInfo
+{
+    uint64_t        bufferSize {16ull * 1024 * 1024};
+    uint32_t        framesInFlight {2};
+    VulkanDevice*   pDevice {nullptr};
+};
+
+/**
+ * Persistently mapped ring buffer for per-frame transient data (draw constants, streamed vertices, ...).
+ * The ring is split into one linear region per frame in flight. A region is bump-allocated while its frame
+ * is recorded and reclaimed as a whole once the frame's fence has signaled.
+ * Allocations may be made from any thread, e.g. by parallel recording tasks.
+ */
+class VulkanTransientAllocator
+{
+public:
+    DISABLE_COPY_CTOR(VulkanTransientAllocator);
+    explicit DEF_PRIMARY_CTOR(VulkanTransientAllocator, const VulkanTransientAllocatorCreateInfo& createInfo);
+
+    ~VulkanTransientAllocator() = default;
+
+    RHITransientAllocation allocate(uint32_t frameIndex, uint64_t size, uint64_t alignment, RHIBufferType usage);
+
+    // Reclaims every allocation made for the frame, the frame's fence must have signaled before calling this
+    void reset(uint32_t frameIndex);
+
+    // Flushes the written part of the frame's region, required before submitting the frame
+    void flush(uint32_t frameIndex) const;
+
+private:
+    struct FrameRegion
+    {
+        uint64_t                                   begin  {0};
+        uint64_t                                   head   {0};
+        std::vector<std::unique_ptr<VulkanBuffer>> overflowBuffers;
+    };
+
+    uint64_t getUsageAlignment(RHIBufferType usage) const;
+
+    std::unique_ptr<VulkanBuffer> mBuffer;
+    std::vector<FrameRegion>      mFrameRegions;
+    uint64_t                      mRegionSize;
+    // Guards the region heads and overflow buffers
+    mutable std::mutex            mMutex;
+
+    VulkanDevice*                 mDevice;
+};
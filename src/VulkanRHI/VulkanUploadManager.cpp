@@ -0,0 +1,446 @@
+#include "VulkanUploadManager.hpp"
+
+#include <numeric>
+
+static constexpr uint64_t sStagingAlignment = 16;
+
+VulkanUploadManager::VulkanUploadManager(const VulkanUploadManagerCreateInfo& createInfo)
+: mStagingSize(createInfo.stagingSize)
+, mOwnershipTransfer(createInfo.pTransferQueue->getQueueFamilyIndex() != createInfo.pGraphicsQueue->getQueueFamilyIndex())
+, mTransferQueue(createInfo.pTransferQueue)
+, mGraphicsQueue(createInfo.pGraphicsQueue)
+, mDevice(createInfo.pDevice)
+{
+    mStagingRing = VulkanBuffer::createVulkanBuffer({
+        .bufferSize = mStagingSize,
+        .bufferType = Staging,
+        .pDevice    = mDevice,
+        .debugName  = "Upload Staging Ring",
+    });
+
+    auto poolCreateInfo = vk::CommandPoolCreateInfo()
+        .setQueueFamilyIndex(mTransferQueue->getQueueFamilyIndex())
+        .setFlags(vk::CommandPoolCreateFlagBits::eTransient | vk::CommandPoolCreateFlagBits::eResetCommandBuffer);
+
+    VK_CHECK(mCommandPool = mDevice->handle().createCommandPool(poolCreateInfo););
+
+    if (mOwnershipTransfer)
+    {
+        poolCreateInfo.setQueueFamilyIndex(mGraphicsQueue->getQueueFamilyIndex());
+        VK_CHECK(mAcquireCommandPool = mDevice->handle().createCommandPool(poolCreateInfo););
+    }
+
+    auto semaphoreTypeCreateInfo = vk::SemaphoreTypeCreateInfo()
+        .setSemaphoreType(vk::SemaphoreType::eTimeline)
+        .setInitialValue(0);
+
+    const auto semaphoreCreateInfo = vk::SemaphoreCreateInfo()
+        .setPNext(&semaphoreTypeCreateInfo);
+
+    VK_CHECK(mTimeline = mDevice->handle().createSemaphore(semaphoreCreateInfo););
+
+    mDevice->nameObject<vk::Semaphore>({
+        .debugName = "Upload Timeline",
+        .handle    = mTimeline,
+    });
+}
+
+std::unique_ptr<VulkanUploadManager> VulkanUploadManager::createVulkanUploadManager(const VulkanUploadManagerCreateInfo& createInfo)
+{
+    return std::make_unique<VulkanUploadManager>(createInfo);
+}
+
+VulkanUploadManager::~VulkanUploadManager()
+{
+    wait({ mLastSubmittedValue });
+
+    // Destroying the pools frees every batch command buffer, including an unsubmitted one
+    mDevice->handle().destroyCommandPool(mCommandPool);
+    if (mOwnershipTransfer)
+    {
+        mDevice->handle().destroyCommandPool(mAcquireCommandPool);
+    }
+    mDevice->handle().destroySemaphore(mTimeline);
+}
+
+RHIUploadToken VulkanUploadManager::upload(const VulkanBuffer* dstBuffer, const void* pData, const uint64_t dataSize, const uint64_t dstOffset)
+{
+    if (dataSize == 0)
+    {
+        return {};
+    }
+
+    const auto [stagingBuffer, stagingOffset] = stage(pData, dataSize, sStagingAlignment);
+
+    const auto bufferCopy = vk::BufferCopy()
+        .setSrcOffset(stagingOffset)
+        .setDstOffset(dstOffset)
+        .setSize(dataSize);
+
+    mOpenBatch->commandBuffer.copyBuffer(stagingBuffer->handle(), dstBuffer->handle(), 1, &bufferCopy);
+
+    if (mOwnershipTransfer and !dstBuffer->isConcurrent())
+    {
+        mOpenBatch->bufferReleases.push_back(vk::BufferMemoryBarrier2()
+            .setSrcStageMask(vk::PipelineStageFlagBits2::eCopy)
+            .setSrcAccessMask(vk::AccessFlagBits2::eTransferWrite)
+            .setSrcQueueFamilyIndex(mTransferQueue->getQueueFamilyIndex())
+            .setDstQueueFamilyIndex(mGraphicsQueue->getQueueFamilyIndex())
+            .setBuffer(dstBuffer->handle())
+            .setOffset(dstOffset)
+            .setSize(dataSize));
+    }
+
+    return { mOpenBatch->timelineValue };
+}
+
+RHIUploadToken VulkanUploadManager::upload(VulkanTexture* dstTexture, const void* pData, const uint64_t dataSize)
+{
+    if (dataSize == 0)
+    {
+        return {};
+    }
+
+    // Buffer offsets of image copies must be a multiple of the texel block size
+    const uint64_t alignment = std::lcm(sStagingAlignment, static_cast<uint64_t>(vk::blockSize(dstTexture->getFormat())));
+    const auto [stagingBuffer, stagingOffset] = stage(pData, dataSize, alignment);
+
+    constexpr auto subresourceRange = vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+    const auto commandBuffer = mOpenBatch->commandBuffer;
+
+    // Previous contents are discarded, so no ownership has to be acquired by the transfer queue first
+    const auto toTransferDst = vk::ImageMemoryBarrier2()
+        .setSrcStageMask(vk::PipelineStageFlagBits2::eNone)
+        .setSrcAccessMask(vk::AccessFlagBits2::eNone)
+        .setDstStageMask(vk::PipelineStageFlagBits2::eCopy)
+        .setDstAccessMask(vk::AccessFlagBits2::eTransferWrite)
+        .setOldLayout(vk::ImageLayout::eUndefined)
+        .setNewLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setImage(dstTexture->getImage())
+        .setSubresourceRange(subresourceRange);
+
+    commandBuffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(toTransferDst));
+
+    const auto extent = dstTexture->getExtent();
+    const auto bufferImageCopy = vk::BufferImageCopy()
+        .setBufferOffset(stagingOffset)
+        .setImageSubresource({ vk::ImageAspectFlagBits::eColor, 0, 0, 1 })
+        .setImageExtent({ extent.width, extent.height, 1 });
+
+    commandBuffer.copyBufferToImage(stagingBuffer->handle(), dstTexture->getImage(), vk::ImageLayout::eTransferDstOptimal, 1, &bufferImageCopy);
+
+    auto toShaderRead = vk::ImageMemoryBarrier2()
+        .setSrcStageMask(vk::PipelineStageFlagBits2::eCopy)
+        .setSrcAccessMask(vk::AccessFlagBits2::eTransferWrite)
+        .setOldLayout(vk::ImageLayout::eTransferDstOptimal)
+        .setNewLayout(vk::ImageLayout::eShaderReadOnlyOptimal)
+        .setImage(dstTexture->getImage())
+        .setSubresourceRange(subresourceRange);
+
+    if (mOwnershipTransfer)
+    {
+        toShaderRead
+            .setSrcQueueFamilyIndex(mTransferQueue->getQueueFamilyIndex())
+            .setDstQueueFamilyIndex(mGraphicsQueue->getQueueFamilyIndex());
+        mOpenBatch->imageReleases.push_back(toShaderRead);
+    }
+    else
+    {
+        toShaderRead
+            .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+            .setDstAccessMask(vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead);
+        commandBuffer.pipelineBarrier2(vk::DependencyInfo().setImageMemoryBarriers(toShaderRead));
+    }
+
+    dstTexture->setLayout(vk::ImageLayout::eShaderReadOnlyOptimal);
+
+    return { mOpenBatch->timelineValue };
+}
+
+void VulkanUploadManager::submit()
+{
+    if (!mOpenBatch.has_value())
+    {
+        return;
+    }
+
+    auto& batch = mOpenBatch.value();
+
+    if (mOwnershipTransfer)
+    {
+        // Release barriers, the matching acquire operations are recorded on the graphics queue
+        batch.commandBuffer.pipelineBarrier2(vk::DependencyInfo()
+            .setBufferMemoryBarriers(batch.bufferReleases)
+            .setImageMemoryBarriers(batch.imageReleases));
+    }
+    else
+    {
+        // Make the copies visible to everything submitted after the batch
+        const auto memoryBarrier = vk::MemoryBarrier2()
+            .setSrcStageMask(vk::PipelineStageFlagBits2::eCopy)
+            .setSrcAccessMask(vk::AccessFlagBits2::eTransferWrite)
+            .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+            .setDstAccessMask(vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite);
+
+        batch.commandBuffer.pipelineBarrier2(vk::DependencyInfo().setMemoryBarriers(memoryBarrier));
+    }
+    batch.commandBuffer.end();
+
+    const auto commandBufferSubmitInfo = vk::CommandBufferSubmitInfo()
+        .setCommandBuffer(batch.commandBuffer);
+
+    // With an ownership transfer the copies signal the value preceding the token, the acquire signals the token
+    const auto signalSemaphoreInfo = vk::SemaphoreSubmitInfo()
+        .setSemaphore(mTimeline)
+        .setValue(mOwnershipTransfer ? batch.timelineValue - 1 : batch.timelineValue)
+        .setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+
+    const auto submitInfo = vk::SubmitInfo2()
+        .setCommandBufferInfos(commandBufferSubmitInfo)
+        .setSignalSemaphoreInfos(signalSemaphoreInfo);
+
+    if (const auto result = mTransferQueue->submit2(submitInfo);
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to submit upload batch");
+    }
+
+    if (mOwnershipTransfer)
+    {
+        submitAcquire(batch);
+    }
+
+    batch.ringEnd       = mRingHead;
+    mLastSubmittedValue = batch.timelineValue;
+
+    mInFlightBatches.push_back(std::move(batch));
+    mOpenBatch.reset();
+
+    retireCompleted();
+}
+
+bool VulkanUploadManager::isComplete(const RHIUploadToken token) const
+{
+    return token.value <= mLastSubmittedValue && token.value <= getCompletedValue();
+}
+
+void VulkanUploadManager::wait(const RHIUploadToken token)
+{
+    if (token.value == 0)
+    {
+        return;
+    }
+
+    if (mOpenBatch.has_value() && token.value == mOpenBatch->timelineValue)
+    {
+        submit();
+    }
+
+    const auto waitInfo = vk::SemaphoreWaitInfo()
+        .setSemaphores(mTimeline)
+        .setValues(token.value);
+
+    if (const auto result = mDevice->handle().waitSemaphores(waitInfo, std::numeric_limits<uint64_t>::max());
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to wait for upload batch");
+    }
+
+    retireCompleted();
+}
+
+std::pair<VulkanBuffer*, uint64_t> VulkanUploadManager::stage(const void* pData, const uint64_t dataSize, const uint64_t alignment)
+{
+    VulkanBuffer* stagingBuffer;
+    uint64_t      stagingOffset = 0;
+
+    if (dataSize > mStagingSize / 2)
+    {
+        // Too large for the ring, the staging buffer is released with the batch
+        if (!mOpenBatch.has_value())
+        {
+            beginBatch();
+        }
+
+        mOpenBatch->dedicatedStaging.push_back(VulkanBuffer::createVulkanBuffer({
+            .bufferSize = dataSize,
+            .bufferType = Staging,
+            .pDevice    = mDevice,
+            .debugName  = "Upload Staging (Dedicated)",
+        }));
+        stagingBuffer = mOpenBatch->dedicatedStaging.back().get();
+    }
+    else
+    {
+        // Reserving may submit the open batch to free up ring space, so the batch is opened afterward
+        stagingOffset = reserveRing(dataSize, alignment);
+        stagingBuffer = mStagingRing.get();
+        if (!mOpenBatch.has_value())
+        {
+            beginBatch();
+        }
+    }
+
+    stagingBuffer->setData(pData, dataSize, stagingOffset);
+    return { stagingBuffer, stagingOffset };
+}
+
+uint64_t VulkanUploadManager::reserveRing(const uint64_t size, const uint64_t alignment)
+{
+    while (true)
+    {
+        const uint64_t position = mRingHead % mStagingSize;
+        uint64_t offset  = (position + alignment - 1) / alignment * alignment;
+        uint64_t padding = offset - position;
+
+        // Ranges never wrap, skip the remainder of the ring instead
+        if (offset + size > mStagingSize)
+        {
+            offset  = 0;
+            padding = mStagingSize - position;
+        }
+
+        if (mRingHead + padding + size - mRingTail <= mStagingSize)
+        {
+            mRingHead += padding + size;
+            return offset;
+        }
+
+        retireCompleted();
+        if (mRingHead + padding + size - mRingTail <= mStagingSize)
+        {
+            continue;
+        }
+
+        // The ring is full: the open batch holds space that can only be reclaimed after submitting it
+        VK_DEBUG(fmt::format("{}", styled("Upload staging ring exhausted, waiting for the oldest batch", fg(fmt::color::light_yellow))));
+
+        submit();
+        if (!mInFlightBatches.empty())
+        {
+            wait({ mInFlightBatches.front().timelineValue });
+        }
+    }
+}
+
+void VulkanUploadManager::beginBatch()
+{
+    const auto commandBuffer = allocateCommandBuffer(mDevice->handle(), mCommandPool, mFreeCommandBuffers);
+
+    constexpr auto beginInfo = vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    commandBuffer.begin(beginInfo);
+
+    mOpenBatch = UploadBatch {
+        .commandBuffer = commandBuffer,
+        .timelineValue = mLastSubmittedValue + (mOwnershipTransfer ? 2 : 1),
+    };
+}
+
+void VulkanUploadManager::submitAcquire(UploadBatch& batch)
+{
+    batch.acquireCommandBuffer = allocateCommandBuffer(mDevice->handle(), mAcquireCommandPool, mFreeAcquireCommandBuffers);
+
+    // Acquire barriers repeat the release barriers, with the destination scope filled in instead of the source
+    std::vector<vk::BufferMemoryBarrier2> bufferAcquires = batch.bufferReleases;
+    for (auto& barrier : bufferAcquires)
+    {
+        barrier
+            .setSrcStageMask(vk::PipelineStageFlagBits2::eNone)
+            .setSrcAccessMask(vk::AccessFlagBits2::eNone)
+            .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+            .setDstAccessMask(vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite);
+    }
+
+    std::vector<vk::ImageMemoryBarrier2> imageAcquires = batch.imageReleases;
+    for (auto& barrier : imageAcquires)
+    {
+        barrier
+            .setSrcStageMask(vk::PipelineStageFlagBits2::eNone)
+            .setSrcAccessMask(vk::AccessFlagBits2::eNone)
+            .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+            .setDstAccessMask(vk::AccessFlagBits2::eShaderSampledRead | vk::AccessFlagBits2::eShaderStorageRead);
+    }
+
+    constexpr auto beginInfo = vk::CommandBufferBeginInfo().setFlags(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
+    batch.acquireCommandBuffer.begin(beginInfo);
+    // Concurrent buffers skip the ownership transfer, the semaphore wait is chained to later submissions instead
+    const auto memoryBarrier = vk::MemoryBarrier2()
+        .setSrcStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+        .setDstStageMask(vk::PipelineStageFlagBits2::eAllCommands)
+        .setDstAccessMask(vk::AccessFlagBits2::eMemoryRead | vk::AccessFlagBits2::eMemoryWrite);
+
+    batch.acquireCommandBuffer.pipelineBarrier2(vk::DependencyInfo()
+        .setMemoryBarriers(memoryBarrier)
+        .setBufferMemoryBarriers(bufferAcquires)
+        .setImageMemoryBarriers(imageAcquires));
+    batch.acquireCommandBuffer.end();
+
+    const auto commandBufferSubmitInfo = vk::CommandBufferSubmitInfo()
+        .setCommandBuffer(batch.acquireCommandBuffer);
+
+    const auto waitSemaphoreInfo = vk::SemaphoreSubmitInfo()
+        .setSemaphore(mTimeline)
+        .setValue(batch.timelineValue - 1)
+        .setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+
+    const auto signalSemaphoreInfo = vk::SemaphoreSubmitInfo()
+        .setSemaphore(mTimeline)
+        .setValue(batch.timelineValue)
+        .setStageMask(vk::PipelineStageFlagBits2::eAllCommands);
+
+    const auto submitInfo = vk::SubmitInfo2()
+        .setCommandBufferInfos(commandBufferSubmitInfo)
+        .setWaitSemaphoreInfos(waitSemaphoreInfo)
+        .setSignalSemaphoreInfos(signalSemaphoreInfo);
+
+    if (const auto result = mGraphicsQueue->submit2(submitInfo);
+        result != vk::Result::eSuccess)
+    {
+        throw std::runtime_error("Failed to submit upload acquire barriers");
+    }
+}
+
+void VulkanUploadManager::retireCompleted()
+{
+    if (mInFlightBatches.empty())
+    {
+        return;
+    }
+
+    const uint64_t completedValue = getCompletedValue();
+    while (!mInFlightBatches.empty() && mInFlightBatches.front().timelineValue <= completedValue)
+    {
+        auto& batch = mInFlightBatches.front();
+        mRingTail = batch.ringEnd;
+        mFreeCommandBuffers.push_back(batch.commandBuffer);
+        if (batch.acquireCommandBuffer)
+        {
+            mFreeAcquireCommandBuffers.push_back(batch.acquireCommandBuffer);
+        }
+        mInFlightBatches.pop_front();
+    }
+}
+
+uint64_t VulkanUploadManager::getCompletedValue() const
+{
+    return mDevice->handle().getSemaphoreCounterValue(mTimeline);
+}
+
+vk::CommandBuffer VulkanUploadManager::allocateCommandBuffer(const vk::Device device, const vk::CommandPool commandPool, std::vector<vk::CommandBuffer>& freeList)
+{
+    if (!freeList.empty())
+    {
+        const auto commandBuffer = freeList.back();
+        freeList.pop_back();
+        return commandBuffer;
+    }
+
+    const auto bufferAllocateInfo = vk::CommandBufferAllocateInfo()
+        .setCommandBufferCount(1)
+        .setCommandPool(commandPool)
+        .setLevel(vk::CommandBufferLevel::ePrimary);
+
+    vk::CommandBuffer commandBuffer;
+    VK_CHECK(commandBuffer = device.allocateCommandBuffers(bufferAllocateInfo)[0];);
+    return commandBuffer;
+}
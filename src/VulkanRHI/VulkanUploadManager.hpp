@@ -0,0 +1,102 @@
+#pragma once
+
+#include <deque>
+#include "VulkanBase.hpp"
+#include "VulkanBuffer.hpp"
+#include "VulkanCommandQueue.hpp"
+#include "VulkanDevice.hpp"
+#include "VulkanTexture.hpp"
+
+struct VulkanUploadManagerCreateInfo
+{
+    uint64_t             stagingSize    {32ull * 1024 * 1024};
+    VulkanCommandQueue*  pTransferQueue {nullptr};
+    VulkanCommandQueue*  pGraphicsQueue {nullptr};
+    VulkanDevice*        pDevice        {nullptr};
+};
+
+/**
+ * Packs buffer and texture uploads into a shared, persistently mapped staging ring and records the copies into
+ * one command buffer per batch. A batch is submitted once per frame (or when a caller waits on it) and signals
+ * a timeline semaphore, the signaled value is the token handed back to callers.
+ *
+ * When the transfer queue belongs to a different queue family than the graphics queue, the batch ends with
+ * release barriers and a small acquire command buffer is submitted on the graphics queue after it.
+ */
+class VulkanUploadManager
+{
+public:
+    DISABLE_COPY_CTOR(VulkanUploadManager);
+    explicit DEF_PRIMARY_CTOR(VulkanUploadManager, const VulkanUploadManagerCreateInfo& createInfo);
+
+    ~VulkanUploadManager();
+
+    // Copies the data into the staging ring and records a copy to the destination, does not block on the GPU
+    RHIUploadToken upload(const VulkanBuffer* dstBuffer, const void* pData, uint64_t dataSize, uint64_t dstOffset = 0);
+
+    // Uploads tightly packed texels to the first mip level, the texture ends up in ShaderReadOnlyOptimal layout
+    RHIUploadToken upload(VulkanTexture* dstTexture, const void* pData, uint64_t dataSize);
+
+    // Submits the recorded batch, if any. Work submitted afterward on the graphics queue observes the uploaded data.
+    void           submit();
+
+    bool           isComplete(RHIUploadToken token) const;
+
+    // Submits the token's batch if it is still being recorded, then blocks until it has completed
+    void           wait(RHIUploadToken token);
+
+    bool           usesOwnershipTransfer() const { return mOwnershipTransfer; }
+
+private:
+    struct UploadBatch
+    {
+        vk::CommandBuffer                          commandBuffer;
+        vk::CommandBuffer                          acquireCommandBuffer;
+        uint64_t                                   timelineValue {0};
+        uint64_t                                   ringEnd       {0};
+        std::vector<std::unique_ptr<VulkanBuffer>> dedicatedStaging;
+
+        // Queue family release barriers, mirrored as acquire barriers on the graphics queue
+        std::vector<vk::BufferMemoryBarrier2>      bufferReleases;
+        std::vector<vk::ImageMemoryBarrier2>       imageReleases;
+    };
+
+    // Writes the data into staging memory for the open batch, returns the buffer and offset it was written to
+    std::pair<VulkanBuffer*, uint64_t> stage(const void* pData, uint64_t dataSize, uint64_t alignment);
+
+    // Reserves ring space, may submit the open batch and wait for older batches when the ring is full
+    uint64_t reserveRing(uint64_t size, uint64_t alignment);
+
+    void beginBatch();
+
+    void submitAcquire(UploadBatch& batch);
+
+    // Recycles the command buffers and staging space of completed batches
+    void retireCompleted();
+
+    uint64_t getCompletedValue() const;
+
+    static vk::CommandBuffer allocateCommandBuffer(vk::Device device, vk::CommandPool commandPool, std::vector<vk::CommandBuffer>& freeList);
+
+    std::unique_ptr<VulkanBuffer>  mStagingRing;
+    uint64_t                       mStagingSize;
+    // Monotonic byte counters, the ring offset is the counter modulo mStagingSize
+    uint64_t                       mRingHead {0};
+    uint64_t                       mRingTail {0};
+
+    std::optional<UploadBatch>     mOpenBatch;
+    std::deque<UploadBatch>        mInFlightBatches;
+
+    vk::CommandPool                mCommandPool;
+    std::vector<vk::CommandBuffer> mFreeCommandBuffers;
+    vk::CommandPool                mAcquireCommandPool;
+    std::vector<vk::CommandBuffer> mFreeAcquireCommandBuffers;
+
+    vk::Semaphore                  mTimeline;
+    uint64_t                       mLastSubmittedValue {0};
+
+    const bool                     mOwnershipTransfer;
+    VulkanCommandQueue*            mTransferQueue;
+    VulkanCommandQueue*            mGraphicsQueue;
+    VulkanDevice*                  mDevice;
+};
@@ -6,12 +6,15 @@
 #include "RHI/RHIBuffer.hpp"
 #include "RHI/RHICommandList.hpp"
 #include "RHI/RHICommandQueue.hpp"
+#include "RHI/RHICommandStream.hpp"
+#include "RHI/RHIFence.hpp"
 #include "RHI/RHIFramebuffer.hpp"
 #include "RHI/RHIPipeline.hpp"
 #include "RHI/RHIRenderPass.hpp"
 #include "RHI/RHISwapchain.hpp"
 #include "RHI/RHITexture.hpp"
 #include "RHI/RHIWindow.hpp"
+#include "RHI/TaskPool.hpp"
 
 rhi_BEGIN_NAMESPACE;
 